@@ -44,6 +44,7 @@ static ssize_t buffering_writev(neo4j_iostream_t *stream,
         const struct iovec *iov, unsigned int iovcnt);
 static int buffering_flush(neo4j_iostream_t *stream);
 static int buffering_close(neo4j_iostream_t *stream);
+static int buffering_fileno(neo4j_iostream_t *stream);
 
 
 neo4j_iostream_t *neo4j_buffering_iostream(neo4j_iostream_t *delegate,
@@ -86,6 +87,7 @@ neo4j_iostream_t *neo4j_buffering_iostream(neo4j_iostream_t *delegate,
     iostream->writev = buffering_writev;
     iostream->flush = buffering_flush;
     iostream->close = buffering_close;
+    iostream->fileno = buffering_fileno;
     return iostream;
 
     int errsv;
@@ -399,3 +401,16 @@ int buffering_close(neo4j_iostream_t *stream)
     free(ios);
     return neo4j_ios_close(delegate);
 }
+
+
+int buffering_fileno(neo4j_iostream_t *stream)
+{
+    struct buffering_iostream *ios = container_of(stream,
+            struct buffering_iostream, _iostream);
+    if (ios->delegate == NULL)
+    {
+        errno = EPIPE;
+        return -1;
+    }
+    return neo4j_ios_fileno(ios->delegate);
+}
@@ -51,6 +51,7 @@ neo4j_config_t *neo4j_new_config()
     config->connection_factory = &neo4j_std_connection_factory;
     config->allocator = &neo4j_std_memory_allocator;
     config->mpool_block_size = 128;
+    config->record_mpool_cache_size = 65536;
     config->client_id = libneo4j_client_id();
     config->io_rcvbuf_size = 4096;
     config->io_sndbuf_size = 4096;
@@ -58,6 +59,8 @@ neo4j_config_t *neo4j_new_config()
     config->snd_max_chunk_size = UINT16_MAX;
     config->session_request_queue_size = 256;
     config->max_pipelined_requests = NEO4J_DEFAULT_MAX_PIPELINED_REQUESTS;
+    config->fetch_size = NEO4J_DEFAULT_FETCH_SIZE;
+    config->pool_max_idle = NEO4J_DEFAULT_POOL_MAX_IDLE;
     config->trust_known = true;
     return config;
 }
@@ -362,8 +365,83 @@ void neo4j_config_set_memory_allocator(neo4j_config_t *config,
 }
 
 
+void neo4j_config_set_mpool_arena_size(neo4j_config_t *config, size_t size)
+{
+    config->mpool_arena_size = size;
+}
+
+
+void neo4j_config_set_record_mpool_cache_size(neo4j_config_t *config,
+        size_t size)
+{
+    config->record_mpool_cache_size = size;
+}
+
+
 void neo4j_config_set_max_pipelined_requests(neo4j_config_t *config,
         unsigned int n)
 {
     config->max_pipelined_requests = n;
 }
+
+
+void neo4j_config_set_fetch_size(neo4j_config_t *config, unsigned int n)
+{
+    config->fetch_size = n;
+}
+
+
+void neo4j_config_set_read_ahead(neo4j_config_t *config, unsigned int n)
+{
+    config->read_ahead = n;
+}
+
+
+void neo4j_config_set_deserialization_workers(neo4j_config_t *config,
+        unsigned int n)
+{
+    config->deserialization_workers = n;
+}
+
+
+void neo4j_config_set_pool_min_idle(neo4j_config_t *config, unsigned int n)
+{
+    config->pool_min_idle = n;
+}
+
+
+void neo4j_config_set_pool_max_idle(neo4j_config_t *config, unsigned int n)
+{
+    config->pool_max_idle = n;
+}
+
+
+void neo4j_config_set_zero_copy_strings(neo4j_config_t *config, bool enable)
+{
+    config->zero_copy_strings = enable;
+}
+
+
+void neo4j_config_set_lazy_record_decoding(neo4j_config_t *config,
+        bool enable)
+{
+    config->lazy_record_decoding = enable;
+}
+
+
+void neo4j_config_set_intern_strings(neo4j_config_t *config, bool enable)
+{
+    config->intern_strings = enable;
+}
+
+
+void neo4j_config_set_inline_strings(neo4j_config_t *config, bool enable)
+{
+    config->inline_strings = enable;
+}
+
+
+void neo4j_config_set_pipelined_init(neo4j_config_t *config, bool enable)
+{
+    config->pipelined_init = enable;
+}
@@ -27,6 +27,8 @@ struct neo4j_config
     struct neo4j_connection_factory *connection_factory;
     struct neo4j_memory_allocator *allocator;
     unsigned int mpool_block_size;
+    size_t mpool_arena_size;
+    size_t record_mpool_cache_size;
 
     char *username;
     char *password;
@@ -48,6 +50,18 @@ struct neo4j_config
 
     unsigned int session_request_queue_size;
     unsigned int max_pipelined_requests;
+    unsigned int fetch_size;
+    unsigned int read_ahead;
+    unsigned int deserialization_workers;
+
+    unsigned int pool_min_idle;
+    unsigned int pool_max_idle;
+
+    bool zero_copy_strings;
+    bool lazy_record_decoding;
+    bool intern_strings;
+    bool inline_strings;
+    bool pipelined_init;
 
 #ifdef HAVE_TLS
     char *tls_private_key_file;
@@ -92,7 +106,8 @@ int neo4j_config_nset_username(neo4j_config_t *config,
  */
 static inline neo4j_mpool_t neo4j_std_mpool(const neo4j_config_t *config)
 {
-    return neo4j_mpool(config->allocator, config->mpool_block_size);
+    return neo4j_arena_mpool(config->allocator, config->mpool_block_size,
+            config->mpool_arena_size);
 }
 
 
@@ -23,25 +23,62 @@
 #include "memory.h"
 #include "network.h"
 #ifdef HAVE_OPENSSL
+#include "openssl.h"
 #include "openssl_iostream.h"
 #endif
 #include "posix_iostream.h"
 #include "serialization.h"
 #include "util.h"
 #include <assert.h>
+#include <poll.h>
 #include <unistd.h>
 
+#define NB_MIN_READ 4096
+
+#define would_block(err) ((err) == EAGAIN || (err) == EWOULDBLOCK)
+
+struct nb_output_iostream
+{
+    neo4j_iostream_t _iostream;
+    struct neo4j_nb_buffer *buffer;
+};
+
 
 static int add_userinfo_to_config(const char *userinfo, neo4j_config_t *config);
-static neo4j_connection_t *establish_connection(const char *hostname,
-        unsigned int port, neo4j_config_t *config, uint_fast32_t flags);
 static neo4j_iostream_t *std_tcp_connect(
         struct neo4j_connection_factory *factory, const char *hostname,
         unsigned int port, neo4j_config_t *config, uint_fast32_t flags,
         struct neo4j_logger *logger);
 static int negotiate_protocol_version(neo4j_iostream_t *iostream,
-        uint32_t *protocol_version);
+        uint32_t *protocol_version, uint32_t *minor_version);
 static int disconnect(neo4j_connection_t *connection);
+static const uint8_t *retain_frame(neo4j_connection_t *connection,
+        size_t length, neo4j_mpool_t *mpool);
+static int decode_frame(neo4j_connection_t *connection, ssize_t length,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength);
+static int send_nonblocking(neo4j_connection_t *connection,
+        neo4j_message_type_t type, const neo4j_value_t *argv, uint16_t argc);
+static int await_flush(neo4j_connection_t *connection);
+static ssize_t await_frame(neo4j_connection_t *connection);
+static int await_io(neo4j_connection_t *connection, short events);
+static int take_frame(neo4j_connection_t *connection, size_t *length);
+static int parse_frame(neo4j_connection_t *connection, size_t *length);
+static int fill_input(neo4j_connection_t *connection);
+static int nb_buffer_reserve(struct neo4j_nb_buffer *buffer, size_t n);
+static void nb_buffer_consume(struct neo4j_nb_buffer *buffer, size_t n);
+static neo4j_iostream_t *nb_output_iostream_init(
+        struct nb_output_iostream *ios, struct neo4j_nb_buffer *buffer);
+static ssize_t nb_output_read(neo4j_iostream_t *self, void *buf, size_t nbyte);
+static ssize_t nb_output_readv(neo4j_iostream_t *self,
+        const struct iovec *iov, unsigned int iovcnt);
+static ssize_t nb_output_write(neo4j_iostream_t *self,
+        const void *buf, size_t nbyte);
+static ssize_t nb_output_writev(neo4j_iostream_t *self,
+        const struct iovec *iov, unsigned int iovcnt);
+static int nb_output_flush(neo4j_iostream_t *self);
+static int nb_output_close(neo4j_iostream_t *self);
 
 
 struct neo4j_connection_factory neo4j_std_connection_factory =
@@ -62,6 +99,37 @@ neo4j_connection_t *neo4j_connect(const char *uri_string,
 
     neo4j_connection_t *connection = NULL;
 
+    unsigned int port;
+    char *hostname = neo4j_resolve_uri(uri_string, config, &port);
+    if (hostname == NULL)
+    {
+        goto cleanup;
+    }
+
+    connection = neo4j_establish_connection(hostname, port, config, flags);
+
+    int errsv;
+cleanup:
+    errsv = errno;
+    free(hostname);
+    if (connection == NULL)
+    {
+        neo4j_config_free(config);
+    }
+    errno = errsv;
+    return connection;
+}
+
+
+char *neo4j_resolve_uri(const char *uri_string, neo4j_config_t *config,
+        unsigned int *port)
+{
+    REQUIRE(uri_string != NULL, NULL);
+    REQUIRE(config != NULL, NULL);
+    REQUIRE(port != NULL, NULL);
+
+    char *hostname = NULL;
+
     struct uri *uri = parse_uri(uri_string, NULL);
     if (uri == NULL)
     {
@@ -69,7 +137,7 @@ neo4j_connection_t *neo4j_connect(const char *uri_string,
         {
             errno = NEO4J_INVALID_URI;
         }
-        goto cleanup;
+        return NULL;
     }
 
     if (uri->scheme == NULL ||
@@ -79,6 +147,11 @@ neo4j_connection_t *neo4j_connect(const char *uri_string,
         errno = NEO4J_UNKNOWN_URI_SCHEME;
         goto cleanup;
     }
+    if (uri->hostname == NULL)
+    {
+        errno = NEO4J_INVALID_URI;
+        goto cleanup;
+    }
 
     if (uri->userinfo != NULL)
     {
@@ -88,22 +161,15 @@ neo4j_connection_t *neo4j_connect(const char *uri_string,
         }
     }
 
-    unsigned int port = (uri->port > 0)? uri->port : NEO4J_DEFAULT_TCP_PORT;
-    connection = establish_connection(uri->hostname, port, config, flags);
+    hostname = strdup(uri->hostname);
+    *port = (uri->port > 0)? uri->port : NEO4J_DEFAULT_TCP_PORT;
 
     int errsv;
 cleanup:
     errsv = errno;
-    if (uri != NULL)
-    {
-        free_uri(uri);
-    }
-    if (config != NULL && connection == NULL)
-    {
-        neo4j_config_free(config);
-    }
+    free_uri(uri);
     errno = errsv;
-    return connection;
+    return hostname;
 }
 
 
@@ -156,11 +222,11 @@ neo4j_connection_t *neo4j_tcp_connect(const char *hostname, unsigned int port,
         return NULL;
     }
 
-    return establish_connection(hostname, port, config, flags);
+    return neo4j_establish_connection(hostname, port, config, flags);
 }
 
 
-neo4j_connection_t *establish_connection(const char *hostname,
+neo4j_connection_t *neo4j_establish_connection(const char *hostname,
         unsigned int port, neo4j_config_t *config, uint_fast32_t flags)
 {
     neo4j_logger_t *logger = neo4j_get_logger(config, "connection");
@@ -196,12 +262,16 @@ neo4j_connection_t *establish_connection(const char *hostname,
     }
 
     uint32_t protocol_version;
-    if (negotiate_protocol_version(iostream, &protocol_version))
+    uint32_t minor_version;
+    if (negotiate_protocol_version(iostream, &protocol_version,
+                &minor_version))
     {
         errno = NEO4J_PROTOCOL_NEGOTIATION_FAILED;
         goto failure;
     }
-    if (protocol_version != 1)
+    const struct neo4j_message_table *messages =
+        neo4j_message_table(protocol_version, minor_version);
+    if (messages == NULL)
     {
         errno = NEO4J_PROTOCOL_NEGOTIATION_FAILED;
         goto failure;
@@ -217,6 +287,8 @@ neo4j_connection_t *establish_connection(const char *hostname,
     connection->port = port;
     connection->iostream = iostream;
     connection->version = protocol_version;
+    connection->minor_version = minor_version;
+    connection->messages = messages;
 #ifdef HAVE_TLS
     connection->insecure = flags & NEO4J_INSECURE;
 #else
@@ -224,11 +296,12 @@ neo4j_connection_t *establish_connection(const char *hostname,
 #endif
     connection->snd_buffer = snd_buffer;
     connection->request_queue = request_queue;
+    connection->fd = -1;
 
     neo4j_log_info(logger, "connected (%p) to %s:%u%s", (void *)connection,
             hostname, port, connection->insecure? " (insecure)" : "");
-    neo4j_log_debug(logger, "connection %p using protocol version %d",
-            (void *)connection, protocol_version);
+    neo4j_log_debug(logger, "connection %p using protocol version %u.%u",
+            (void *)connection, protocol_version, minor_version);
 
     return connection;
 
@@ -277,28 +350,33 @@ neo4j_iostream_t *std_tcp_connect(struct neo4j_connection_factory *factory,
     neo4j_log_trace(logger, "opened socket to %s [%d] (fd=%d)",
             hostname, port, fd);
 
-    neo4j_iostream_t *ios = neo4j_posix_iostream(fd);
-    if (ios == NULL)
-    {
-        goto failure;
-    }
+    neo4j_iostream_t *ios = NULL;
 
 #ifdef HAVE_TLS
     if (!(flags & NEO4J_INSECURE))
     {
 #ifdef HAVE_OPENSSL
+        // bind TLS directly to the socket, rather than via a posix iostream
         neo4j_log_trace(logger, "initialiting TLS (fd=%d)", fd);
-        neo4j_iostream_t *tls_ios = neo4j_openssl_iostream(ios, hostname, port,
+        ios = neo4j_openssl_socket_iostream(fd, hostname, port,
                 config, flags);
-        if (tls_ios == NULL)
+        if (ios == NULL)
         {
             goto failure;
         }
-        ios = tls_ios;
 #endif
     }
 #endif
 
+    if (ios == NULL)
+    {
+        ios = neo4j_posix_iostream(fd);
+        if (ios == NULL)
+        {
+            goto failure;
+        }
+    }
+
     if (config->io_sndbuf_size > 0 || config->io_rcvbuf_size > 0)
     {
         neo4j_iostream_t *buffering_ios = neo4j_buffering_iostream(ios, true,
@@ -317,9 +395,13 @@ failure:
     errsv = errno;
     if (ios != NULL)
     {
+        // closes the socket
         neo4j_ios_close(ios);
     }
-    close(fd);
+    else
+    {
+        close(fd);
+    }
     errno = errsv;
     return NULL;
 }
@@ -335,6 +417,17 @@ int neo4j_close(neo4j_connection_t *connection)
         errno = NEO4J_SESSION_ACTIVE;
         return -1;
     }
+    if (connection->iostream != NULL && connection->messages->goodbye != NULL)
+    {
+        // a failure to say goodbye is of no consequence
+        if (neo4j_connection_send(connection, connection->messages->goodbye,
+                    NULL, 0) == 0 &&
+                (!connection->nonblocking || await_flush(connection) == 0))
+        {
+            neo4j_log_trace(connection->logger, "sent GOODBYE on %p",
+                    (void *)connection);
+        }
+    }
     int result = disconnect(connection);
     int errsv = errno;
     if (result == 0)
@@ -346,6 +439,9 @@ int neo4j_close(neo4j_connection_t *connection)
     neo4j_config_free(connection->config);
     free(connection->request_queue);
     free(connection->snd_buffer);
+    free(connection->rcv_buffer);
+    free(connection->nb_output.data);
+    free(connection->nb_input.data);
     free(connection->hostname);
     memset(connection, 0, sizeof(neo4j_connection_t));
     free(connection);
@@ -368,7 +464,7 @@ int disconnect(neo4j_connection_t *connection)
 
 
 int negotiate_protocol_version(neo4j_iostream_t *iostream,
-        uint32_t *protocol_version)
+        uint32_t *protocol_version, uint32_t *minor_version)
 {
     uint8_t hello[] = { 0x60, 0x60, 0xB0, 0x17 };
     if (neo4j_ios_write_all(iostream, hello,
@@ -377,7 +473,10 @@ int negotiate_protocol_version(neo4j_iostream_t *iostream,
         return -1;
     }
 
-    uint32_t supported_versions[4] = { htonl(1), 0, 0, 0 };
+    // each proposal is a major version, a minor version and a count of
+    // preceding minor versions also supported: 5.4-5.0, 4.4-4.0, 3 and 1
+    uint32_t supported_versions[4] =
+        { htonl(0x00040405), htonl(0x00040404), htonl(3), htonl(1) };
     if (neo4j_ios_write_all(iostream, supported_versions,
                 sizeof(supported_versions), NULL) < 0)
     {
@@ -397,7 +496,9 @@ int negotiate_protocol_version(neo4j_iostream_t *iostream,
         return -1;
     }
 
-    *protocol_version = ntohl(agreed_version);
+    agreed_version = ntohl(agreed_version);
+    *protocol_version = agreed_version & 0xFF;
+    *minor_version = (agreed_version >> 8) & 0xFF;
     return 0;
 }
 
@@ -426,6 +527,23 @@ bool neo4j_connection_is_secure(const neo4j_connection_t *connection)
 }
 
 
+void neo4j_tls_session_stats(unsigned long *hits, unsigned long *misses)
+{
+#ifdef HAVE_OPENSSL
+    neo4j_openssl_session_stats(hits, misses);
+#else
+    if (hits != NULL)
+    {
+        *hits = 0;
+    }
+    if (misses != NULL)
+    {
+        *misses = 0;
+    }
+#endif
+}
+
+
 int neo4j_connection_send(neo4j_connection_t *connection,
         neo4j_message_type_t type, const neo4j_value_t *argv, uint16_t argc)
 {
@@ -437,9 +555,11 @@ int neo4j_connection_send(neo4j_connection_t *connection,
     }
 
     const neo4j_config_t *config = connection->config;
-    int res = neo4j_message_send(connection->iostream, type, argv, argc,
-            connection->snd_buffer, config->snd_min_chunk_size,
-            config->snd_max_chunk_size);
+    int res = connection->nonblocking?
+        send_nonblocking(connection, type, argv, argc) :
+        neo4j_message_send(connection->iostream, type, argv, argc,
+                connection->snd_buffer, config->snd_min_chunk_size,
+                config->snd_max_chunk_size);
     if (res && errno != NEO4J_CONNECTION_CLOSED)
     {
         char ebuf[256];
@@ -451,17 +571,193 @@ int neo4j_connection_send(neo4j_connection_t *connection,
 }
 
 
+int neo4j_connection_set_nonblocking(neo4j_connection_t *connection)
+{
+    REQUIRE(connection != NULL, -1);
+    if (connection->iostream == NULL)
+    {
+        errno = NEO4J_CONNECTION_CLOSED;
+        return -1;
+    }
+    if (connection->nonblocking)
+    {
+        return 0;
+    }
+
+    int fd = neo4j_ios_fileno(connection->iostream);
+    if (fd < 0)
+    {
+        neo4j_log_debug_errno(connection->logger, "neo4j_ios_fileno failed");
+        return -1;
+    }
+    if (neo4j_socket_set_nonblocking(fd, connection->logger))
+    {
+        return -1;
+    }
+
+    connection->fd = fd;
+    connection->nonblocking = true;
+    neo4j_log_debug(connection->logger, "connection %p is non-blocking (fd=%d)",
+            (void *)connection, fd);
+    return 0;
+}
+
+
+int neo4j_connection_flush(neo4j_connection_t *connection)
+{
+    REQUIRE(connection != NULL, -1);
+    if (connection->iostream == NULL)
+    {
+        errno = NEO4J_CONNECTION_CLOSED;
+        return -1;
+    }
+
+    struct neo4j_nb_buffer *output = &(connection->nb_output);
+    while (output->length > 0)
+    {
+        ssize_t written = neo4j_ios_write(connection->iostream,
+                output->data + output->offset, output->length);
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (written <= 0)
+        {
+            if (written == 0 || would_block(errno))
+            {
+                return 1;
+            }
+            goto failure;
+        }
+        nb_buffer_consume(output, written);
+        connection->nb_flush_pending = true;
+    }
+
+    if (connection->nb_flush_pending)
+    {
+        if (neo4j_ios_flush(connection->iostream))
+        {
+            if (would_block(errno))
+            {
+                return 1;
+            }
+            goto failure;
+        }
+        connection->nb_flush_pending = false;
+    }
+    return 0;
+
+failure:
+    if (errno != NEO4J_CONNECTION_CLOSED)
+    {
+        char ebuf[256];
+        neo4j_log_error(connection->logger,
+                "error sending on %p: %s\n", (void *)connection,
+                neo4j_strerror(errno, ebuf, sizeof(ebuf)));
+    }
+    return -1;
+}
+
+
 int neo4j_connection_recv(neo4j_connection_t *connection, neo4j_mpool_t *mpool,
-        neo4j_message_type_t *type, const neo4j_value_t **argv, uint16_t *argc)
+        neo4j_message_type_t *type, const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength)
+{
+    REQUIRE(connection != NULL, -1);
+    REQUIRE(record == NULL || rlength != NULL, -1);
+    if (connection->iostream == NULL)
+    {
+        errno = NEO4J_CONNECTION_CLOSED;
+        return -1;
+    }
+
+    ssize_t length = connection->nonblocking? await_frame(connection) :
+        neo4j_message_recv_frame(connection->iostream,
+                &(connection->rcv_buffer), &(connection->rcv_buffer_size));
+    return decode_frame(connection, length, mpool, type, argv, argc,
+            record, rlength);
+}
+
+
+int neo4j_connection_try_recv(neo4j_connection_t *connection,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength)
 {
     REQUIRE(connection != NULL, -1);
+    REQUIRE(connection->nonblocking, -1);
+    REQUIRE(record == NULL || rlength != NULL, -1);
     if (connection->iostream == NULL)
     {
         errno = NEO4J_CONNECTION_CLOSED;
         return -1;
     }
 
-    int res = neo4j_message_recv(connection->iostream, mpool, type, argv, argc);
+    size_t length;
+    int result = take_frame(connection, &length);
+    if (result > 0)
+    {
+        return 1;
+    }
+    return decode_frame(connection, (result == 0)? (ssize_t)length : -1,
+            mpool, type, argv, argc, record, rlength);
+}
+
+
+int decode_frame(neo4j_connection_t *connection, ssize_t length,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength)
+{
+    int res = -1;
+    connection->rcv_length = (length > 0)? length : 0;
+
+    if (length >= 0 && record != NULL)
+    {
+        uint16_t nargs;
+        ssize_t hlength = neo4j_message_decode_header(connection->rcv_buffer,
+                length, type, &nargs);
+        if (hlength < 0)
+        {
+            length = -1;
+        }
+        else if (*type == NEO4J_RECORD_MESSAGE)
+        {
+            *record = connection->rcv_buffer + hlength;
+            *rlength = length - hlength;
+            if (argv != NULL)
+            {
+                *argv = NULL;
+            }
+            if (argc != NULL)
+            {
+                *argc = nargs;
+            }
+            return 0;
+        }
+    }
+
+    if (length >= 0 && !connection->config->zero_copy_strings)
+    {
+        res = neo4j_message_decode(connection->rcv_buffer, length, false,
+                mpool, type, argv, argc);
+    }
+    else if (length >= 0)
+    {
+        neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*mpool);
+        const uint8_t *frame = retain_frame(connection, length, mpool);
+        if (frame != NULL)
+        {
+            res = neo4j_message_decode(frame, length, true,
+                    mpool, type, argv, argc);
+        }
+        if (res)
+        {
+            int errsv = errno;
+            neo4j_mpool_drainto_mark(mpool, pmark);
+            errno = errsv;
+        }
+    }
     if (res && errno != NEO4J_CONNECTION_CLOSED)
     {
         char ebuf[256];
@@ -473,6 +769,403 @@ int neo4j_connection_recv(neo4j_connection_t *connection, neo4j_mpool_t *mpool,
 }
 
 
+int neo4j_connection_retain_frame(neo4j_connection_t *connection,
+        neo4j_mpool_t *mpool, const uint8_t **ptr)
+{
+    REQUIRE(connection != NULL, -1);
+    REQUIRE(mpool != NULL, -1);
+    REQUIRE(ptr != NULL, -1);
+    REQUIRE(connection->rcv_buffer != NULL &&
+            *ptr >= connection->rcv_buffer &&
+            *ptr <= connection->rcv_buffer + connection->rcv_length, -1);
+
+    size_t offset = *ptr - connection->rcv_buffer;
+    const uint8_t *frame = retain_frame(connection, connection->rcv_length,
+            mpool);
+    if (frame == NULL)
+    {
+        return -1;
+    }
+    *ptr = frame + offset;
+    return 0;
+}
+
+
+const uint8_t *retain_frame(neo4j_connection_t *connection, size_t length,
+        neo4j_mpool_t *mpool)
+{
+    // If the frame fills most of the receive buffer, and the pool releases
+    // memory with free(3), then ownership of the buffer itself is handed to
+    // the pool and a new receive buffer is allocated for the next message.
+    // Otherwise the frame is copied, as a single allocation, into the pool.
+    if (mpool->allocator == &neo4j_std_memory_allocator &&
+            length >= (connection->rcv_buffer_size / 2))
+    {
+        uint8_t *frame = connection->rcv_buffer;
+        if (neo4j_mpool_add(mpool, frame) < 0)
+        {
+            return NULL;
+        }
+        connection->rcv_buffer = NULL;
+        connection->rcv_buffer_size = 0;
+        return frame;
+    }
+
+    uint8_t *frame = neo4j_mpool_alloc(mpool, length);
+    if (frame == NULL)
+    {
+        return NULL;
+    }
+    memcpy(frame, connection->rcv_buffer, length);
+    return frame;
+}
+
+
+int send_nonblocking(neo4j_connection_t *connection,
+        neo4j_message_type_t type, const neo4j_value_t *argv, uint16_t argc)
+{
+    const neo4j_config_t *config = connection->config;
+    struct neo4j_nb_buffer *output = &(connection->nb_output);
+    size_t mark = output->length;
+
+    struct nb_output_iostream ios;
+    if (neo4j_message_send(nb_output_iostream_init(&ios, output),
+                type, argv, argc, connection->snd_buffer,
+                config->snd_min_chunk_size, config->snd_max_chunk_size))
+    {
+        // discard any part of the message already buffered
+        output->length = mark;
+        return -1;
+    }
+
+    return (neo4j_connection_flush(connection) < 0)? -1 : 0;
+}
+
+
+int await_flush(neo4j_connection_t *connection)
+{
+    int result;
+    while ((result = neo4j_connection_flush(connection)) > 0)
+    {
+        if (await_io(connection, POLLOUT))
+        {
+            return -1;
+        }
+    }
+    return result;
+}
+
+
+ssize_t await_frame(neo4j_connection_t *connection)
+{
+    for (;;)
+    {
+        int flushed = neo4j_connection_flush(connection);
+        if (flushed < 0)
+        {
+            return -1;
+        }
+
+        size_t length;
+        int result = take_frame(connection, &length);
+        if (result <= 0)
+        {
+            return (result == 0)? (ssize_t)length : -1;
+        }
+
+        // requests must still be written whilst awaiting the response
+        if (await_io(connection, (flushed > 0)? POLLIN|POLLOUT : POLLIN))
+        {
+            return -1;
+        }
+    }
+}
+
+
+bool neo4j_connection_is_usable(neo4j_connection_t *connection)
+{
+    assert(connection != NULL);
+    if (connection->iostream == NULL || connection->session != NULL)
+    {
+        return false;
+    }
+
+    int fd = neo4j_ios_fileno(connection->iostream);
+    if (fd < 0)
+    {
+        // e.g. a connection factory providing its own streams
+        return true;
+    }
+
+    // closure by the server, or unexpected data, makes the socket readable
+    struct pollfd pfd = { .fd = fd, .events = POLLIN };
+    int result;
+    do
+    {
+        result = poll(&pfd, 1, 0);
+    } while (result < 0 && errno == EINTR);
+    return result == 0;
+}
+
+
+int await_io(neo4j_connection_t *connection, short events)
+{
+    struct pollfd pfd = { .fd = connection->fd, .events = events };
+    int result;
+    do
+    {
+        result = poll(&pfd, 1, -1);
+    } while (result < 0 && errno == EINTR);
+    return (result < 0)? -1 : 0;
+}
+
+
+int take_frame(neo4j_connection_t *connection, size_t *length)
+{
+    for (;;)
+    {
+        int result = parse_frame(connection, length);
+        if (result <= 0)
+        {
+            return result;
+        }
+        result = fill_input(connection);
+        if (result != 0)
+        {
+            return result;
+        }
+    }
+}
+
+
+int parse_frame(neo4j_connection_t *connection, size_t *length)
+{
+    struct neo4j_nb_buffer *input = &(connection->nb_input);
+
+    // skip any empty chunks preceding the message
+    const uint8_t *data = input->data + input->offset;
+    size_t skip = 0;
+    while (input->length - skip >= 2 && data[skip] == 0 && data[skip+1] == 0)
+    {
+        skip += 2;
+    }
+    nb_buffer_consume(input, skip);
+    data = input->data + input->offset;
+
+    // find the end of the message, without yet copying any chunk
+    size_t pos = 0;
+    size_t total = 0;
+    for (;;)
+    {
+        if (input->length - pos < 2)
+        {
+            return 1;
+        }
+        size_t chunk = ((size_t)data[pos] << 8) | data[pos+1];
+        pos += 2;
+        if (chunk == 0)
+        {
+            break;
+        }
+        if (input->length - pos < chunk)
+        {
+            return 1;
+        }
+        pos += chunk;
+        total += chunk;
+    }
+
+    if (total > SSIZE_MAX)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+    if (connection->rcv_buffer_size < total)
+    {
+        size_t nsize = (connection->rcv_buffer_size > 0)?
+            connection->rcv_buffer_size : NEO4J_MESSAGE_BUFFER_SIZE;
+        while (nsize < total)
+        {
+            nsize *= 2;
+        }
+        uint8_t *nbuffer = realloc(connection->rcv_buffer, nsize);
+        if (nbuffer == NULL)
+        {
+            return -1;
+        }
+        connection->rcv_buffer = nbuffer;
+        connection->rcv_buffer_size = nsize;
+    }
+
+    size_t used = 0;
+    for (size_t p = 0; p + 2 < pos;)
+    {
+        size_t chunk = ((size_t)data[p] << 8) | data[p+1];
+        p += 2;
+        memcpy(connection->rcv_buffer + used, data + p, chunk);
+        used += chunk;
+        p += chunk;
+    }
+    assert(used == total);
+
+    nb_buffer_consume(input, pos);
+    *length = total;
+    return 0;
+}
+
+
+int fill_input(neo4j_connection_t *connection)
+{
+    struct neo4j_nb_buffer *input = &(connection->nb_input);
+    if (nb_buffer_reserve(input, NB_MIN_READ))
+    {
+        return -1;
+    }
+
+    size_t end = input->offset + input->length;
+    ssize_t result;
+    do
+    {
+        result = neo4j_ios_read(connection->iostream, input->data + end,
+                input->size - end);
+    } while (result < 0 && errno == EINTR);
+
+    if (result < 0)
+    {
+        return would_block(errno)? 1 : -1;
+    }
+    if (result == 0)
+    {
+        errno = NEO4J_CONNECTION_CLOSED;
+        return -1;
+    }
+    input->length += result;
+    return 0;
+}
+
+
+int nb_buffer_reserve(struct neo4j_nb_buffer *buffer, size_t n)
+{
+    if (buffer->size - (buffer->offset + buffer->length) >= n)
+    {
+        return 0;
+    }
+    if (buffer->offset > 0)
+    {
+        memmove(buffer->data, buffer->data + buffer->offset, buffer->length);
+        buffer->offset = 0;
+        if (buffer->size - buffer->length >= n)
+        {
+            return 0;
+        }
+    }
+
+    size_t nsize = (buffer->size > 0)? buffer->size : NB_MIN_READ;
+    while (nsize - buffer->length < n)
+    {
+        nsize *= 2;
+    }
+    uint8_t *ndata = realloc(buffer->data, nsize);
+    if (ndata == NULL)
+    {
+        return -1;
+    }
+    buffer->data = ndata;
+    buffer->size = nsize;
+    return 0;
+}
+
+
+void nb_buffer_consume(struct neo4j_nb_buffer *buffer, size_t n)
+{
+    assert(n <= buffer->length);
+    buffer->offset += n;
+    buffer->length -= n;
+    if (buffer->length == 0)
+    {
+        buffer->offset = 0;
+    }
+}
+
+
+neo4j_iostream_t *nb_output_iostream_init(struct nb_output_iostream *ios,
+        struct neo4j_nb_buffer *buffer)
+{
+    memset(ios, 0, sizeof(struct nb_output_iostream));
+    ios->buffer = buffer;
+    neo4j_iostream_t *iostream = &(ios->_iostream);
+    iostream->read = nb_output_read;
+    iostream->readv = nb_output_readv;
+    iostream->write = nb_output_write;
+    iostream->writev = nb_output_writev;
+    iostream->flush = nb_output_flush;
+    iostream->close = nb_output_close;
+    return iostream;
+}
+
+
+ssize_t nb_output_read(neo4j_iostream_t *self, void *buf, size_t nbyte)
+{
+    errno = ENOTSUP;
+    return -1;
+}
+
+
+ssize_t nb_output_readv(neo4j_iostream_t *self,
+        const struct iovec *iov, unsigned int iovcnt)
+{
+    errno = ENOTSUP;
+    return -1;
+}
+
+
+ssize_t nb_output_write(neo4j_iostream_t *self, const void *buf, size_t nbyte)
+{
+    struct nb_output_iostream *ios = container_of(self,
+            struct nb_output_iostream, _iostream);
+    struct neo4j_nb_buffer *buffer = ios->buffer;
+    if (nbyte > SSIZE_MAX)
+    {
+        nbyte = SSIZE_MAX;
+    }
+    if (nb_buffer_reserve(buffer, nbyte))
+    {
+        return -1;
+    }
+    memcpy(buffer->data + buffer->offset + buffer->length, buf, nbyte);
+    buffer->length += nbyte;
+    return nbyte;
+}
+
+
+ssize_t nb_output_writev(neo4j_iostream_t *self,
+        const struct iovec *iov, unsigned int iovcnt)
+{
+    size_t total = 0;
+    for (unsigned int i = 0; i < iovcnt; ++i)
+    {
+        if (nb_output_write(self, iov[i].iov_base, iov[i].iov_len) < 0)
+        {
+            return -1;
+        }
+        total += iov[i].iov_len;
+    }
+    return total;
+}
+
+
+int nb_output_flush(neo4j_iostream_t *self)
+{
+    return 0;
+}
+
+
+int nb_output_close(neo4j_iostream_t *self)
+{
+    return 0;
+}
+
+
 int neo4j_attach_session(neo4j_connection_t *connection,
         neo4j_session_t *session)
 {
@@ -26,6 +26,17 @@
 #include "session.h"
 #include "uri.h"
 
+/*
+ * A growable buffer of bytes, which are consumed from the offset.
+ */
+struct neo4j_nb_buffer
+{
+    uint8_t *data;
+    size_t size;
+    size_t offset;
+    size_t length;
+};
+
 struct neo4j_connection
 {
     neo4j_config_t *config;
@@ -36,11 +47,27 @@ struct neo4j_connection
 
     neo4j_iostream_t *iostream;
     uint32_t version;
+    uint32_t minor_version;
+    const struct neo4j_message_table *messages;
     bool insecure;
+    // from version 3, HELLO may only be sent once per connection
+    bool initialized;
 
     uint8_t *snd_buffer;
+    uint8_t *rcv_buffer;
+    size_t rcv_buffer_size;
+    size_t rcv_length;
     struct neo4j_request *request_queue;
 
+    // when non-blocking, messages are sent from an output buffer as the
+    // socket becomes writable, and are received by assembling whole frames
+    // in an input buffer
+    bool nonblocking;
+    int fd;
+    struct neo4j_nb_buffer nb_output;
+    struct neo4j_nb_buffer nb_input;
+    bool nb_flush_pending;
+
     neo4j_session_t *session;
 };
 
@@ -48,7 +75,8 @@ struct neo4j_connection
 /**
  * Send a message on a connection.
  *
- * This call may block until network buffers have sufficient space.
+ * This call may block until network buffers have sufficient space, unless
+ * the connection is in non-blocking mode.
  *
  * @internal
  *
@@ -62,6 +90,94 @@ __neo4j_must_check
 int neo4j_connection_send(neo4j_connection_t *connection,
         neo4j_message_type_t type, const neo4j_value_t *argv, uint16_t argc);
 
+/**
+ * Place a connection into non-blocking mode.
+ *
+ * Once in non-blocking mode, neo4j_connection_send() never blocks. Instead,
+ * any data that cannot be written immediately is held until the connection
+ * is next flushed (see neo4j_connection_flush()). Messages may then be
+ * received without blocking using neo4j_connection_try_recv(), whilst
+ * neo4j_connection_recv() continues to wait until a message is available.
+ *
+ * @internal
+ *
+ * @param [connection] The connection.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_connection_set_nonblocking(neo4j_connection_t *connection);
+
+/**
+ * Write any data held for a non-blocking connection.
+ *
+ * This call does not block.
+ *
+ * @internal
+ *
+ * @param [connection] The connection to flush.
+ * @return 0 if all data was written, 1 if some data remains to be written
+ *         once the connection is writable, or -1 on failure (errno will
+ *         be set).
+ */
+__neo4j_must_check
+int neo4j_connection_flush(neo4j_connection_t *connection);
+
+/**
+ * Check whether an idle connection remains usable.
+ *
+ * As nothing is expected from the server on an idle connection, it is not
+ * usable if the server has closed it, or if any data is waiting to be
+ * received. Where the underlying socket is available, this is checked
+ * without blocking. Otherwise the connection is assumed to be usable.
+ *
+ * @internal
+ *
+ * @param [connection] The idle connection.
+ * @return `true` if the connection is usable, and `false` otherwise.
+ */
+bool neo4j_connection_is_usable(neo4j_connection_t *connection);
+
+/**
+ * @fn bool neo4j_connection_flush_pending(const neo4j_connection_t *connection)
+ * @brief Check if a non-blocking connection has data to be written.
+ *
+ * @internal
+ *
+ * @param [connection] The connection.
+ * @return `true` if there is data to be written, `false` otherwise.
+ */
+#define neo4j_connection_flush_pending(c) \
+    ((c)->nb_output.length > 0 || (c)->nb_flush_pending)
+
+/**
+ * Receive a message on a non-blocking connection, if available.
+ *
+ * Available data is read from the network until a whole message has been
+ * received, or until no further data is available. This call does not
+ * block.
+ *
+ * @internal
+ *
+ * @param [connection] The connection to receive from.
+ * @param [mpool] A memory pool to allocate values and buffer spaces in.
+ * @param [type] A pointer to a message type, which will be updated.
+ * @param [argv] A pointer to an argument vector, which will be updated
+ *         to point to the received message arguments.
+ * @param [argc] A pointer to a `uin16_t`, which will be updated with the
+ *         length of the received argument vector.
+ * @param [record] `NULL`, or a pointer to a buffer pointer (as for
+ *         neo4j_connection_recv()).
+ * @param [rlength] A pointer to a `size_t`, which will be updated with the
+ *         length of the encoded record arguments.
+ * @return 0 if a message was received, 1 if no whole message is available
+ *         yet, or -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_connection_try_recv(neo4j_connection_t *connection,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength);
+
 /**
  * Receive a message on a connection.
  *
@@ -76,11 +192,74 @@ int neo4j_connection_send(neo4j_connection_t *connection,
  *         to point to the received message arguments.
  * @param [argc] A pointer to a `uin16_t`, which will be updated with the
  *         length of the received argument vector.
+ * @param [record] `NULL`, or a pointer to a buffer pointer. If not `NULL`
+ *         and a RECORD message is received, then the arguments are not
+ *         decoded and `*argv` is set to `NULL`. Instead, the buffer
+ *         pointer is updated to reference the encoded arguments, which
+ *         remain valid only until the next message is received (see
+ *         neo4j_connection_retain_frame()).
+ * @param [rlength] A pointer to a `size_t`, which will be updated with the
+ *         length of the encoded record arguments.
  * @return 0 on success, -1 on failure (errno will be set).
  */
 __neo4j_must_check
 int neo4j_connection_recv(neo4j_connection_t *connection, neo4j_mpool_t *mpool,
-        neo4j_message_type_t *type, const neo4j_value_t **argv, uint16_t *argc);
+        neo4j_message_type_t *type, const neo4j_value_t **argv, uint16_t *argc,
+        const uint8_t **record, size_t *rlength);
+
+/**
+ * Retain the most recently received message in a memory pool.
+ *
+ * The message remains valid until the memory pool is drained. This may be
+ * called at most once for each received message.
+ *
+ * @internal
+ *
+ * @param [connection] The connection the message was received on.
+ * @param [mpool] The memory pool to retain the message in.
+ * @param [ptr] A pointer into the received message, which will be updated
+ *         to reference the same position within the retained message.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_connection_retain_frame(neo4j_connection_t *connection,
+        neo4j_mpool_t *mpool, const uint8_t **ptr);
+
+/**
+ * Resolve the server address from a connection URI.
+ *
+ * Any authentication data in the URI is added to the supplied config.
+ *
+ * @internal
+ *
+ * @param [uri_string] The URI describing the server.
+ * @param [config] The client configuration to update.
+ * @param [port] A pointer that will be updated with the port number.
+ * @return A newly allocated hostname string, which must later be freed,
+ *         or `NULL` on failure (errno will be set).
+ */
+__neo4j_must_check
+char *neo4j_resolve_uri(const char *uri_string, neo4j_config_t *config,
+        unsigned int *port);
+
+/**
+ * Establish a connection to a neo4j server.
+ *
+ * On success, the connection takes ownership of the config, which will be
+ * released when the connection is closed.
+ *
+ * @internal
+ *
+ * @param [hostname] The hostname to connect to.
+ * @param [port] The port to connect to.
+ * @param [config] The client configuration for the connection.
+ * @param [flags] A bitmask of flags to control connections.
+ * @return A pointer to a `neo4j_connection_t` structure, or `NULL` on error
+ *         (errno will be set).
+ */
+__neo4j_must_check
+neo4j_connection_t *neo4j_establish_connection(const char *hostname,
+        unsigned int port, neo4j_config_t *config, uint_fast32_t flags);
 
 /**
  * Attach a session to a connection.
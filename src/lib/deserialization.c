@@ -20,13 +20,52 @@
 #include "values.h"
 #include <assert.h>
 #include <errno.h>
+#include <string.h>
 
 
-typedef int (*deserializer_t)(uint8_t marker, neo4j_iostream_t *stream,
+/*
+ * Values are decoded either directly from a stream, or from a buffer holding
+ * a complete message. In the latter case, reads are satisfied by advancing
+ * through the buffer, without any calls into the iostream layer, and strings
+ * may borrow their content directly from the buffer.
+ */
+struct source
+{
+    neo4j_iostream_t *stream;
+    const uint8_t *pos;
+    const uint8_t *end;
+    bool borrow;
+    bool inline_strings;
+    neo4j_intern_table_t *interns;
+    // set whilst decoding strings to be interned
+    bool interning;
+    // set whilst decoding the fields of a struct, which are accessed by
+    // item (e.g. the sequence of a path) and so are never packed
+    bool struct_field;
+};
+
+static inline int source_read(struct source *src, void *buf, size_t nbyte)
+{
+    if (src->stream != NULL)
+    {
+        return (neo4j_ios_read_all(src->stream, buf, nbyte, NULL) < 0)? -1 : 0;
+    }
+    if ((size_t)(src->end - src->pos) < nbyte)
+    {
+        errno = EPROTO;
+        return -1;
+    }
+    memcpy(buf, src->pos, nbyte);
+    src->pos += nbyte;
+    return 0;
+}
+
+
+typedef int (*deserializer_t)(uint8_t marker, struct source *src,
             neo4j_mpool_t *pool, neo4j_value_t *value);
 
 #define DESERIALIZER_FUNC_DEF(funcname) \
-    static int funcname(uint8_t marker, neo4j_iostream_t *stream, \
+    static int funcname(uint8_t marker, struct source *src, \
             neo4j_mpool_t *pool, neo4j_value_t *value)
 
 DESERIALIZER_FUNC_DEF(tiny_int_deserialize);
@@ -54,14 +93,24 @@ DESERIALIZER_FUNC_DEF(map32_deserialize);
 DESERIALIZER_FUNC_DEF(struct8_deserialize);
 DESERIALIZER_FUNC_DEF(struct16_deserialize);
 
-static int string_deserialize(uint32_t length, neo4j_iostream_t *stream,
+static int deserialize(struct source *src, neo4j_mpool_t *pool,
+        neo4j_value_t *value);
+static int deserialize_value(struct source *src, neo4j_mpool_t *pool,
+        neo4j_value_t *value);
+static int string_deserialize(uint32_t length, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value);
-static int list_deserialize(uint32_t nitems, neo4j_iostream_t *stream,
+static int list_deserialize(uint32_t nitems, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value);
-static int map_deserialize(uint32_t nentries, neo4j_iostream_t *stream,
+static int packed_list_deserialize(uint32_t nitems, neo4j_value_t item,
+        struct source *src, neo4j_mpool_t *pool, neo4j_value_t *value);
+static int list_items_deserialize(uint32_t nitems, uint32_t ndecoded,
+        neo4j_value_t *items, struct source *src, neo4j_mpool_t *pool,
+        neo4j_value_t *value);
+static int map_deserialize(uint32_t nentries, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value);
-static int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
+static int struct_deserialize(uint16_t nfields, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value);
+static inline bool is_interned_field(uint8_t signature, unsigned int index);
 
 
 static const deserializer_t deserializers[UINT8_MAX+1] =
@@ -329,38 +378,243 @@ int neo4j_deserialize(neo4j_iostream_t *stream, neo4j_mpool_t *pool,
     REQUIRE(stream != NULL, -1);
     REQUIRE(pool != NULL, -1);
     REQUIRE(value != NULL, -1);
-    size_t pdepth = neo4j_mpool_depth(*pool);
 
+    struct source src = { .stream = stream };
+    return deserialize(&src, pool, value);
+}
+
+
+int neo4j_deserialize_buffer(const uint8_t **buf, const uint8_t *end,
+        bool borrow, neo4j_mpool_t *pool, neo4j_value_t *value)
+{
+    return neo4j_deserialize_interned(buf, end, borrow, false, NULL, pool,
+            value);
+}
+
+
+int neo4j_deserialize_interned(const uint8_t **buf, const uint8_t *end,
+        bool borrow, bool inline_strings, neo4j_intern_table_t *interns,
+        neo4j_mpool_t *pool, neo4j_value_t *value)
+{
+    REQUIRE(buf != NULL && *buf != NULL, -1);
+    REQUIRE(end >= *buf, -1);
+    REQUIRE(pool != NULL, -1);
+    REQUIRE(value != NULL, -1);
+
+    struct source src =
+            { .stream = NULL, .pos = *buf, .end = end, .borrow = borrow,
+              .inline_strings = inline_strings, .interns = interns };
+    if (deserialize(&src, pool, value))
+    {
+        return -1;
+    }
+    *buf = src.pos;
+    return 0;
+}
+
+
+int neo4j_deserialize_list_header(const uint8_t **buf, const uint8_t *end,
+        uint32_t *nitems)
+{
+    REQUIRE(buf != NULL && *buf != NULL, -1);
+    REQUIRE(end >= *buf, -1);
+    REQUIRE(nitems != NULL, -1);
+
+    struct source src = { .stream = NULL, .pos = *buf, .end = end };
     uint8_t marker;
-    if (neo4j_ios_read_all(stream, &marker, sizeof(marker), NULL) < 0)
+    if (source_read(&src, &marker, sizeof(marker)))
     {
-        goto failure;
+        return -1;
     }
 
-    deserializer_t deserialize = deserializers[marker];
-    if (deserialize == NULL)
+    if ((marker & 0xF0) == 0x90)
+    {
+        *nitems = marker & 0x0F;
+    }
+    else if (marker == 0xD4)
+    {
+        uint8_t n;
+        if (source_read(&src, &n, sizeof(n)))
+        {
+            return -1;
+        }
+        *nitems = n;
+    }
+    else if (marker == 0xD5)
+    {
+        uint16_t n;
+        if (source_read(&src, &n, sizeof(n)))
+        {
+            return -1;
+        }
+        *nitems = ntohs(n);
+    }
+    else if (marker == 0xD6)
+    {
+        uint32_t n;
+        if (source_read(&src, &n, sizeof(n)))
+        {
+            return -1;
+        }
+        *nitems = ntohl(n);
+    }
+    else
     {
         errno = EPROTO;
-        goto failure;
+        return -1;
     }
 
-    if (deserialize(marker, stream, pool, value))
+    *buf = src.pos;
+    return 0;
+}
+
+
+int neo4j_deserialize_skip(const uint8_t **buf, const uint8_t *end)
+{
+    REQUIRE(buf != NULL && *buf != NULL, -1);
+    REQUIRE(end >= *buf, -1);
+
+    const uint8_t *pos = *buf;
+    // values still to be skipped, including the elements of any containers
+    // that have been entered
+    uint64_t remaining = 1;
+    do
     {
-        goto failure;
-    }
+        if (pos >= end)
+        {
+            goto invalid;
+        }
+        uint8_t marker = *(pos++);
+        --remaining;
+
+        uint64_t size = 0;
+        size_t nbytes = 0;
+        switch (marker & 0xF0)
+        {
+        case 0x80: // tiny string
+            size = marker & 0x0F;
+            break;
+        case 0x90: // tiny list
+            remaining += marker & 0x0F;
+            break;
+        case 0xA0: // tiny map
+            remaining += (marker & 0x0F) * 2;
+            break;
+        case 0xB0: // tiny struct (and signature)
+            remaining += marker & 0x0F;
+            size = 1;
+            break;
+        case 0xC0:
+        case 0xD0:
+            if (deserializers[marker] == NULL)
+            {
+                goto invalid;
+            }
+            switch (marker)
+            {
+            case 0xC1: nbytes = 8; break;
+            case 0xC8: nbytes = 1; break;
+            case 0xC9: nbytes = 2; break;
+            case 0xCA: nbytes = 4; break;
+            case 0xCB: nbytes = 8; break;
+            case 0xD0: case 0xD4: case 0xD8: case 0xDC: nbytes = 1; break;
+            case 0xD1: case 0xD5: case 0xD9: case 0xDD: nbytes = 2; break;
+            case 0xD2: case 0xD6: case 0xDA: nbytes = 4; break;
+            }
+            if ((size_t)(end - pos) < nbytes)
+            {
+                goto invalid;
+            }
+            if (marker >= 0xD0)
+            {
+                for (size_t i = 0; i < nbytes; ++i)
+                {
+                    size = (size << 8) | pos[i];
+                }
+                pos += nbytes;
+                switch (marker & 0x0C)
+                {
+                case 0x04: // list
+                    remaining += size;
+                    size = 0;
+                    break;
+                case 0x08: // map
+                    remaining += size * 2;
+                    size = 0;
+                    break;
+                case 0x0C: // struct
+                    remaining += size;
+                    size = 1;
+                    break;
+                }
+            }
+            else
+            {
+                size = nbytes;
+            }
+            break;
+        case 0xE0:
+            goto invalid;
+        default: // tiny int
+            break;
+        }
+
+        if ((uint64_t)(end - pos) < size)
+        {
+            goto invalid;
+        }
+        pos += size;
+        // every value occupies at least one byte
+        if (remaining > (uint64_t)(end - pos))
+        {
+            goto invalid;
+        }
+    } while (remaining > 0);
 
+    *buf = pos;
     return 0;
 
-    int errsv;
-failure:
-    errsv = errno;
-    neo4j_mpool_drainto(pool, pdepth);
-    errno = errsv;
+invalid:
+    errno = EPROTO;
     return -1;
 }
 
 
-int tiny_int_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int deserialize(struct source *src, neo4j_mpool_t *pool, neo4j_value_t *value)
+{
+    neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*pool);
+    if (deserialize_value(src, pool, value))
+    {
+        int errsv = errno;
+        neo4j_mpool_drainto_mark(pool, pmark);
+        errno = errsv;
+        return -1;
+    }
+    return 0;
+}
+
+
+int deserialize_value(struct source *src, neo4j_mpool_t *pool,
+        neo4j_value_t *value)
+{
+    uint8_t marker;
+    if (source_read(src, &marker, sizeof(marker)))
+    {
+        return -1;
+    }
+
+    deserializer_t deserializer = deserializers[marker];
+    if (deserializer == NULL)
+    {
+        errno = EPROTO;
+        return -1;
+    }
+
+    return deserializer(marker, src, pool, value);
+}
+
+
+int tiny_int_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     *value = neo4j_int((int8_t)marker);
@@ -368,43 +622,43 @@ int tiny_int_deserialize(uint8_t marker, neo4j_iostream_t *stream,
 }
 
 
-int tiny_string_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int tiny_string_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint32_t length = marker & 0x0F;
-    return string_deserialize(length, stream, pool, value);
+    return string_deserialize(length, src, pool, value);
 }
 
 
-int tiny_list_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int tiny_list_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nitems = marker & 0x0F;
-    return list_deserialize(nitems, stream, pool, value);
+    return list_deserialize(nitems, src, pool, value);
 }
 
-int tiny_map_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int tiny_map_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nentries = marker & 0x0F;
-    return map_deserialize(nentries, stream, pool, value);
+    return map_deserialize(nentries, src, pool, value);
 }
 
-int tiny_struct_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int tiny_struct_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nfields = marker & 0x0F;
-    return struct_deserialize(nfields, stream, pool, value);
+    return struct_deserialize(nfields, src, pool, value);
 }
 
-int null_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int null_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     *value = neo4j_null;
     return 0;
 }
 
-int float_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int float_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     union
@@ -413,8 +667,7 @@ int float_deserialize(uint8_t marker, neo4j_iostream_t *stream,
         double value;
     } double_data;
 
-    if (neo4j_ios_read_all(stream, &(double_data.data),
-                sizeof(double_data.data), NULL) < 0)
+    if (source_read(src, &(double_data.data), sizeof(double_data.data)))
     {
         return -1;
     }
@@ -424,25 +677,25 @@ int float_deserialize(uint8_t marker, neo4j_iostream_t *stream,
     return 0;
 }
 
-int boolean_false_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int boolean_false_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     *value = neo4j_bool(false);
     return 0;
 }
 
-int boolean_true_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int boolean_true_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     *value = neo4j_bool(true);
     return 0;
 }
 
-int int8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int int8_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     int8_t data;
-    if (neo4j_ios_read_all(stream, &data, sizeof(data), NULL) < 0)
+    if (source_read(src, &data, sizeof(data)))
     {
         return -1;
     }
@@ -450,11 +703,11 @@ int int8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
     return 0;
 }
 
-int int16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int int16_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     int16_t data;
-    if (neo4j_ios_read_all(stream, &data, sizeof(data), NULL) < 0)
+    if (source_read(src, &data, sizeof(data)))
     {
         return -1;
     }
@@ -463,11 +716,11 @@ int int16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
     return 0;
 }
 
-int int32_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int int32_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     int32_t data;
-    if (neo4j_ios_read_all(stream, &data, sizeof(data), NULL) < 0)
+    if (source_read(src, &data, sizeof(data)))
     {
         return -1;
     }
@@ -476,11 +729,11 @@ int int32_deserialize(uint8_t marker, neo4j_iostream_t *stream,
     return 0;
 }
 
-int int64_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int int64_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     int64_t data;
-    if (neo4j_ios_read_all(stream, &data, sizeof(data), NULL) < 0)
+    if (source_read(src, &data, sizeof(data)))
     {
         return -1;
     }
@@ -489,137 +742,179 @@ int int64_deserialize(uint8_t marker, neo4j_iostream_t *stream,
     return 0;
 }
 
-int string8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int string8_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint8_t length;
-    if (neo4j_ios_read_all(stream, &length, sizeof(length), NULL) < 0)
+    if (source_read(src, &length, sizeof(length)))
     {
         return -1;
     }
-    return string_deserialize(length, stream, pool, value);
+    return string_deserialize(length, src, pool, value);
 }
 
-int string16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int string16_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t length;
-    if (neo4j_ios_read_all(stream, &length, sizeof(length), NULL) < 0)
+    if (source_read(src, &length, sizeof(length)))
     {
         return -1;
     }
     length = ntohs(length);
-    return string_deserialize(length, stream, pool, value);
+    return string_deserialize(length, src, pool, value);
 }
 
-int string32_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int string32_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint32_t length;
-    if (neo4j_ios_read_all(stream, &length, sizeof(length), NULL) < 0)
+    if (source_read(src, &length, sizeof(length)))
     {
         return -1;
     }
     length = ntohl(length);
-    return string_deserialize(length, stream, pool, value);
+    return string_deserialize(length, src, pool, value);
 }
 
-int list8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int list8_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint8_t nitems;
-    if (neo4j_ios_read_all(stream, &nitems, sizeof(nitems), NULL) < 0)
+    if (source_read(src, &nitems, sizeof(nitems)))
     {
         return -1;
     }
-    return list_deserialize(nitems, stream, pool, value);
+    return list_deserialize(nitems, src, pool, value);
 }
 
-int list16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int list16_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nitems;
-    if (neo4j_ios_read_all(stream, &nitems, sizeof(nitems), NULL) < 0)
+    if (source_read(src, &nitems, sizeof(nitems)))
     {
         return -1;
     }
     nitems = ntohs(nitems);
-    return list_deserialize(nitems, stream, pool, value);
+    return list_deserialize(nitems, src, pool, value);
 }
 
-int list32_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int list32_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
-    uint16_t nitems;
-    if (neo4j_ios_read_all(stream, &nitems, sizeof(nitems), NULL) < 0)
+    uint32_t nitems;
+    if (source_read(src, &nitems, sizeof(nitems)))
     {
         return -1;
     }
     nitems = ntohl(nitems);
-    return list_deserialize(nitems, stream, pool, value);
+    return list_deserialize(nitems, src, pool, value);
 }
 
-int map8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int map8_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint8_t nentries;
-    if (neo4j_ios_read_all(stream, &nentries, sizeof(nentries), NULL) < 0)
+    if (source_read(src, &nentries, sizeof(nentries)))
     {
         return -1;
     }
-    return map_deserialize(nentries, stream, pool, value);
+    return map_deserialize(nentries, src, pool, value);
 }
 
-int map16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int map16_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nentries;
-    if (neo4j_ios_read_all(stream, &nentries, sizeof(nentries), NULL) < 0)
+    if (source_read(src, &nentries, sizeof(nentries)))
     {
         return -1;
     }
     nentries = ntohs(nentries);
-    return map_deserialize(nentries, stream, pool, value);
+    return map_deserialize(nentries, src, pool, value);
 }
 
-int map32_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int map32_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint32_t nentries;
-    if (neo4j_ios_read_all(stream, &nentries, sizeof(nentries), NULL) < 0)
+    if (source_read(src, &nentries, sizeof(nentries)))
     {
         return -1;
     }
     nentries = ntohl(nentries);
-    return map_deserialize(nentries, stream, pool, value);
+    return map_deserialize(nentries, src, pool, value);
 }
 
-int struct8_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int struct8_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint8_t nfields;
-    if (neo4j_ios_read_all(stream, &nfields, sizeof(nfields), NULL) < 0)
+    if (source_read(src, &nfields, sizeof(nfields)))
     {
         return -1;
     }
-    return struct_deserialize(nfields, stream, pool, value);
+    return struct_deserialize(nfields, src, pool, value);
 }
 
-int struct16_deserialize(uint8_t marker, neo4j_iostream_t *stream,
+int struct16_deserialize(uint8_t marker, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint16_t nfields;
-    if (neo4j_ios_read_all(stream, &nfields, sizeof(nfields), NULL) < 0)
+    if (source_read(src, &nfields, sizeof(nfields)))
     {
         return -1;
     }
     nfields = ntohs(nfields);
-    return struct_deserialize(nfields, stream, pool, value);
+    return struct_deserialize(nfields, src, pool, value);
 }
 
-int string_deserialize(uint32_t length, neo4j_iostream_t *stream,
+int string_deserialize(uint32_t length, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
+    if (src->inline_strings && length <= NEO4J_STRING_INLINE_LENGTH)
+    {
+        char ustring[NEO4J_STRING_INLINE_LENGTH];
+        if (source_read(src, ustring, length))
+        {
+            return -1;
+        }
+        *value = neo4j_inline_ustring(ustring, length);
+        return 0;
+    }
+
+    if (src->borrow)
+    {
+        if ((size_t)(src->end - src->pos) < length)
+        {
+            errno = EPROTO;
+            return -1;
+        }
+        *value = neo4j_ustring((const char *)src->pos, length);
+        src->pos += length;
+        return 0;
+    }
+
+    if (src->interning && src->interns != NULL)
+    {
+        assert(src->stream == NULL);
+        if ((size_t)(src->end - src->pos) < length)
+        {
+            errno = EPROTO;
+            return -1;
+        }
+        const char *interned = neo4j_intern(src->interns,
+                (const char *)src->pos, length);
+        if (interned != NULL)
+        {
+            *value = neo4j_ustring(interned, length);
+            src->pos += length;
+            return 0;
+        }
+        // otherwise copied into the pool, as any other string
+    }
+
     char *ustring = NULL;
     if (length > 0)
     {
@@ -629,7 +924,7 @@ int string_deserialize(uint32_t length, neo4j_iostream_t *stream,
             return -1;
         }
 
-        if (neo4j_ios_read_all(stream, ustring, length, NULL) < 0)
+        if (source_read(src, ustring, length))
         {
             return -1;
         }
@@ -640,24 +935,119 @@ int string_deserialize(uint32_t length, neo4j_iostream_t *stream,
 }
 
 
-int list_deserialize(uint32_t nitems, neo4j_iostream_t *stream,
+int list_deserialize(uint32_t nitems, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
-    neo4j_value_t *items = NULL;
-    if (nitems > 0)
+    bool packable = !src->struct_field;
+    src->struct_field = false;
+
+    if (nitems == 0)
+    {
+        *value = neo4j_list(NULL, 0);
+        return 0;
+    }
+
+    neo4j_value_t item;
+    if (deserialize_value(src, pool, &item))
+    {
+        return -1;
+    }
+
+    // lists starting with an integer or float are packed, unless another
+    // type of item is found
+    neo4j_type_t type = neo4j_type(item);
+    if (packable && (type == NEO4J_INT || type == NEO4J_FLOAT))
+    {
+        return packed_list_deserialize(nitems, item, src, pool, value);
+    }
+
+    neo4j_value_t *items = neo4j_mpool_calloc(pool, nitems,
+            sizeof(neo4j_value_t));
+    if (items == NULL)
+    {
+        return -1;
+    }
+    items[0] = item;
+    return list_items_deserialize(nitems, 1, items, src, pool, value);
+}
+
+
+int packed_list_deserialize(uint32_t nitems, neo4j_value_t item,
+        struct source *src, neo4j_mpool_t *pool, neo4j_value_t *value)
+{
+    neo4j_type_t type = neo4j_type(item);
+    assert(type == NEO4J_INT || type == NEO4J_FLOAT);
+    int64_t *ints = NULL;
+    double *floats = NULL;
+    if (type == NEO4J_INT)
     {
-        items = neo4j_mpool_calloc(pool, nitems, sizeof(neo4j_value_t));
+        ints = neo4j_mpool_calloc(pool, nitems, sizeof(int64_t));
+    }
+    else
+    {
+        floats = neo4j_mpool_calloc(pool, nitems, sizeof(double));
+    }
+    if (ints == NULL && floats == NULL)
+    {
+        return -1;
+    }
+
+    for (uint32_t i = 0;;)
+    {
+        if (ints != NULL)
+        {
+            ints[i] = neo4j_int_value(item);
+        }
+        else
+        {
+            floats[i] = neo4j_float_value(item);
+        }
+
+        if (++i >= nitems)
+        {
+            break;
+        }
+        if (deserialize_value(src, pool, &item))
+        {
+            return -1;
+        }
+        if (neo4j_type(item) == type)
+        {
+            continue;
+        }
+
+        // the items are not all of the same type, so are held as values
+        neo4j_value_t *items = neo4j_mpool_calloc(pool, nitems,
+                sizeof(neo4j_value_t));
         if (items == NULL)
         {
             return -1;
         }
+        for (uint32_t j = 0; j < i; ++j)
+        {
+            items[j] = (ints != NULL)? neo4j_int(ints[j]) :
+                neo4j_float(floats[j]);
+        }
+        items[i] = item;
+        return list_items_deserialize(nitems, i + 1, items, src, pool,
+                value);
+    }
+
+    *value = (ints != NULL)? neo4j_int_list(ints, nitems) :
+        neo4j_float_list(floats, nitems);
+    return 0;
+}
+
 
-        for (unsigned i = 0; i < nitems; ++i)
+int list_items_deserialize(uint32_t nitems, uint32_t ndecoded,
+        neo4j_value_t *items, struct source *src, neo4j_mpool_t *pool,
+        neo4j_value_t *value)
+{
+    for (uint32_t i = ndecoded; i < nitems; ++i)
+    {
+        if (deserialize_value(src, pool, &(items[i])))
         {
-            if (neo4j_deserialize(stream, pool, &(items[i])))
-            {
-                return -1;
-            }
+            return -1;
         }
     }
 
@@ -666,32 +1056,44 @@ int list_deserialize(uint32_t nitems, neo4j_iostream_t *stream,
 }
 
 
-int map_deserialize(uint32_t nentries, neo4j_iostream_t *stream,
+int map_deserialize(uint32_t nentries, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     neo4j_map_entry_t *entries = NULL;
     if (nentries > 0)
     {
-        entries = neo4j_mpool_calloc(pool, nentries, sizeof(neo4j_map_entry_t));
+        // larger maps are allocated with space for an index of their keys
+        size_t index_size = neo4j_map_index_size(nentries);
+        if (nentries > (SIZE_MAX - index_size) / sizeof(neo4j_map_entry_t))
+        {
+            errno = ENOMEM;
+            return -1;
+        }
+        entries = neo4j_mpool_calloc(pool, 1,
+                nentries * sizeof(neo4j_map_entry_t) + index_size);
         if (entries == NULL)
         {
             return -1;
         }
 
+        src->struct_field = false;
+        bool interning = src->interning;
         for (unsigned i = 0; i < nentries; ++i)
         {
-            if (neo4j_deserialize(stream, pool, &(entries[i].key)))
+            src->interning = true;
+            if (deserialize_value(src, pool, &(entries[i].key)))
             {
                 return -1;
             }
-            if (neo4j_deserialize(stream, pool, &(entries[i].value)))
+            src->interning = interning;
+            if (deserialize_value(src, pool, &(entries[i].value)))
             {
                 return -1;
             }
         }
     }
 
-    neo4j_value_t v = neo4j_map(entries, nentries);
+    neo4j_value_t v = neo4j_indexed_map(entries, nentries);
     if (neo4j_is_null(v))
     {
         errno = EPROTO;
@@ -702,11 +1104,11 @@ int map_deserialize(uint32_t nentries, neo4j_iostream_t *stream,
 }
 
 
-int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
+int struct_deserialize(uint16_t nfields, struct source *src,
         neo4j_mpool_t *pool, neo4j_value_t *value)
 {
     uint8_t signature;
-    if (neo4j_ios_read_all(stream, &signature, sizeof(signature), NULL) < 0)
+    if (source_read(src, &signature, sizeof(signature)))
     {
         return -1;
     }
@@ -720,20 +1122,28 @@ int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
             return -1;
         }
 
+        bool interning = src->interning;
+        bool struct_field = src->struct_field;
         for (unsigned i = 0; i < nfields; ++i)
         {
-            if (neo4j_deserialize(stream, pool, &(fields[i])))
+            src->interning = is_interned_field(signature, i);
+            src->struct_field = true;
+            if (deserialize_value(src, pool, &(fields[i])))
             {
                 return -1;
             }
         }
+        src->interning = interning;
+        src->struct_field = struct_field;
     }
 
     neo4j_value_t v;
     switch (signature)
     {
+    // from version 5, nodes and relationships have additional fields
+    // (which are ignored)
     case NEO4J_NODE_SIGNATURE:
-        if (nfields != 3 || neo4j_type(fields[0]) != NEO4J_INT)
+        if (nfields < 3 || neo4j_type(fields[0]) != NEO4J_INT)
         {
             errno = EPROTO;
             return -1;
@@ -747,7 +1157,7 @@ int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
         v = neo4j_node(fields);
         break;
     case NEO4J_REL_SIGNATURE:
-        if (nfields != 5 ||
+        if (nfields < 5 ||
                 neo4j_type(fields[0]) != NEO4J_INT ||
                 neo4j_type(fields[1]) != NEO4J_INT ||
                 neo4j_type(fields[2]) != NEO4J_INT)
@@ -776,7 +1186,7 @@ int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
         v = neo4j_path(fields);
         break;
     case NEO4J_UNBOUND_REL_SIGNATURE:
-        if (nfields != 3 || neo4j_type(fields[0]) != NEO4J_INT)
+        if (nfields < 3 || neo4j_type(fields[0]) != NEO4J_INT)
         {
             errno = EPROTO;
             return -1;
@@ -802,3 +1212,20 @@ int struct_deserialize(uint16_t nfields, neo4j_iostream_t *stream,
     *value = v;
     return 0;
 }
+
+
+bool is_interned_field(uint8_t signature, unsigned int index)
+{
+    // the labels of nodes and the types of relationships
+    switch (signature)
+    {
+    case NEO4J_NODE_SIGNATURE:
+        return index == 1;
+    case NEO4J_REL_SIGNATURE:
+        return index == 3;
+    case NEO4J_UNBOUND_REL_SIGNATURE:
+        return index == 1;
+    default:
+        return false;
+    }
+}
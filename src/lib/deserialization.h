@@ -18,6 +18,7 @@
 #define NEO4J_DESERIALIZATION_H
 
 #include "neo4j-client.h"
+#include "intern.h"
 #include "iostream.h"
 #include "memory.h"
 
@@ -35,4 +36,84 @@ __neo4j_must_check
 int neo4j_deserialize(neo4j_iostream_t *stream, neo4j_mpool_t *mpool,
         neo4j_value_t *value);
 
+/**
+ * Read a neo4j value from a memory buffer.
+ *
+ * @internal
+ *
+ * @param [buf] A pointer to the start of the encoded value in the buffer,
+ *         which will be advanced past the value on success.
+ * @param [end] A pointer to the end of the buffer.
+ * @param [borrow] `true` if string values should reference their content
+ *         directly within the buffer, rather than copying it into the
+ *         memory pool. The buffer must then remain valid for as long as
+ *         the value is in use.
+ * @param [mpool] The memory pool to allocate value space in.
+ * @param [value] A pointer to a neo4j value, which will be updated.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_deserialize_buffer(const uint8_t **buf, const uint8_t *end,
+        bool borrow, neo4j_mpool_t *mpool, neo4j_value_t *value);
+
+/**
+ * Read a neo4j value from a memory buffer, with the options used for
+ * result records.
+ *
+ * @internal
+ *
+ * @param [buf] A pointer to the start of the encoded value in the buffer,
+ *         which will be advanced past the value on success.
+ * @param [end] A pointer to the end of the buffer.
+ * @param [borrow] `true` if string values should reference their content
+ *         directly within the buffer, as for neo4j_deserialize_buffer().
+ * @param [inline_strings] `true` if strings of up to
+ *         `NEO4J_STRING_INLINE_LENGTH` bytes should hold their content
+ *         within the value.
+ * @param [interns] An intern table for map keys, node labels and
+ *         relationship types, or `NULL`.
+ * @param [mpool] The memory pool to allocate value space in.
+ * @param [value] A pointer to a neo4j value, which will be updated.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_deserialize_interned(const uint8_t **buf, const uint8_t *end,
+        bool borrow, bool inline_strings, neo4j_intern_table_t *interns,
+        neo4j_mpool_t *mpool, neo4j_value_t *value);
+
+/**
+ * Read the header of an encoded list from a memory buffer.
+ *
+ * The items of the list follow the header in the buffer.
+ *
+ * @internal
+ *
+ * @param [buf] A pointer to the start of the encoded list in the buffer,
+ *         which will be advanced past the header on success.
+ * @param [end] A pointer to the end of the buffer.
+ * @param [nitems] A pointer to a `uint32_t`, which will be updated with the
+ *         number of items in the list.
+ * @return 0 on success, -1 on failure (errno will be set to `EPROTO` if the
+ *         value is not a list).
+ */
+__neo4j_must_check
+int neo4j_deserialize_list_header(const uint8_t **buf, const uint8_t *end,
+        uint32_t *nitems);
+
+/**
+ * Skip over an encoded neo4j value in a memory buffer.
+ *
+ * The value is not decoded, and no memory is allocated, but the encoding
+ * is checked to be well formed.
+ *
+ * @internal
+ *
+ * @param [buf] A pointer to the start of the encoded value in the buffer,
+ *         which will be advanced past the value on success.
+ * @param [end] A pointer to the end of the buffer.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_deserialize_skip(const uint8_t **buf, const uint8_t *end);
+
 #endif/*NEO4J_DESERIALIZATION_H*/
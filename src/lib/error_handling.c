@@ -92,6 +92,12 @@ const char *neo4j_strerror(int errnum, char *buf, size_t buflen)
         return "Too many authentication attempts - wait 5 seconds before trying again";
     case NEO4J_TLS_MALFORMED_CERTIFICATE:
         return "Server presented a malformed TLS certificate";
+    case NEO4J_TRANSACTION_ACTIVE:
+        return "Session already has an open transaction";
+    case NEO4J_NO_TRANSACTION:
+        return "Session has no open transaction";
+    case NEO4J_TRANSACTION_FAILED:
+        return "Transaction failed and was rolled back";
     default:
 #ifdef STRERROR_R_CHAR_P
         return strerror_r(errnum, buf, buflen);
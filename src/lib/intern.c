@@ -0,0 +1,213 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "intern.h"
+#include "client_config.h"
+#include "util.h"
+#include "values.h"
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 64
+
+
+static const char *find_or_insert(neo4j_intern_table_t *table,
+        const char *ustring, uint32_t length);
+static int grow(neo4j_intern_table_t *table);
+static struct neo4j_intern_slot *find_slot(struct neo4j_intern_slot *slots,
+        unsigned int capacity, const char *ustring, uint32_t length,
+        uint32_t hash);
+
+
+neo4j_intern_table_t *neo4j_intern_table_new(const neo4j_config_t *config)
+{
+    REQUIRE(config != NULL, NULL);
+    neo4j_memory_allocator_t *allocator = config->allocator;
+
+    neo4j_intern_table_t *table = neo4j_calloc(allocator, NULL,
+            1, sizeof(neo4j_intern_table_t));
+    if (table == NULL)
+    {
+        return NULL;
+    }
+    table->slots = neo4j_calloc(allocator, NULL,
+            INITIAL_CAPACITY, sizeof(struct neo4j_intern_slot));
+    if (table->slots == NULL)
+    {
+        goto failure;
+    }
+    int err = neo4j_mutex_init(&(table->mutex));
+    if (err != 0)
+    {
+        errno = err;
+        goto failure;
+    }
+
+    table->allocator = allocator;
+    atomic_init(&(table->refcount), 1);
+    table->mpool = neo4j_std_mpool(config);
+    table->capacity = INITIAL_CAPACITY;
+    return table;
+
+    int errsv;
+failure:
+    errsv = errno;
+    if (table->slots != NULL)
+    {
+        neo4j_free(allocator, table->slots);
+    }
+    neo4j_free(allocator, table);
+    errno = errsv;
+    return NULL;
+}
+
+
+neo4j_intern_table_t *neo4j_intern_table_retain(neo4j_intern_table_t *table)
+{
+    assert(table != NULL);
+    atomic_fetch_add(&(table->refcount), 1);
+    return table;
+}
+
+
+void neo4j_intern_table_release(neo4j_intern_table_t *table)
+{
+    if (table == NULL || atomic_fetch_sub(&(table->refcount), 1) > 1)
+    {
+        return;
+    }
+    neo4j_mpool_drain(&(table->mpool));
+    neo4j_mutex_destroy(&(table->mutex));
+    neo4j_free(table->allocator, table->slots);
+    neo4j_free(table->allocator, table);
+}
+
+
+const char *neo4j_intern(neo4j_intern_table_t *table, const char *ustring,
+        uint32_t length)
+{
+    assert(table != NULL);
+    if (length == 0 || length > NEO4J_INTERN_MAX_LENGTH)
+    {
+        return NULL;
+    }
+
+    neo4j_mutex_lock(&(table->mutex));
+    const char *interned = find_or_insert(table, ustring, length);
+    neo4j_mutex_unlock(&(table->mutex));
+    return interned;
+}
+
+
+const char *find_or_insert(neo4j_intern_table_t *table, const char *ustring,
+        uint32_t length)
+{
+    uint32_t hash = neo4j_ustring_hash(ustring, length);
+    struct neo4j_intern_slot *slot = find_slot(table->slots,
+            table->capacity, ustring, length, hash);
+    if (slot->ustring != NULL)
+    {
+        table->stats.hits++;
+        table->stats.bytes_saved += length;
+        return slot->ustring;
+    }
+
+    if (table->nstrings >= NEO4J_INTERN_MAX_STRINGS)
+    {
+        return NULL;
+    }
+    // kept at most half full
+    if ((table->nstrings + 1) > (table->capacity >> 1))
+    {
+        if (grow(table))
+        {
+            return NULL;
+        }
+        slot = find_slot(table->slots, table->capacity, ustring, length,
+                hash);
+    }
+
+    char *copy = neo4j_mpool_alloc(&(table->mpool), length);
+    if (copy == NULL)
+    {
+        return NULL;
+    }
+    memcpy(copy, ustring, length);
+    slot->hash = hash;
+    slot->length = length;
+    slot->ustring = copy;
+    table->nstrings++;
+    table->stats.strings++;
+    return copy;
+}
+
+
+int grow(neo4j_intern_table_t *table)
+{
+    unsigned int capacity = table->capacity << 1;
+    struct neo4j_intern_slot *slots = neo4j_calloc(table->allocator, NULL,
+            capacity, sizeof(struct neo4j_intern_slot));
+    if (slots == NULL)
+    {
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < table->capacity; ++i)
+    {
+        struct neo4j_intern_slot *old = &(table->slots[i]);
+        if (old->ustring != NULL)
+        {
+            *find_slot(slots, capacity, old->ustring, old->length,
+                    old->hash) = *old;
+        }
+    }
+
+    neo4j_free(table->allocator, table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return 0;
+}
+
+
+struct neo4j_intern_slot *find_slot(struct neo4j_intern_slot *slots,
+        unsigned int capacity, const char *ustring, uint32_t length,
+        uint32_t hash)
+{
+    unsigned int mask = capacity - 1;
+    unsigned int i = hash & mask;
+    for (; slots[i].ustring != NULL; i = (i + 1) & mask)
+    {
+        if (slots[i].hash == hash && slots[i].length == length &&
+                memcmp(slots[i].ustring, ustring, length) == 0)
+        {
+            break;
+        }
+    }
+    return &(slots[i]);
+}
+
+
+struct neo4j_intern_stats neo4j_intern_table_stats(
+        neo4j_intern_table_t *table)
+{
+    assert(table != NULL);
+    neo4j_mutex_lock(&(table->mutex));
+    struct neo4j_intern_stats stats = table->stats;
+    neo4j_mutex_unlock(&(table->mutex));
+    return stats;
+}
@@ -0,0 +1,118 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NEO4J_INTERN_H
+#define NEO4J_INTERN_H
+
+#include "neo4j-client.h"
+#include "memory.h"
+#include "thread.h"
+#include <stdatomic.h>
+
+// longer strings, and strings beyond the maximum number, are not interned
+#define NEO4J_INTERN_MAX_LENGTH 64
+#define NEO4J_INTERN_MAX_STRINGS 4096
+
+struct neo4j_intern_slot
+{
+    uint32_t hash;
+    uint32_t length;
+    const char *ustring;
+};
+
+/*
+ * A set of strings, such that equal strings decoded from different records
+ * can share one allocation.
+ *
+ * The table is reference counted, as the strings are referenced from
+ * records that may outlive the result stream, and may be used from multiple
+ * threads (e.g. by workers decoding records).
+ */
+typedef struct neo4j_intern_table neo4j_intern_table_t;
+struct neo4j_intern_table
+{
+    neo4j_memory_allocator_t *allocator;
+    atomic_uint refcount;
+    neo4j_mutex_t mutex;
+    neo4j_mpool_t mpool;
+    struct neo4j_intern_slot *slots;
+    unsigned int capacity;
+    unsigned int nstrings;
+    struct neo4j_intern_stats stats;
+};
+
+
+/**
+ * Create an intern table.
+ *
+ * @internal
+ *
+ * @param [config] The client configuration.
+ * @return The intern table, with a reference count of 1, or `NULL` on
+ *         failure (errno will be set).
+ */
+__neo4j_must_check
+neo4j_intern_table_t *neo4j_intern_table_new(const neo4j_config_t *config);
+
+/**
+ * Retain a reference to an intern table.
+ *
+ * @internal
+ *
+ * @param [table] The intern table.
+ * @return The intern table.
+ */
+neo4j_intern_table_t *neo4j_intern_table_retain(neo4j_intern_table_t *table);
+
+/**
+ * Release a reference to an intern table.
+ *
+ * The table, and all strings interned in it, are freed once no references
+ * remain.
+ *
+ * @internal
+ *
+ * @param [table] The intern table, or `NULL`.
+ */
+void neo4j_intern_table_release(neo4j_intern_table_t *table);
+
+/**
+ * Intern a string.
+ *
+ * @internal
+ *
+ * @param [table] The intern table.
+ * @param [ustring] The string, which need not be `NULL` terminated.
+ * @param [length] The length of the string.
+ * @return The interned copy of the string, which remains valid for the
+ *         lifetime of the table, or `NULL` if the string is not interned
+ *         (errno will be set if memory could not be allocated).
+ */
+const char *neo4j_intern(neo4j_intern_table_t *table, const char *ustring,
+        uint32_t length);
+
+/**
+ * Get the statistics for an intern table.
+ *
+ * @internal
+ *
+ * @param [table] The intern table.
+ * @return The statistics.
+ */
+struct neo4j_intern_stats neo4j_intern_table_stats(
+        neo4j_intern_table_t *table);
+
+#endif/*NEO4J_INTERN_H*/
@@ -18,6 +18,7 @@
 #define NEO4J_IOSTREAM_H
 
 #include "neo4j-client.h"
+#include <errno.h>
 
 typedef struct neo4j_iostream neo4j_iostream_t;
 
@@ -243,4 +244,22 @@ static inline int neo4j_ios_close(neo4j_iostream_t *ios)
     return ios->close(ios);
 }
 
+/**
+ * Get the file descriptor underlying the iostream.
+ *
+ * @internal
+ *
+ * @param [ios] The iostream.
+ * @return The file descriptor, or -1 on error (errno will be set).
+ */
+static inline int neo4j_ios_fileno(neo4j_iostream_t *ios)
+{
+    if (ios->fileno == NULL)
+    {
+        errno = ENOTSUP;
+        return -1;
+    }
+    return ios->fileno(ios);
+}
+
 #endif/*NEO4J_IOSTREAM_H*/
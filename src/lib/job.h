@@ -23,6 +23,7 @@ typedef struct neo4j_job neo4j_job_t;
 struct neo4j_job
 {
     void (*notify_session_ending)(neo4j_job_t *self);
+    void (*release_session)(neo4j_job_t *self);
     neo4j_job_t *next;
 };
 
@@ -39,4 +40,19 @@ static inline void neo4j_job_notify_session_ending(neo4j_job_t *job)
     job->notify_session_ending(job);
 }
 
+/**
+ * Require a job to stop using a session it has been lent.
+ *
+ * Returns once the job has stopped using the session, which may require
+ * waiting for another thread.
+ *
+ * @internal
+ *
+ * @param [job] The job holding the session.
+ */
+static inline void neo4j_job_release_session(neo4j_job_t *job)
+{
+    job->release_session(job);
+}
+
 #endif/*NEO4J_JOB_H*/
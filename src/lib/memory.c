@@ -72,6 +72,11 @@ void system_vfree(neo4j_memory_allocator_t *allocator, void **ptrs, size_t n)
 }
 
 
+static void drain(neo4j_mpool_t *pool, size_t depth, neo4j_mpool_t *spares,
+        size_t max_spare);
+static void release_ptrs(neo4j_mpool_t *pool, void **ptrs, size_t n,
+        neo4j_mpool_t *spares, size_t max_spare);
+static void release_spares(neo4j_mpool_t *pool);
 static int remove_debounce(neo4j_mpool_t *pool);
 static int resize_pool(neo4j_mpool_t *npool, neo4j_mpool_t *pool,
         unsigned int block_size);
@@ -93,6 +98,55 @@ neo4j_mpool_t neo4j_mpool(neo4j_memory_allocator_t *allocator,
 }
 
 
+neo4j_mpool_t neo4j_arena_mpool(neo4j_memory_allocator_t *allocator,
+        unsigned int block_size, size_t arena_size)
+{
+    neo4j_mpool_t pool = neo4j_mpool(allocator, block_size);
+    pool.arena_size = arena_size;
+    return pool;
+}
+
+
+void *neo4j_mpool_arena_alloc(neo4j_mpool_t *pool, size_t size)
+{
+    assert(pool->arena_size > 0);
+    assert(size <= pool->arena_size);
+
+    char *block;
+    if (pool->arena_spares != NULL)
+    {
+        block = pool->arena_spares;
+        pool->arena_spares = *((void **)block);
+        pool->arena_spare_size -= pool->arena_size;
+    }
+    else
+    {
+        block = neo4j_alloc(pool->allocator, pool, pool->arena_size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    // arena blocks are tagged in the pool, so they can be identified
+    // for recycling when drained
+    assert(((uintptr_t)block & 1) == 0);
+    if (neo4j_mpool_add(pool, (void *)((uintptr_t)block | 1)) < 0)
+    {
+        int errsv = errno;
+        neo4j_free(pool->allocator, block);
+        errno = errsv;
+        return NULL;
+    }
+
+    // any space remaining in the previous block is abandoned
+    pool->arena_pos = block + size;
+    pool->arena_end = block + pool->arena_size;
+    pool->arena_depth = pool->depth;
+    return block;
+}
+
+
 ssize_t neo4j_mpool_add(neo4j_mpool_t *pool, void *ptr)
 {
     assert(pool != NULL);
@@ -140,6 +194,80 @@ int remove_debounce(neo4j_mpool_t *pool)
 
 
 void neo4j_mpool_drainto(neo4j_mpool_t *pool, size_t depth)
+{
+    drain(pool, depth, NULL, 0);
+    if (depth == 0)
+    {
+        release_spares(pool);
+    }
+}
+
+
+void neo4j_mpool_drainto_mark(neo4j_mpool_t *pool, neo4j_mpool_mark_t mark)
+{
+    neo4j_mpool_drainto(pool, mark.depth);
+    if (mark.arena_pos != NULL)
+    {
+        // the block was added at or above the mark, so is still held
+        assert(mark.arena_depth <= pool->depth);
+        pool->arena_pos = mark.arena_pos;
+        pool->arena_end = mark.arena_end;
+        pool->arena_depth = mark.arena_depth;
+    }
+}
+
+
+void neo4j_mpool_recycle(neo4j_mpool_t *pool, neo4j_mpool_t *spares,
+        size_t max_spare)
+{
+    assert(pool != spares);
+    if (pool->arena_size == 0 || pool->arena_size != spares->arena_size ||
+            pool->allocator != spares->allocator)
+    {
+        neo4j_mpool_drain(pool);
+        return;
+    }
+    drain(pool, 0, spares, max_spare);
+    // retain the spares held by the drained pool too, if there's space
+    while (pool->arena_spares != NULL &&
+            spares->arena_spare_size + pool->arena_size <= max_spare)
+    {
+        void **block = pool->arena_spares;
+        pool->arena_spares = *block;
+        pool->arena_spare_size -= pool->arena_size;
+        *block = spares->arena_spares;
+        spares->arena_spares = block;
+        spares->arena_spare_size += spares->arena_size;
+    }
+    release_spares(pool);
+}
+
+
+void neo4j_mpool_take_spares(neo4j_mpool_t *pool, neo4j_mpool_t *from)
+{
+    if (from->arena_spares == NULL)
+    {
+        return;
+    }
+    if (pool->arena_size != from->arena_size ||
+            pool->allocator != from->allocator)
+    {
+        release_spares(from);
+        return;
+    }
+    void **last = from->arena_spares;
+    for (; *last != NULL; last = *last)
+        ;
+    *last = pool->arena_spares;
+    pool->arena_spares = from->arena_spares;
+    pool->arena_spare_size += from->arena_spare_size;
+    from->arena_spares = NULL;
+    from->arena_spare_size = 0;
+}
+
+
+void drain(neo4j_mpool_t *pool, size_t depth, neo4j_mpool_t *spares,
+        size_t max_spare)
 {
     if (pool->depth <= depth)
     {
@@ -154,7 +282,7 @@ void neo4j_mpool_drainto(neo4j_mpool_t *pool, size_t depth)
         unsigned int debounce_drain = min(pool->debounce_offset, todrain);
         void **ptrs =
             pool->debounce_ptrs + (pool->debounce_offset - debounce_drain);
-        neo4j_vfree(pool->allocator, ptrs, debounce_drain);
+        release_ptrs(pool, ptrs, debounce_drain, spares, max_spare);
         pool->debounce_offset -= debounce_drain;
         todrain -= debounce_drain;
     }
@@ -165,7 +293,7 @@ void neo4j_mpool_drainto(neo4j_mpool_t *pool, size_t depth)
         void **block = pool->ptrs;
         pool->ptrs = *block;
 
-        neo4j_vfree(pool->allocator, block+1, pool->offset-1);
+        release_ptrs(pool, block+1, pool->offset-1, spares, max_spare);
         neo4j_free(pool->allocator, block);
         todrain -= (pool->offset-1);
         pool->offset = pool->block_size;
@@ -176,9 +304,64 @@ void neo4j_mpool_drainto(neo4j_mpool_t *pool, size_t depth)
         // drain part of block
         assert(todrain < (pool->offset-1));
         pool->offset -= todrain;
-        neo4j_vfree(pool->allocator, pool->ptrs + pool->offset, todrain);
+        release_ptrs(pool, pool->ptrs + pool->offset, todrain,
+                spares, max_spare);
     }
     pool->depth = depth;
+
+    if (pool->arena_depth > depth)
+    {
+        // the current arena block has been deallocated
+        pool->arena_pos = NULL;
+        pool->arena_end = NULL;
+        pool->arena_depth = 0;
+    }
+}
+
+
+void release_ptrs(neo4j_mpool_t *pool, void **ptrs, size_t n,
+        neo4j_mpool_t *spares, size_t max_spare)
+{
+    if (pool->arena_size == 0)
+    {
+        neo4j_vfree(pool->allocator, ptrs, n);
+        return;
+    }
+
+    // untag arena blocks, moving them to spares if there's space
+    size_t nfree = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        uintptr_t ptr = (uintptr_t)ptrs[i];
+        if ((ptr & 1) == 0)
+        {
+            ptrs[nfree++] = ptrs[i];
+            continue;
+        }
+        void **block = (void **)(ptr & ~(uintptr_t)1);
+        if (spares != NULL &&
+                spares->arena_spare_size + pool->arena_size <= max_spare)
+        {
+            *block = spares->arena_spares;
+            spares->arena_spares = block;
+            spares->arena_spare_size += pool->arena_size;
+            continue;
+        }
+        ptrs[nfree++] = block;
+    }
+    neo4j_vfree(pool->allocator, ptrs, nfree);
+}
+
+
+void release_spares(neo4j_mpool_t *pool)
+{
+    while (pool->arena_spares != NULL)
+    {
+        void **block = pool->arena_spares;
+        pool->arena_spares = *block;
+        neo4j_free(pool->allocator, block);
+    }
+    pool->arena_spare_size = 0;
 }
 
 
@@ -197,6 +380,12 @@ ssize_t neo4j_mpool_merge(neo4j_mpool_t *pool1, neo4j_mpool_t *pool2)
         return -1;
     }
 
+    // any arena block in pool2 is merged as part of its memory, but the
+    // space remaining in it is abandoned
+    pool2->arena_pos = NULL;
+    pool2->arena_end = NULL;
+    pool2->arena_depth = 0;
+
     neo4j_mpool_t tpool;
     if (pool1->block_size != pool2->block_size ||
             pool1->allocator != pool2->allocator)
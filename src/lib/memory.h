@@ -19,6 +19,7 @@
 
 #include "neo4j-client.h"
 #include <errno.h>
+#include <string.h>
 
 
 typedef struct neo4j_memory_allocator neo4j_memory_allocator_t;
@@ -104,6 +105,7 @@ static inline void neo4j_vfree(neo4j_memory_allocator_t *allocator, void **ptrs,
 
 
 #define NEO4J_MPOOL_DEBOUNCE 8
+#define NEO4J_MPOOL_ALIGNMENT (2 * sizeof(void *))
 
 typedef struct neo4j_mpool
 {
@@ -114,6 +116,16 @@ typedef struct neo4j_mpool
     void **ptrs;
     unsigned int offset;
     size_t depth;
+    // in arena mode, small allocations are carved from the unused space
+    // in the most recently added arena block (which is added to the pool at
+    // arena_depth)
+    size_t arena_size;
+    char *arena_pos;
+    char *arena_end;
+    size_t arena_depth;
+    // drained arena blocks, held for reuse
+    void *arena_spares;
+    size_t arena_spare_size;
 } neo4j_mpool_t;
 
 
@@ -130,6 +142,27 @@ typedef struct neo4j_mpool
 neo4j_mpool_t neo4j_mpool(neo4j_memory_allocator_t *allocator,
         unsigned int block_size);
 
+/**
+ * Initialize a new memory pool in arena mode.
+ *
+ * Allocations from an arena mode pool, of up to a quarter of the arena size,
+ * are made from within larger arena blocks that are added to the pool,
+ * rather than each being allocated and added individually. Memory allocated
+ * from an arena block is deallocated when the pool is drained below the
+ * depth at which the block was added.
+ *
+ * @internal
+ *
+ * @param [allocator] The allocator to use with the pool.
+ * @param [block_size] The number of memory pointers to hold in each block.
+ *         The pool will allocate a new block when the previous has been filled.
+ * @param [arena_size] The size, in bytes, of each arena block, or 0 to
+ *         disable arena mode.
+ * @return A memory pool.
+ */
+neo4j_mpool_t neo4j_arena_mpool(neo4j_memory_allocator_t *allocator,
+        unsigned int block_size, size_t arena_size);
+
 /**
  * Add memory to a memory pool.
  *
@@ -158,10 +191,88 @@ ssize_t neo4j_mpool_add(neo4j_mpool_t *pool, void *ptr);
  */
 void neo4j_mpool_drainto(neo4j_mpool_t *pool, size_t depth);
 
+/**
+ * A position in a memory pool, including the position within its current
+ * arena block.
+ */
+typedef struct neo4j_mpool_mark
+{
+    size_t depth;
+    char *arena_pos;
+    char *arena_end;
+    size_t arena_depth;
+} neo4j_mpool_mark_t;
+
+/**
+ * @fn neo4j_mpool_mark_t neo4j_mpool_mark(const neo4j_mpool_t pool)
+ * @brief Mark the current position of a memory pool.
+ *
+ * @internal
+ *
+ * @param [pool] The pool to mark.
+ * @return The mark, for use with neo4j_mpool_drainto_mark().
+ */
+#define neo4j_mpool_mark(pool) (_neo4j_mpool_mark(&(pool)))
+static inline neo4j_mpool_mark_t _neo4j_mpool_mark(const neo4j_mpool_t *pool)
+{
+    neo4j_mpool_mark_t mark =
+        { .depth = pool->depth, .arena_pos = pool->arena_pos,
+          .arena_end = pool->arena_end, .arena_depth = pool->arena_depth };
+    return mark;
+}
+
+/**
+ * Drain a memory pool to a marked position.
+ *
+ * The pool is drained to the depth of the mark, and any space allocated from
+ * the arena block that was current when the mark was taken is made available
+ * again. The pool must not have been drained below the mark since it was
+ * taken.
+ *
+ * @internal
+ *
+ * @param [pool] A pointer to the pool to drain.
+ * @param [mark] The mark to drain to.
+ */
+void neo4j_mpool_drainto_mark(neo4j_mpool_t *pool, neo4j_mpool_mark_t mark);
+
+/**
+ * Completely drain a memory pool, retaining arena blocks for reuse.
+ *
+ * The memory added to the pool is deallocated, except for arena blocks, which
+ * are held by the `spares` pool for reuse by subsequent allocations from it
+ * (until the size of all blocks held reaches `max_spare`). Any arena blocks
+ * that are not retained are deallocated.
+ *
+ * Blocks are only retained if both pools are in arena mode with the same
+ * arena size and allocator.
+ *
+ * @internal
+ *
+ * @param [pool] A pointer to the pool to drain.
+ * @param [spares] A pointer to the pool that will hold the arena blocks.
+ * @param [max_spare] The maximum size of all blocks held by `spares`.
+ */
+void neo4j_mpool_recycle(neo4j_mpool_t *pool, neo4j_mpool_t *spares,
+        size_t max_spare);
+
+/**
+ * Move the spare arena blocks held by one memory pool to another.
+ *
+ * If the pools are not compatible, the spare blocks are instead deallocated.
+ *
+ * @internal
+ *
+ * @param [pool] A pointer to the pool to receive the spare blocks.
+ * @param [from] A pointer to the pool holding the spare blocks.
+ */
+void neo4j_mpool_take_spares(neo4j_mpool_t *pool, neo4j_mpool_t *from);
+
 /**
  * Completely drain a memory pool.
  *
- * This deallocates all memory added to the pool.
+ * This deallocates all memory added to the pool, and any spare arena blocks
+ * it holds.
  *
  * @internal
  *
@@ -187,6 +298,45 @@ static inline size_t _neo4j_mpool_depth(const neo4j_mpool_t *pool)
     return pool->depth;
 }
 
+/**
+ * Allocate memory from a new arena block.
+ *
+ * @internal
+ *
+ * @param [pool] The pool to allocate memory using.
+ * @param [size] The number of bytes to allocate, which must be a multiple
+ *         of `NEO4J_MPOOL_ALIGNMENT`.
+ * @return A pointer the newly allocated memory, or `NULL` if an error occurs
+ *         (errno will be set).
+ */
+__neo4j_malloc
+void *neo4j_mpool_arena_alloc(neo4j_mpool_t *pool, size_t size);
+
+/**
+ * Allocate memory from the current arena block of a memory pool.
+ *
+ * @internal
+ *
+ * @param [pool] The pool to allocate memory using.
+ * @param [size] The number of bytes to allocate.
+ * @return A pointer the newly allocated memory, or `NULL` if an error occurs
+ *         (errno will be set).
+ */
+__neo4j_malloc
+static inline void *_neo4j_mpool_arena_alloc(neo4j_mpool_t *pool, size_t size)
+{
+    size = (size > 0)?
+        (size + NEO4J_MPOOL_ALIGNMENT - 1) & ~(NEO4J_MPOOL_ALIGNMENT - 1) :
+        NEO4J_MPOOL_ALIGNMENT;
+    if ((size_t)(pool->arena_end - pool->arena_pos) < size)
+    {
+        return neo4j_mpool_arena_alloc(pool, size);
+    }
+    void *ptr = pool->arena_pos;
+    pool->arena_pos += size;
+    return ptr;
+}
+
 /**
  * Allocate memory and add it to a memory pool.
  *
@@ -201,6 +351,10 @@ static inline size_t _neo4j_mpool_depth(const neo4j_mpool_t *pool)
 __neo4j_malloc
 static inline void *neo4j_mpool_alloc(neo4j_mpool_t *pool, size_t size)
 {
+    if (pool->arena_size > 0 && size <= (pool->arena_size >> 2))
+    {
+        return _neo4j_mpool_arena_alloc(pool, size);
+    }
     void *ptr = neo4j_alloc(pool->allocator, pool, size);
     if (neo4j_mpool_add(pool, ptr) < 0)
     {
@@ -230,6 +384,16 @@ __neo4j_malloc
 static inline void *neo4j_mpool_calloc(neo4j_mpool_t *pool,
         size_t count, size_t size)
 {
+    if (pool->arena_size > 0 && size > 0 &&
+            count <= (pool->arena_size >> 2) / size)
+    {
+        void *ptr = _neo4j_mpool_arena_alloc(pool, count * size);
+        if (ptr != NULL)
+        {
+            memset(ptr, 0, count * size);
+        }
+        return ptr;
+    }
     void *ptr = neo4j_calloc(pool->allocator, pool, count, size);
     if (neo4j_mpool_add(pool, ptr) < 0)
     {
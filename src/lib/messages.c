@@ -36,6 +36,14 @@ DECLARE_MESSAGE_TYPE(RECORD, 0X71);
 DECLARE_MESSAGE_TYPE(SUCCESS, 0X70);
 DECLARE_MESSAGE_TYPE(FAILURE, 0X7F);
 DECLARE_MESSAGE_TYPE(IGNORED, 0X7E);
+DECLARE_MESSAGE_TYPE(HELLO, 0x01);
+DECLARE_MESSAGE_TYPE(LOGON, 0x6A);
+DECLARE_MESSAGE_TYPE(GOODBYE, 0x02);
+DECLARE_MESSAGE_TYPE(PULL, 0x3F);
+DECLARE_MESSAGE_TYPE(DISCARD, 0x2F);
+DECLARE_MESSAGE_TYPE(BEGIN, 0x11);
+DECLARE_MESSAGE_TYPE(COMMIT, 0x12);
+DECLARE_MESSAGE_TYPE(ROLLBACK, 0x13);
 
 static const neo4j_message_type_t neo4j_message_types[] =
     { &INIT_MESSAGE,
@@ -47,7 +55,14 @@ static const neo4j_message_type_t neo4j_message_types[] =
       &RECORD_MESSAGE,
       &SUCCESS_MESSAGE,
       &FAILURE_MESSAGE,
-      &IGNORED_MESSAGE };
+      &IGNORED_MESSAGE,
+      // later versions (HELLO, PULL and DISCARD share their signatures
+      // with INIT, PULL_ALL and DISCARD_ALL)
+      &LOGON_MESSAGE,
+      &GOODBYE_MESSAGE,
+      &BEGIN_MESSAGE,
+      &COMMIT_MESSAGE,
+      &ROLLBACK_MESSAGE };
 static const int _max_message_type =
     (sizeof(neo4j_message_types) / sizeof(neo4j_message_type_t));
 
@@ -61,6 +76,74 @@ const neo4j_message_type_t NEO4J_RECORD_MESSAGE = &RECORD_MESSAGE;
 const neo4j_message_type_t NEO4J_SUCCESS_MESSAGE = &SUCCESS_MESSAGE;
 const neo4j_message_type_t NEO4J_FAILURE_MESSAGE = &FAILURE_MESSAGE;
 const neo4j_message_type_t NEO4J_IGNORED_MESSAGE = &IGNORED_MESSAGE;
+const neo4j_message_type_t NEO4J_HELLO_MESSAGE = &HELLO_MESSAGE;
+const neo4j_message_type_t NEO4J_LOGON_MESSAGE = &LOGON_MESSAGE;
+const neo4j_message_type_t NEO4J_GOODBYE_MESSAGE = &GOODBYE_MESSAGE;
+const neo4j_message_type_t NEO4J_PULL_MESSAGE = &PULL_MESSAGE;
+const neo4j_message_type_t NEO4J_DISCARD_MESSAGE = &DISCARD_MESSAGE;
+const neo4j_message_type_t NEO4J_BEGIN_MESSAGE = &BEGIN_MESSAGE;
+const neo4j_message_type_t NEO4J_COMMIT_MESSAGE = &COMMIT_MESSAGE;
+const neo4j_message_type_t NEO4J_ROLLBACK_MESSAGE = &ROLLBACK_MESSAGE;
+
+
+static const struct neo4j_message_table message_tables[] =
+    { { .version = 1, .minor_version = 0,
+        .init = &INIT_MESSAGE,
+        .run = &RUN_MESSAGE,
+        .pull_all = &PULL_ALL_MESSAGE,
+        .discard_all = &DISCARD_ALL_MESSAGE,
+        .ack_failure = &ACK_FAILURE_MESSAGE,
+        .reset = &RESET_MESSAGE },
+      { .version = 3, .minor_version = 0,
+        .init = &HELLO_MESSAGE,
+        .goodbye = &GOODBYE_MESSAGE,
+        .run = &RUN_MESSAGE,
+        .pull_all = &PULL_ALL_MESSAGE,
+        .discard_all = &DISCARD_ALL_MESSAGE,
+        .ack_failure = &RESET_MESSAGE,
+        .reset = &RESET_MESSAGE,
+        .begin = &BEGIN_MESSAGE,
+        .commit = &COMMIT_MESSAGE,
+        .rollback = &ROLLBACK_MESSAGE },
+      { .version = 4, .minor_version = 0,
+        .init = &HELLO_MESSAGE,
+        .goodbye = &GOODBYE_MESSAGE,
+        .run = &RUN_MESSAGE,
+        .pull_all = &PULL_MESSAGE,
+        .discard_all = &DISCARD_MESSAGE,
+        .ack_failure = &RESET_MESSAGE,
+        .reset = &RESET_MESSAGE,
+        .begin = &BEGIN_MESSAGE,
+        .commit = &COMMIT_MESSAGE,
+        .rollback = &ROLLBACK_MESSAGE },
+      { .version = 5, .minor_version = 0,
+        .init = &HELLO_MESSAGE,
+        .goodbye = &GOODBYE_MESSAGE,
+        .run = &RUN_MESSAGE,
+        .pull_all = &PULL_MESSAGE,
+        .discard_all = &DISCARD_MESSAGE,
+        .ack_failure = &RESET_MESSAGE,
+        .reset = &RESET_MESSAGE,
+        .begin = &BEGIN_MESSAGE,
+        .commit = &COMMIT_MESSAGE,
+        .rollback = &ROLLBACK_MESSAGE },
+      { .version = 5, .minor_version = 1,
+        .init = &HELLO_MESSAGE,
+        .logon = &LOGON_MESSAGE,
+        .goodbye = &GOODBYE_MESSAGE,
+        .run = &RUN_MESSAGE,
+        .pull_all = &PULL_MESSAGE,
+        .discard_all = &DISCARD_MESSAGE,
+        .ack_failure = &RESET_MESSAGE,
+        .reset = &RESET_MESSAGE,
+        .begin = &BEGIN_MESSAGE,
+        .commit = &COMMIT_MESSAGE,
+        .rollback = &ROLLBACK_MESSAGE } };
+static const int _nmessage_tables =
+    (sizeof(message_tables) / sizeof(struct neo4j_message_table));
+
+// the highest minor version supported for each major version
+static const uint32_t max_minor_versions[] = { 0, 0, 0, 0, 4, 4 };
 
 
 neo4j_message_type_t neo4j_message_type_for_signature(uint8_t signature)
@@ -76,6 +159,29 @@ neo4j_message_type_t neo4j_message_type_for_signature(uint8_t signature)
 }
 
 
+const struct neo4j_message_table *neo4j_message_table(uint32_t version,
+        uint32_t minor_version)
+{
+    if (version >= (sizeof(max_minor_versions) / sizeof(uint32_t)) ||
+            minor_version > max_minor_versions[version])
+    {
+        return NULL;
+    }
+
+    // use the table for the highest version not exceeding that requested
+    const struct neo4j_message_table *table = NULL;
+    for (int i = 0; i < _nmessage_tables; ++i)
+    {
+        if (message_tables[i].version == version &&
+                message_tables[i].minor_version <= minor_version)
+        {
+            table = &(message_tables[i]);
+        }
+    }
+    return table;
+}
+
+
 int neo4j_message_send(neo4j_iostream_t *ios, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc, uint8_t *buffer,
         uint16_t bsize, uint16_t max_chunk)
@@ -105,49 +211,183 @@ int neo4j_message_recv(neo4j_iostream_t *ios,
     REQUIRE(ios != NULL, -1);
     REQUIRE(mpool != NULL, -1);
     REQUIRE(type != NULL, -1);
-    size_t pdepth = neo4j_mpool_depth(*mpool);
 
-    struct neo4j_chunking_iostream chunking_ios;
-    neo4j_iostream_t *cios = neo4j_chunking_iostream_init(&chunking_ios,
-            ios, NULL, 0, UINT16_MAX);
+    uint8_t *buffer = NULL;
+    size_t bsize = 0;
+    ssize_t length = neo4j_message_recv_frame(ios, &buffer, &bsize);
+    if (length < 0)
+    {
+        return -1;
+    }
 
-    neo4j_value_t message;
-    if (neo4j_deserialize(cios, mpool, &message))
+    int result = neo4j_message_decode(buffer, length, false, mpool,
+            type, argv, argc);
+    int errsv = errno;
+    free(buffer);
+    errno = errsv;
+    return result;
+}
+
+
+ssize_t neo4j_message_recv_frame(neo4j_iostream_t *ios, uint8_t **buffer,
+        size_t *bsize)
+{
+    REQUIRE(ios != NULL, -1);
+    REQUIRE(buffer != NULL, -1);
+    REQUIRE(bsize != NULL, -1);
+
+    uint16_t length;
+    do
     {
-        goto failure;
+        // skip any empty chunks preceding the message
+        if (neo4j_ios_read_all(ios, &length, sizeof(length), NULL) < 0)
+        {
+            return -1;
+        }
+    } while (length == 0);
+
+    size_t used = 0;
+    while (length != 0)
+    {
+        size_t chunk = ntohs(length);
+        if (*bsize - used < chunk)
+        {
+            size_t nsize = (*bsize > 0)? *bsize : NEO4J_MESSAGE_BUFFER_SIZE;
+            while (nsize - used < chunk)
+            {
+                nsize *= 2;
+            }
+            uint8_t *nbuffer = realloc(*buffer, nsize);
+            if (nbuffer == NULL)
+            {
+                return -1;
+            }
+            *buffer = nbuffer;
+            *bsize = nsize;
+        }
+
+        // read the chunk body and the length of the next chunk together
+        struct iovec iov[2];
+        iov[0].iov_base = *buffer + used;
+        iov[0].iov_len = chunk;
+        iov[1].iov_base = &length;
+        iov[1].iov_len = sizeof(length);
+        if (neo4j_ios_readv_all(ios, iov, 2, NULL) < 0)
+        {
+            return -1;
+        }
+        used += chunk;
     }
 
-    if (neo4j_type(message) != NEO4J_STRUCT)
+    if (used > SSIZE_MAX)
     {
-        errno = EPROTO;
-        goto failure;
+        errno = EMSGSIZE;
+        return -1;
     }
+    return (ssize_t)used;
+}
+
+
+ssize_t neo4j_message_decode_header(const uint8_t *frame, size_t length,
+        neo4j_message_type_t *type, uint16_t *argc)
+{
+    REQUIRE(frame != NULL, -1);
+    REQUIRE(type != NULL, -1);
+    REQUIRE(argc != NULL, -1);
 
-    neo4j_message_type_t message_type =
-        neo4j_message_type_for_signature(neo4j_struct_signature(message));
-    if (message_type == NULL)
+    const uint8_t *end = frame + length;
+    const uint8_t *pos = frame;
+    if (pos >= end)
     {
-        errno = EPROTO;
-        goto failure;
+        goto invalid;
+    }
+
+    uint8_t marker = *(pos++);
+    if ((marker & 0xF0) == 0xB0)
+    {
+        *argc = marker & 0x0F;
+    }
+    else if (marker == 0xDC && (end - pos) >= 1)
+    {
+        *argc = *(pos++);
+    }
+    else if (marker == 0xDD && (end - pos) >= 2)
+    {
+        *argc = ((uint16_t)pos[0] << 8) | pos[1];
+        pos += 2;
+    }
+    else
+    {
+        goto invalid;
+    }
+
+    if (pos >= end)
+    {
+        goto invalid;
+    }
+    *type = neo4j_message_type_for_signature(*(pos++));
+    if (*type == NULL)
+    {
+        goto invalid;
+    }
+    return pos - frame;
+
+invalid:
+    errno = EPROTO;
+    return -1;
+}
+
+
+int neo4j_message_decode(const uint8_t *frame, size_t length, bool borrow,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc)
+{
+    REQUIRE(frame != NULL, -1);
+    REQUIRE(mpool != NULL, -1);
+    REQUIRE(type != NULL, -1);
+    neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*mpool);
+
+    uint16_t nargs;
+    ssize_t hlength = neo4j_message_decode_header(frame, length, type, &nargs);
+    if (hlength < 0)
+    {
+        return -1;
+    }
+
+    neo4j_value_t *args = NULL;
+    if (nargs > 0)
+    {
+        args = neo4j_mpool_calloc(mpool, nargs, sizeof(neo4j_value_t));
+        if (args == NULL)
+        {
+            goto failure;
+        }
+    }
+
+    const uint8_t *pos = frame + hlength;
+    for (unsigned int i = 0; i < nargs; ++i)
+    {
+        if (neo4j_deserialize_buffer(&pos, frame + length, borrow,
+                    mpool, &(args[i])))
+        {
+            goto failure;
+        }
     }
 
-    *type = message_type;
     if (argv != NULL)
     {
-        *argv = neo4j_struct_fields(message);
+        *argv = args;
     }
     if (argc != NULL)
     {
-        *argc = neo4j_struct_size(message);
+        *argc = nargs;
     }
-
-    neo4j_ios_close(cios);
     return 0;
 
     int errsv;
 failure:
     errsv = errno;
-    neo4j_mpool_drainto(mpool, pdepth);
+    neo4j_mpool_drainto_mark(mpool, pmark);
     errno = errsv;
     return -1;
 }
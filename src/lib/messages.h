@@ -22,6 +22,8 @@
 #include "memory.h"
 #include <stdint.h>
 
+#define NEO4J_MESSAGE_BUFFER_SIZE 1024
+
 typedef const struct neo4j_message_type *neo4j_message_type_t;
 struct neo4j_message_type
 {
@@ -39,9 +41,55 @@ extern const neo4j_message_type_t NEO4J_RECORD_MESSAGE;
 extern const neo4j_message_type_t NEO4J_SUCCESS_MESSAGE;
 extern const neo4j_message_type_t NEO4J_FAILURE_MESSAGE;
 extern const neo4j_message_type_t NEO4J_IGNORED_MESSAGE;
+extern const neo4j_message_type_t NEO4J_HELLO_MESSAGE;
+extern const neo4j_message_type_t NEO4J_LOGON_MESSAGE;
+extern const neo4j_message_type_t NEO4J_GOODBYE_MESSAGE;
+extern const neo4j_message_type_t NEO4J_PULL_MESSAGE;
+extern const neo4j_message_type_t NEO4J_DISCARD_MESSAGE;
+extern const neo4j_message_type_t NEO4J_BEGIN_MESSAGE;
+extern const neo4j_message_type_t NEO4J_COMMIT_MESSAGE;
+extern const neo4j_message_type_t NEO4J_ROLLBACK_MESSAGE;
 
 neo4j_message_type_t neo4j_message_type_for_signature(uint8_t signature);
 
+/*
+ * The messages used for each request, for a negotiated protocol version.
+ * Requests that are not supported by a version are `NULL`.
+ */
+struct neo4j_message_table
+{
+    uint32_t version;
+    uint32_t minor_version;
+    // INIT or HELLO
+    neo4j_message_type_t init;
+    // LOGON, when authentication is separate from HELLO
+    neo4j_message_type_t logon;
+    neo4j_message_type_t goodbye;
+    neo4j_message_type_t run;
+    // PULL_ALL, or PULL { n }
+    neo4j_message_type_t pull_all;
+    // DISCARD_ALL, or DISCARD { n }
+    neo4j_message_type_t discard_all;
+    // ACK_FAILURE, or RESET when failures are acknowledged by a reset
+    neo4j_message_type_t ack_failure;
+    neo4j_message_type_t reset;
+    neo4j_message_type_t begin;
+    neo4j_message_type_t commit;
+    neo4j_message_type_t rollback;
+};
+
+/**
+ * Get the message table for a protocol version.
+ *
+ * @internal
+ *
+ * @param [version] The major protocol version.
+ * @param [minor_version] The minor protocol version.
+ * @return The message table, or `NULL` if the version is not supported.
+ */
+const struct neo4j_message_table *neo4j_message_table(uint32_t version,
+        uint32_t minor_version);
+
 static inline const char *neo4j_message_type_str(neo4j_message_type_t type)
 {
     return type->name;
@@ -91,4 +139,71 @@ int neo4j_message_recv(neo4j_iostream_t *ios,
         neo4j_mpool_t *mpool, neo4j_message_type_t *type,
         const neo4j_value_t **argv, uint16_t *argc);
 
+/**
+ * Receive a complete message frame on an iostream, without decoding it.
+ *
+ * All chunks of the message are collected, in order, into a single
+ * contiguous buffer. If the buffer is too small to hold the message, it
+ * will be reallocated (and `*buffer` and `*bsize` updated accordingly).
+ * The same buffer can thus be reused for receiving subsequent messages.
+ *
+ * This call may block until data is available from the network.
+ *
+ * @internal
+ *
+ * @param [ios] The iostream to receive from.
+ * @param [buffer] A pointer to a buffer allocated with `malloc` (or `NULL`),
+ *         which will be updated if the buffer is reallocated.
+ * @param [bsize] A pointer to the size of `*buffer`, which will be updated
+ *         if the buffer is reallocated.
+ * @return The length of the message frame on success, or -1 on failure
+ *         (errno will be set).
+ */
+__neo4j_must_check
+ssize_t neo4j_message_recv_frame(neo4j_iostream_t *ios, uint8_t **buffer,
+        size_t *bsize);
+
+/**
+ * Decode the header of a message frame.
+ *
+ * The message arguments follow the header within the frame, and can be
+ * decoded individually using `neo4j_deserialize_buffer(...)`.
+ *
+ * @internal
+ *
+ * @param [frame] The message frame.
+ * @param [length] The length of the message frame.
+ * @param [type] A pointer to a message type, which will be updated.
+ * @param [argc] A pointer to a `uin16_t`, which will be updated with the
+ *         number of arguments in the message.
+ * @return The length of the message header on success, or -1 on failure
+ *         (errno will be set).
+ */
+__neo4j_must_check
+ssize_t neo4j_message_decode_header(const uint8_t *frame, size_t length,
+        neo4j_message_type_t *type, uint16_t *argc);
+
+/**
+ * Decode a message from a complete message frame.
+ *
+ * @internal
+ *
+ * @param [frame] The message frame.
+ * @param [length] The length of the message frame.
+ * @param [borrow] `true` if string values should reference their content
+ *         directly within the frame, which must then remain valid for as
+ *         long as the message arguments are in use.
+ * @param [mpool] A memory pool to allocate values and buffer spaces in.
+ * @param [type] A pointer to a message type, which will be updated.
+ * @param [argv] A pointer to an argument vector, which will be updated
+ *         to point to the received message arguments.
+ * @param [argc] A pointer to a `uin16_t`, which will be updated with the
+ *         length of the received argument vector.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_message_decode(const uint8_t *frame, size_t length, bool borrow,
+        neo4j_mpool_t *mpool, neo4j_message_type_t *type,
+        const neo4j_value_t **argv, uint16_t *argc);
+
 #endif/*NEO4J_MESSAGES_H*/
@@ -92,7 +92,7 @@ int neo4j_meta_failure_details(struct neo4j_failure_details *details,
         const neo4j_value_t map, neo4j_mpool_t *mpool, const char *description,
         neo4j_logger_t *logger)
 {
-    size_t pdepth = neo4j_mpool_depth(*mpool);
+    neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*mpool);
 
     const char *code_string = extract_string(map, NULL, "code", mpool,
             description, logger);
@@ -124,7 +124,7 @@ int neo4j_meta_failure_details(struct neo4j_failure_details *details,
     int errsv;
 failure:
     errsv = errno;
-    neo4j_mpool_drainto(mpool, pdepth);
+    neo4j_mpool_drainto_mark(mpool, pmark);
     errno = errsv;
     return -1;
 }
@@ -216,6 +216,22 @@ int neo4j_meta_fieldnames(const char * const **names, unsigned int *nnames,
 }
 
 
+int neo4j_meta_has_more(neo4j_value_t map, const char *description,
+        neo4j_logger_t *logger)
+{
+    assert(neo4j_type(map) == NEO4J_MAP);
+    assert(description != NULL);
+
+    neo4j_value_t has_more;
+    if (map_get_typed(&has_more, map, NULL, "has_more", NEO4J_BOOL,
+            true, description, logger))
+    {
+        return -1;
+    }
+    return (!neo4j_is_null(has_more) && neo4j_bool_value(has_more))? 1 : 0;
+}
+
+
 int neo4j_meta_statement_type(neo4j_value_t map, const char *description,
         neo4j_logger_t *logger)
 {
@@ -475,7 +491,7 @@ struct neo4j_statement_execution_step *meta_execution_steps(
         neo4j_value_t map, const char *description, const char *path,
         neo4j_mpool_t *mpool, neo4j_logger_t *logger)
 {
-    size_t pdepth = neo4j_mpool_depth(*mpool);
+    neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*mpool);
 
     struct neo4j_statement_execution_step *step = neo4j_mpool_calloc(mpool, 1,
             sizeof(struct neo4j_statement_execution_step));
@@ -573,7 +589,7 @@ struct neo4j_statement_execution_step *meta_execution_steps(
     int errsv;
 failure:
     errsv = errno;
-    neo4j_mpool_drainto(mpool, pdepth);
+    neo4j_mpool_drainto_mark(mpool, pmark);
     errno = errsv;
     return NULL;
 }
@@ -689,7 +705,7 @@ int extract_string_list(const char * const **strings, unsigned int *nstrings,
         return 0;
     }
 
-    size_t pdepth = neo4j_mpool_depth(*mpool);
+    neo4j_mpool_mark_t pmark = neo4j_mpool_mark(*mpool);
     char **cstrings = neo4j_mpool_calloc(mpool, n, sizeof(const char *));
     if (cstrings == NULL)
     {
@@ -724,7 +740,7 @@ int extract_string_list(const char * const **strings, unsigned int *nstrings,
     int errsv;
 failure:
     errsv = errno;
-    neo4j_mpool_drainto(mpool, pdepth);
+    neo4j_mpool_drainto_mark(mpool, pmark);
     errno = errsv;
     return -1;
 }
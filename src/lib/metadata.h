@@ -101,6 +101,24 @@ int neo4j_meta_fieldnames(const char * const **names, unsigned int *nnames,
         neo4j_value_t map, neo4j_mpool_t *mpool, const char *description,
         neo4j_logger_t *logger);
 
+/**
+ * Check whether a metadata map indicates that more records are available.
+ *
+ * Checks for a "has_more" entry, of type Boolean, as sent in response to
+ * PULL {n} when further records remain to be pulled.
+ *
+ * @internal
+ *
+ * @param [map] The metadata map.
+ * @param [description] A description of the message from which the metadata
+ *         came, for use when logging errors.
+ * @param [logger] A logger to emit error messages to.
+ * @return 1 if more records are available, 0 if not, or -1 if an error
+ *         occurs (errno will be set).
+ */
+int neo4j_meta_has_more(neo4j_value_t map, const char *description,
+        neo4j_logger_t *logger);
+
 /**
  * Extract statement type from a metadata map.
  *
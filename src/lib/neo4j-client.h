@@ -65,11 +65,21 @@ typedef struct neo4j_config neo4j_config_t;
  */
 typedef struct neo4j_connection neo4j_connection_t;
 
+/**
+ * A pool of connections to a neo4j server.
+ */
+typedef struct neo4j_pool neo4j_pool_t;
+
 /**
  * A session within a connection.
  */
 typedef struct neo4j_session neo4j_session_t;
 
+/**
+ * A reactor driving many non-blocking sessions from a single thread.
+ */
+typedef struct neo4j_reactor neo4j_reactor_t;
+
 /**
  * A stream of results from a job.
  */
@@ -276,6 +286,10 @@ const char *neo4j_log_level_str(uint_fast8_t level);
 
 /**
  * An I/O stream for neo4j client.
+ *
+ * Streams provided by a custom connection factory must set every member,
+ * including `fileno`, which may be set to `NULL` when the stream is not
+ * backed by a file descriptor.
  */
 struct neo4j_iostream
 {
@@ -341,6 +355,20 @@ struct neo4j_iostream
      * @return 0 on success, or -1 on error (errno will be set).
      */
     int (*close)(struct neo4j_iostream *self);
+
+    /**
+     * Get the file descriptor the stream reads from and writes to.
+     *
+     * This is required for non-blocking use of a session (see
+     * neo4j_session_set_nonblocking()), and is used to check that idle
+     * connections in a pool have not been closed by the server (see
+     * neo4j_pool_checkout()). It must be set to `NULL`, or return -1 with
+     * errno set to `ENOTSUP`, for streams not backed by a file descriptor.
+     *
+     * @param [self] This stream.
+     * @return The file descriptor, or -1 on error (errno will be set).
+     */
+    int (*fileno)(struct neo4j_iostream *self);
 };
 
 /**
@@ -401,6 +429,9 @@ struct neo4j_connection_factory
 #define NEO4J_NO_PLAN_AVAILABLE -35
 #define NEO4J_AUTH_RATE_LIMIT -36
 #define NEO4J_TLS_MALFORMED_CERTIFICATE -37
+#define NEO4J_TRANSACTION_ACTIVE -38
+#define NEO4J_NO_TRANSACTION -39
+#define NEO4J_TRANSACTION_FAILED -40
 
 /**
  * Print the error message corresponding to an error number.
@@ -549,6 +580,19 @@ struct neo4j_map_entry
 };
 
 
+/**
+ * A key for looking up values in neo4j maps, with a precomputed hash.
+ */
+typedef struct neo4j_key neo4j_key_t;
+struct neo4j_key
+{
+    const char *_ustring;
+    uint32_t _length;
+    uint32_t _hash;
+    unsigned int _hint;
+};
+
+
 /**
  * @fn neo4j_type_t neo4j_type(neo4j_value_t value)
  * @brief Get the type of a neo4j value.
@@ -747,12 +791,31 @@ unsigned int neo4j_string_length(neo4j_value_t value);
  *
  * Note that the result is undefined if the value is not of type NEO4J_STRING.
  *
+ * @attention Strings received with inline strings enabled (see
+ * neo4j_config_set_inline_strings()) may hold their content within the
+ * value itself, and `NULL` is then returned (errno will be set to `EINVAL`).
+ * Use neo4j_ustring_pointer() to access these strings.
+ *
  * @param [value] The neo4j string.
  * @return A pointer to a UTF-8 string, which will not be terminated.
  */
 __neo4j_pure
 const char *neo4j_ustring_value(neo4j_value_t value);
 
+/**
+ * Return a pointer to the UTF-8 string in a neo4j value.
+ *
+ * As for neo4j_ustring_value(), but also for strings holding their content
+ * inline, in which case the pointer is into the referenced value and
+ * remains valid only for as long as that value does.
+ *
+ * @param [value] A pointer to the neo4j string.
+ * @return A pointer to a UTF-8 string, which will not be terminated, or
+ *         `NULL` if the value is not a string (errno will be set).
+ */
+__neo4j_pure
+const char *neo4j_ustring_pointer(const neo4j_value_t *value);
+
 /**
  * Copy a neo4j string to a `NULL` terminated buffer.
  *
@@ -811,6 +874,68 @@ unsigned int neo4j_list_length(neo4j_value_t value);
 __neo4j_pure
 neo4j_value_t neo4j_list_get(neo4j_value_t value, unsigned int index);
 
+/**
+ * Construct a neo4j value encoding a list of integers.
+ *
+ * The list holds the integers packed in the array, rather than as an array
+ * of neo4j values. Its elements are returned by neo4j_list_get() as values
+ * of type NEO4J_INT.
+ *
+ * @param [values] An array of integers. The pointer to the values must
+ *         remain valid, and the content unchanged, for the lifetime of the
+ *         neo4j value.
+ * @param [n] The length of the array of integers. This must be less than
+ *         UINT32_MAX (or the list will be truncated).
+ * @return A neo4j value encoding the List.
+ */
+__neo4j_pure
+neo4j_value_t neo4j_int_list(const int64_t *values, unsigned int n);
+
+/**
+ * Construct a neo4j value encoding a list of floats.
+ *
+ * The list holds the floats packed in the array, rather than as an array
+ * of neo4j values. Its elements are returned by neo4j_list_get() as values
+ * of type NEO4J_FLOAT.
+ *
+ * @param [values] An array of doubles. The pointer to the values must
+ *         remain valid, and the content unchanged, for the lifetime of the
+ *         neo4j value.
+ * @param [n] The length of the array of doubles. This must be less than
+ *         UINT32_MAX (or the list will be truncated).
+ * @return A neo4j value encoding the List.
+ */
+__neo4j_pure
+neo4j_value_t neo4j_float_list(const double *values, unsigned int n);
+
+/**
+ * Return the packed integers of a neo4j list.
+ *
+ * Lists received from the server that contain only integers are held
+ * packed, as are lists constructed using neo4j_int_list(), and the array
+ * can then be read directly rather than using neo4j_list_get().
+ *
+ * @param [value] The neo4j list.
+ * @return A pointer to an array of neo4j_list_length() integers, or `NULL`
+ *         if the list is empty or does not hold packed integers.
+ */
+__neo4j_pure
+const int64_t *neo4j_list_int_values(neo4j_value_t value);
+
+/**
+ * Return the packed floats of a neo4j list.
+ *
+ * Lists received from the server that contain only floats are held
+ * packed, as are lists constructed using neo4j_float_list(), and the array
+ * can then be read directly rather than using neo4j_list_get().
+ *
+ * @param [value] The neo4j list.
+ * @return A pointer to an array of neo4j_list_length() doubles, or `NULL`
+ *         if the list is empty or does not hold packed floats.
+ */
+__neo4j_pure
+const double *neo4j_list_float_values(neo4j_value_t value);
+
 
 /**
  * Construct a neo4j value encoding a map.
@@ -875,6 +1000,41 @@ const neo4j_map_entry_t *neo4j_map_getentry(neo4j_value_t value,
 __neo4j_pure
 neo4j_value_t neo4j_map_kget(neo4j_value_t value, neo4j_value_t key);
 
+/**
+ * Construct a key for looking up values in neo4j maps.
+ *
+ * The key is hashed once, when constructed, and can then be used with
+ * neo4j_map_hget() to look up the same key in many maps.
+ *
+ * @param [key] The null terminated string key. This pointer must remain
+ *         valid, and the content unchanged, for the lifetime of the key.
+ * @return The key.
+ */
+__neo4j_pure
+neo4j_key_t neo4j_key(const char *key);
+
+/**
+ * Return a value from a neo4j map, using a precomputed key.
+ *
+ * In large maps received from the server, the position of the entry where
+ * the key is found is remembered in the key, and checked first in the next
+ * map, such that looking up the same keys in maps with the same layout
+ * (e.g. the properties of nodes in a result stream) involves a single
+ * comparison. The key must therefore not be used in multiple threads
+ * concurrently.
+ *
+ * If the map holds more than one entry with the key, the first is returned,
+ * as for neo4j_map_kget().
+ *
+ * Note that the result is undefined if the value is not of type NEO4J_MAP.
+ *
+ * @param [value] The neo4j map.
+ * @param [key] The key, constructed using neo4j_key().
+ * @return The value stored under the specified key, or #neo4j_null if the
+ *         key is not known.
+ */
+neo4j_value_t neo4j_map_hget(neo4j_value_t value, neo4j_key_t *key);
+
 /**
  * @fn neo4j_map_entry_t neo4j_map_entry(const char *key, neo4j_value_t value);
  * @brief Constrct a neo4j map entry.
@@ -1249,6 +1409,11 @@ int neo4j_config_set_TLS_ca_file(neo4j_config_t *config, const char *path);
  * The specified directory should contain the certificates of the trusted CAs
  * and CRLs, named by hash according to the `c_rehash` tool.
  *
+ * TLS contexts are cached between connections, and are reloaded when the
+ * directory or any file within it is found to have changed (by modification
+ * time, size or number of files). A file rewritten in place within the same
+ * second, leaving its size unchanged, may not be detected.
+ *
  * @param [config] The neo4j client configuration to update.
  * @param [path] The path to the directory of CAs and CRLs. This string should
  *         remain allocated whilst the config is allocated _or if any
@@ -1413,6 +1578,34 @@ extern struct neo4j_memory_allocator neo4j_std_memory_allocator;
 void neo4j_config_set_memory_allocator(neo4j_config_t *config,
         struct neo4j_memory_allocator *allocator);
 
+/**
+ * Set the size of memory arena blocks.
+ *
+ * When set, memory for values received from the server (e.g. the fields of
+ * result records) is allocated by advancing through larger blocks of the
+ * specified size, which are each obtained from the memory allocator once and
+ * are deallocated as a whole. Only allocations of up to a quarter of the
+ * block size are made from arena blocks. This is disabled by default.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [size] The arena block size, in bytes, or 0 to disable arena blocks.
+ */
+void neo4j_config_set_mpool_arena_size(neo4j_config_t *config, size_t size);
+
+/**
+ * Set the maximum size of memory cached for reuse by result records.
+ *
+ * When arena blocks are enabled (see neo4j_config_set_mpool_arena_size()),
+ * the arena blocks of each record released during neo4j_fetch_next() are
+ * retained by the result stream, up to this size, and reused for subsequent
+ * records. The default is 64KiB.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [size] The maximum size, in bytes, or 0 to disable caching.
+ */
+void neo4j_config_set_record_mpool_cache_size(neo4j_config_t *config,
+        size_t size);
+
 #define NEO4J_DEFAULT_MAX_PIPELINED_REQUESTS 10
 
 /**
@@ -1430,6 +1623,185 @@ void neo4j_config_set_memory_allocator(neo4j_config_t *config,
 void neo4j_config_set_max_pipelined_requests(neo4j_config_t *config,
         unsigned int n);
 
+#define NEO4J_DEFAULT_FETCH_SIZE 1000
+
+/**
+ * Set the number of records requested from the server at a time.
+ *
+ * When connected to a server using protocol version 4 or later, the records
+ * of a result stream are requested in batches of this size, with each
+ * subsequent batch requested only once the previous has been consumed
+ * using neo4j_fetch_next(). Records not yet requested when the stream is
+ * closed are discarded by the server. Older servers always send all records.
+ *
+ * @attention Until the last batch of a result stream has been received, no
+ * later statement in the same session is sent to the server, so batching
+ * prevents statements from being pipelined behind a large result. Set this
+ * to 0 to pipeline statements regardless of the size of their results.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [n] The number of records in each batch, or 0 to request all
+ *         records at once.
+ */
+void neo4j_config_set_fetch_size(neo4j_config_t *config, unsigned int n);
+
+/**
+ * Set the number of records read ahead of the application.
+ *
+ * When non-zero, once neo4j_fetch_next() is first called for a result
+ * stream, a background thread receives and decodes up to this many records
+ * ahead of those fetched, so that network I/O overlaps with the processing
+ * of each record. The default is 0, where records are only received as they
+ * are fetched.
+ *
+ * Whilst reading ahead, the session is in use by the background thread.
+ * Any other use of the session, including through other result streams,
+ * first stops the thread, and any records it has already received remain
+ * available to be fetched.
+ *
+ * @attention When non-zero, the memory allocator in use must be thread-safe.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [n] The maximum number of records to read ahead, or 0 to disable
+ *         reading ahead.
+ */
+void neo4j_config_set_read_ahead(neo4j_config_t *config, unsigned int n);
+
+/**
+ * Set the number of threads decoding records received in a session.
+ *
+ * When non-zero, each session starts this many worker threads once records
+ * are first received, and each record is decoded by a worker whilst further
+ * records are received. Records are still returned by neo4j_fetch_next() in
+ * the order they were received. The default is 0, where records are decoded
+ * as they are received.
+ *
+ * Records are always decoded as they are received when decoding lazily (see
+ * neo4j_config_set_lazy_record_decoding()), when a projection has been set
+ * for the result stream, or when records are delivered by callback.
+ *
+ * @attention When non-zero, the memory allocator in use must be thread-safe.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [n] The number of worker threads, or 0 to decode records as they
+ *         are received.
+ */
+void neo4j_config_set_deserialization_workers(neo4j_config_t *config,
+        unsigned int n);
+
+#define NEO4J_DEFAULT_POOL_MAX_IDLE 8
+
+/**
+ * Set the minimum number of idle connections held by a connection pool.
+ *
+ * This number of connections is established when the pool is created
+ * (see neo4j_new_pool()), and replacements are established whenever idle
+ * connections are found to have been closed, or a failed connection is
+ * returned. The default is 0.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [n] The minimum number of idle connections.
+ */
+void neo4j_config_set_pool_min_idle(neo4j_config_t *config, unsigned int n);
+
+/**
+ * Set the maximum number of idle connections held by a connection pool.
+ *
+ * Connections returned to a pool already holding this number of idle
+ * connections are closed.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [n] The maximum number of idle connections.
+ */
+void neo4j_config_set_pool_max_idle(neo4j_config_t *config, unsigned int n);
+
+/**
+ * Enable or disable zero-copy strings.
+ *
+ * When enabled, string values received from the server will reference their
+ * content directly within the received message, rather than being copied
+ * into separately allocated memory. The message is then retained for as long
+ * as any value received in it (e.g. a result record) is retained. This is
+ * disabled by default.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [enable] `true` to enable zero-copy strings, and `false` to disable
+ *         this behaviour.
+ */
+void neo4j_config_set_zero_copy_strings(neo4j_config_t *config, bool enable);
+
+/**
+ * Enable or disable lazy decoding of result records.
+ *
+ * When enabled, each record received in a result stream retains the
+ * encoded form of its fields, and a field is only decoded the first time it
+ * is accessed using neo4j_result_field(). Fields that are never accessed are
+ * never decoded. This is disabled by default.
+ *
+ * @attention When enabled, neo4j_result_field() may return a null value
+ * if the field is found to be invalid when decoded (errno will be set).
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [enable] `true` to enable lazy decoding, and `false` to disable
+ *         this behaviour.
+ */
+void neo4j_config_set_lazy_record_decoding(neo4j_config_t *config,
+        bool enable);
+
+/**
+ * Enable or disable interning of strings in result records.
+ *
+ * When enabled, each result stream holds a table of the map keys, node
+ * labels and relationship types decoded from its records, and equal strings
+ * in different records share a single allocation, rather than each being
+ * copied into the memory of its record. The memory saved is reported by
+ * neo4j_intern_stats(). This is disabled by default, and is not used with
+ * zero-copy strings (see neo4j_config_set_zero_copy_strings()).
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [enable] `true` to enable interning, and `false` to disable this
+ *         behaviour.
+ */
+void neo4j_config_set_intern_strings(neo4j_config_t *config, bool enable);
+
+/**
+ * Enable or disable inline strings in result records.
+ *
+ * When enabled, strings of up to 8 bytes decoded from result records hold
+ * their content within the neo4j value itself, rather than in separately
+ * allocated memory. Such strings are not interned (see
+ * neo4j_config_set_intern_strings()). This is disabled by default.
+ *
+ * @attention When enabled, the content of such strings must be accessed
+ * using neo4j_ustring_pointer() or neo4j_string_value(), as
+ * neo4j_ustring_value() will return `NULL` for them.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [enable] `true` to enable inline strings, and `false` to disable
+ *         this behaviour.
+ */
+void neo4j_config_set_inline_strings(neo4j_config_t *config, bool enable);
+
+/**
+ * Enable or disable pipelined session initialization.
+ *
+ * When enabled, a new session does not wait for the server to accept its
+ * authentication. Instead, the authentication request is sent together with
+ * the first requests of the session (e.g. the first statement run), saving
+ * a round trip. If authentication then fails, those requests will fail with
+ * the authentication error and the session will be unusable. This is
+ * disabled by default, and is not used if an authentication reattempt
+ * callback has been set.
+ *
+ * @attention When enabled, neo4j_credentials_expired() is only accurate
+ * once the first request of the session has completed.
+ *
+ * @param [config] The neo4j client configuration to update.
+ * @param [enable] `true` to enable pipelined initialization, and `false` to
+ *         disable this behaviour.
+ */
+void neo4j_config_set_pipelined_init(neo4j_config_t *config, bool enable);
+
 /**
  * Return a path within the neo4j dot directory.
  *
@@ -1555,6 +1927,79 @@ neo4j_connection_t *neo4j_tcp_connect(const char *hostname, unsigned int port,
 int neo4j_close(neo4j_connection_t *connection);
 
 
+/**
+ * Create a pool of connections to a neo4j server.
+ *
+ * Connections are checked out of the pool using neo4j_pool_checkout(), and
+ * returned using neo4j_pool_return(), rather than being established and
+ * closed for each use. Both functions may be called concurrently from
+ * multiple threads. A thread checking out a connection is preferentially
+ * given the connection it most recently returned.
+ *
+ * The pool holds between the configured minimum and maximum number of idle
+ * connections (see neo4j_config_set_pool_min_idle() and
+ * neo4j_config_set_pool_max_idle()). When used from multiple threads, any
+ * logger provider in the config must also be thread-safe.
+ *
+ * @param [uri] A URI describing the server to connect to, as for
+ *         neo4j_connect().
+ * @param [config] The neo4j client configuration to use for connections.
+ * @param [flags] A bitmask of flags to control connections, as for
+ *         neo4j_connect().
+ * @return A pointer to a `neo4j_pool_t` structure, or `NULL` on error
+ *         (errno will be set).
+ */
+__neo4j_must_check
+neo4j_pool_t *neo4j_new_pool(const char *uri, neo4j_config_t *config,
+        uint_fast32_t flags);
+
+/**
+ * Free a connection pool, closing all idle connections.
+ *
+ * All connections checked out of the pool should be returned first, and
+ * no other thread may be using the pool.
+ *
+ * @param [pool] The pool to free. The pointer will be invalid after the
+ *         function returns.
+ */
+void neo4j_pool_free(neo4j_pool_t *pool);
+
+/**
+ * Check out a connection from a pool.
+ *
+ * An idle connection is returned if available, after checking without
+ * blocking that it has not been closed by either end, and that the server
+ * has not sent anything unexpected on it. Idle connections failing this
+ * check are closed, and replaced to maintain the configured minimum number
+ * of idle connections. If no idle connection is available, then a new
+ * connection is established.
+ *
+ * @param [pool] The connection pool.
+ * @return A pointer to a `neo4j_connection_t` structure, or `NULL` on error
+ *         (errno will be set).
+ */
+__neo4j_must_check
+neo4j_connection_t *neo4j_pool_checkout(neo4j_pool_t *pool);
+
+/**
+ * Return a connection to a pool.
+ *
+ * Any session on the connection must first be ended. If the connection has
+ * been closed, or the pool already holds the maximum number of idle
+ * connections, then the connection is closed. A closed connection is
+ * replaced if the pool holds fewer than the minimum number of idle
+ * connections.
+ *
+ * @param [pool] The connection pool.
+ * @param [connection] The connection, which must have been checked out of
+ *         the same pool. The pointer will be invalid after the function
+ *         returns, except when an error occurs and errno is set to
+ *         NEO4J_SESSION_ACTIVE.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+int neo4j_pool_return(neo4j_pool_t *pool, neo4j_connection_t *connection);
+
+
 /**
  * Get the hostname for a connection.
  *
@@ -1598,6 +2043,20 @@ const char *neo4j_connection_username(const neo4j_connection_t *connection);
 __neo4j_pure
 bool neo4j_connection_is_secure(const neo4j_connection_t *connection);
 
+/**
+ * Obtain counts of TLS session resumption.
+ *
+ * TLS sessions from previous connections are cached per host and port, and
+ * offered to the server when reconnecting, allowing an abbreviated handshake.
+ * The counts cover all TLS connections established by the process.
+ *
+ * @param [hits] A pointer to receive the number of connections that resumed
+ *         a previous session, or `NULL`.
+ * @param [misses] A pointer to receive the number of connections that
+ *         required a full handshake, or `NULL`.
+ */
+void neo4j_tls_session_stats(unsigned long *hits, unsigned long *misses);
+
 
 /*
  * =====================================
@@ -1631,11 +2090,59 @@ int neo4j_end_session(neo4j_session_t *session);
  * cleared, including rolling back any open transactions, and causes any
  * existing result stream to be terminated.
  *
+ * The reset request is not awaited, but is sent ahead of the next requests
+ * made in the session (or when the session ends), and any error in handling
+ * it will be reported then.
+ *
  * @param [session] The session to reset.
  * @return 0 on sucess, or -1 if an error occurs (errno will be set).
  */
 int neo4j_reset_session(neo4j_session_t *session);
 
+/**
+ * Begin an explicit transaction.
+ *
+ * Statements subsequently evaluated in the session, using neo4j_run() or
+ * neo4j_send(), form part of the transaction until it is ended using
+ * neo4j_commit() or neo4j_rollback(). The request to begin the transaction
+ * is not sent immediately, but is pipelined with the statements that follow,
+ * so that a transaction can be evaluated in a single round trip to the
+ * server.
+ *
+ * If a statement in the transaction fails, the server rolls back the
+ * transaction, and any further statement is refused (errno will be set to
+ * `NEO4J_TRANSACTION_FAILED`) until the transaction is ended using
+ * neo4j_commit() or neo4j_rollback().
+ *
+ * @param [session] The session to begin the transaction in.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_begin_tx(neo4j_session_t *session);
+
+/**
+ * Commit the explicit transaction in a session.
+ *
+ * Any statements in the transaction that have not yet been sent are sent
+ * along with the commit, and the function then waits for the commit to
+ * complete. If any statement in the transaction failed, the transaction is
+ * rolled back by the server and errno is set to `NEO4J_TRANSACTION_FAILED`.
+ *
+ * @param [session] The session with the open transaction.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_commit(neo4j_session_t *session);
+
+/**
+ * Roll back the explicit transaction in a session.
+ *
+ * @param [session] The session with the open transaction.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_rollback(neo4j_session_t *session);
+
 /**
  * Obtain the connection associated with a session.
  *
@@ -1655,6 +2162,73 @@ neo4j_connection_t *neo4j_session_connection(neo4j_session_t *session);
 __neo4j_pure
 bool neo4j_credentials_expired(const neo4j_session_t *session);
 
+/**
+ * Place a session into non-blocking mode.
+ *
+ * In non-blocking mode, requests are not sent or received whilst waiting
+ * for the network. Instead, the application waits for the events returned by
+ * neo4j_session_events() to occur on the file descriptor returned by
+ * neo4j_session_fd(), and then calls neo4j_session_process() to make
+ * progress. Responses are delivered to the callbacks supplied to
+ * neo4j_run_async() from within neo4j_session_process().
+ *
+ * Functions that must wait for a response, such as neo4j_fetch_next(),
+ * continue to work in non-blocking mode, by waiting for the file descriptor
+ * internally.
+ *
+ * Non-blocking mode applies to the underlying connection and cannot be
+ * reverted. The connection must be backed by a file descriptor (see
+ * `struct neo4j_iostream`).
+ *
+ * @param [session] The session.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_set_nonblocking(neo4j_session_t *session);
+
+/**
+ * Get the file descriptor used by a session.
+ *
+ * @param [session] The session.
+ * @return The file descriptor, or -1 if an error occurs (errno will be set).
+ */
+int neo4j_session_fd(neo4j_session_t *session);
+
+/** The session is waiting for its file descriptor to become readable. */
+#define NEO4J_SESSION_WANT_READ (1<<0)
+/** The session is waiting for its file descriptor to become writable. */
+#define NEO4J_SESSION_WANT_WRITE (1<<1)
+
+/**
+ * Get the events a non-blocking session is waiting for.
+ *
+ * The result is a bitmask of `NEO4J_SESSION_WANT_READ` and
+ * `NEO4J_SESSION_WANT_WRITE`. It may change after any request is made in the
+ * session, and after each call to neo4j_session_process(). If no events are
+ * awaited, there are no outstanding requests in the session.
+ *
+ * @param [session] The session.
+ * @return A bitmask of the events awaited, or -1 if an error occurs (errno
+ *         will be set).
+ */
+int neo4j_session_events(neo4j_session_t *session);
+
+/**
+ * Make progress in a non-blocking session.
+ *
+ * Sends any queued requests and receives any responses available, invoking
+ * the callbacks for them, until no further progress can be made without
+ * waiting on the network. This function does not block.
+ *
+ * If an error occurs, the session fails and any outstanding requests are
+ * completed with the error `NEO4J_SESSION_FAILED`.
+ *
+ * @param [session] The session, which must be in non-blocking mode.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_process(neo4j_session_t *session);
+
 
 /*
  * =====================================
@@ -1699,6 +2273,167 @@ __neo4j_must_check
 neo4j_result_stream_t *neo4j_send(neo4j_session_t *session,
         const char *statement, neo4j_value_t params);
 
+/**
+ * A callback receiving a record from a statement evaluated using
+ * neo4j_run_async().
+ *
+ * @param [userdata] The user data supplied to neo4j_run_async().
+ * @param [fields] The fields of the record, as a value of type NEO4J_LIST.
+ *         The value, and all values within it, are only valid until the
+ *         callback returns.
+ * @return 0 to continue receiving records, or -1 to stop (errno should be
+ *         set), in which case the remaining records are discarded and the
+ *         result stream will fail with the given error.
+ */
+typedef int (*neo4j_record_callback_t)(void *userdata, neo4j_value_t fields);
+
+/**
+ * A callback invoked when a statement evaluated using neo4j_run_async() has
+ * completed.
+ *
+ * The result stream may be used to check for failure, or to obtain the
+ * update counts, statement plan and other metadata. No records can be
+ * fetched from it. The stream is closed when the callback returns, and must
+ * not be closed by the callback.
+ *
+ * @param [userdata] The user data supplied to neo4j_run_async().
+ * @param [results] The completed result stream.
+ */
+typedef void (*neo4j_results_callback_t)(void *userdata,
+        neo4j_result_stream_t *results);
+
+/**
+ * Evaluate a statement, delivering the results to callbacks.
+ *
+ * Each record is passed to the record callback as it is received, and is
+ * not retained afterwards. Once all records have been received, the
+ * completion callback is invoked. The callbacks are invoked from within
+ * neo4j_session_process() when the session is in non-blocking mode, or
+ * otherwise from within any subsequent function that waits on the session.
+ * If the session ends before the statement completes, the completion
+ * callback is invoked with a failed result stream.
+ *
+ * @attention The statement and the params must remain valid until the
+ * completion callback has been invoked.
+ *
+ * @param [session] The session to evaluate the statement in.
+ * @param [statement] The statement to be evaluated. This must be a `NULL`
+ *         terminated string and may contain UTF-8 multi-byte characters.
+ * @param [params] The parameters for the statement, which must be a value of
+ *         type NEO4J_MAP or #neo4j_null.
+ * @param [on_record] The callback to receive records, or `NULL`.
+ * @param [on_complete] The callback to invoke on completion, or `NULL`.
+ * @param [userdata] User data that will be supplied to the callbacks.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_run_async(neo4j_session_t *session, const char *statement,
+        neo4j_value_t params, neo4j_record_callback_t on_record,
+        neo4j_results_callback_t on_complete, void *userdata);
+
+/**
+ * Evaluate a statement, passing each record to a callback.
+ *
+ * Each record is passed to the callback as it is received, as with
+ * neo4j_run_async(), and the memory holding it is reused for the next
+ * record once the callback returns. Unlike neo4j_run_async(), this function
+ * returns once all records have been received.
+ *
+ * @param [session] The session to evaluate the statement in.
+ * @param [statement] The statement to be evaluated. This must be a `NULL`
+ *         terminated string and may contain UTF-8 multi-byte characters.
+ * @param [params] The parameters for the statement, which must be a value of
+ *         type NEO4J_MAP or #neo4j_null.
+ * @param [on_record] The callback to receive records.
+ * @param [userdata] User data that will be supplied to the callback.
+ * @return 0 on success, or -1 if an error occurs (errno will be set). If
+ *         the statement fails, errno will be set as neo4j_check_failure()
+ *         would return for the results (e.g.
+ *         `NEO4J_STATEMENT_EVALUATION_FAILED`), and if the callback stops
+ *         the results, errno will be set to the error it gave.
+ */
+__neo4j_must_check
+int neo4j_run_each(neo4j_session_t *session, const char *statement,
+        neo4j_value_t params, neo4j_record_callback_t on_record,
+        void *userdata);
+
+
+/*
+ * =====================================
+ * reactor
+ * =====================================
+ */
+
+/**
+ * Create a new reactor.
+ *
+ * A reactor waits for network events on any number of sessions, using
+ * epoll(7) where available, and makes progress in each session as its
+ * events occur. Results are delivered to the callbacks supplied to
+ * neo4j_run_async().
+ *
+ * @return A pointer to a `neo4j_reactor_t` structure, or `NULL` on error
+ *         (errno will be set).
+ */
+__neo4j_must_check
+neo4j_reactor_t *neo4j_new_reactor(void);
+
+/**
+ * Free a reactor.
+ *
+ * The sessions added to the reactor are not ended.
+ *
+ * @param [reactor] The reactor to free. This pointer will be invalid after
+ *         the function returns.
+ */
+void neo4j_reactor_free(neo4j_reactor_t *reactor);
+
+/**
+ * Add a session to a reactor.
+ *
+ * The session is placed into non-blocking mode (see
+ * neo4j_session_set_nonblocking()). Sessions may be added from within the
+ * callbacks invoked by neo4j_reactor_poll().
+ *
+ * @param [reactor] The reactor.
+ * @param [session] The session to add.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_reactor_add(neo4j_reactor_t *reactor, neo4j_session_t *session);
+
+/**
+ * Remove a session from a reactor.
+ *
+ * A session must be removed from the reactor before it is ended. This
+ * function must not be called from within the callbacks invoked by
+ * neo4j_reactor_poll().
+ *
+ * @param [reactor] The reactor.
+ * @param [session] The session to remove.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+int neo4j_reactor_remove(neo4j_reactor_t *reactor, neo4j_session_t *session);
+
+/**
+ * Wait for events in the sessions of a reactor, and process them.
+ *
+ * Waits until at least one session has made progress, or until the timeout
+ * expires, and invokes the callbacks for any responses received. If a
+ * session fails, its outstanding requests are completed with the error
+ * `NEO4J_SESSION_FAILED` and it is no longer polled.
+ *
+ * A typical event loop calls this function until it returns 0, e.g.
+ * `while ((n = neo4j_reactor_poll(reactor, -1)) > 0);`.
+ *
+ * @param [reactor] The reactor.
+ * @param [timeout] The maximum time to wait, in milliseconds, or -1 to wait
+ *         indefinitely.
+ * @return The number of sessions still awaiting responses, 0 if there are no
+ *         outstanding requests in any session (in which case this function
+ *         returns immediately), or -1 if an error occurs (errno will be set).
+ */
+int neo4j_reactor_poll(neo4j_reactor_t *reactor, int timeout);
 
 /*
  * =====================================
@@ -1741,6 +2476,28 @@ unsigned int neo4j_nfields(neo4j_result_stream_t *results);
 const char *neo4j_fieldname(neo4j_result_stream_t *results,
         unsigned int index);
 
+/**
+ * Restrict the fields decoded from each record in a result stream.
+ *
+ * Records subsequently received for the stream will only have the fields
+ * at the specified indices decoded. All other fields are stepped over in
+ * the received message, without allocating memory for them, and will
+ * read as `neo4j_null` via neo4j_result_field().
+ *
+ * Records already received when this function is invoked are unaffected.
+ * To apply the projection to all records, invoke it immediately after
+ * neo4j_run().
+ *
+ * @param [results] The result stream.
+ * @param [field_indices] An array of the indices of the fields to decode,
+ *         or `NULL` to remove any projection and decode all fields.
+ * @param [n] The number of indices in the `field_indices` array.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_set_projection(neo4j_result_stream_t *results,
+        const unsigned int *field_indices, unsigned int n);
+
 /**
  * Fetch the next record from the result stream.
  *
@@ -1768,6 +2525,26 @@ neo4j_result_t *neo4j_fetch_next(neo4j_result_stream_t *results);
  */
 int neo4j_close_results(neo4j_result_stream_t *results);
 
+/**
+ * Cancel and close a result stream.
+ *
+ * As for neo4j_close_results(), except that if the server is still
+ * streaming results, the statement is interrupted (by sending a RESET) and
+ * any results already in transit are discarded without being decoded. This
+ * avoids receiving the remainder of a large result that is no longer
+ * required.
+ *
+ * The statement is only interrupted when it is the last outstanding request
+ * in the session and the session is not within an explicit transaction.
+ * Otherwise, the remaining results are received and discarded, as for
+ * neo4j_close_results().
+ *
+ * @param [results] The result stream. The pointer will be invalid after the
+ *         function returns.
+ * @return 0 on success, or -1 if an error occurs (errno will be set).
+ */
+int neo4j_cancel_results(neo4j_result_stream_t *results);
+
 
 /*
  * =====================================
@@ -1955,6 +2732,31 @@ struct neo4j_update_counts
  */
 struct neo4j_update_counts neo4j_update_counts(neo4j_result_stream_t *results);
 
+/**
+ * Statistics for the strings interned in a result stream.
+ */
+struct neo4j_intern_stats
+{
+    /** Distinct strings interned. */
+    unsigned long long strings;
+    /** Strings decoded that were already interned. */
+    unsigned long long hits;
+    /** Bytes of string content shared, rather than copied. */
+    unsigned long long bytes_saved;
+};
+
+/**
+ * Return the statistics for strings interned in the result stream.
+ *
+ * Strings are only interned when enabled in the configuration (see
+ * neo4j_config_set_intern_strings()).
+ *
+ * @param [results] The result stream.
+ * @return The statistics for strings interned in the records received so
+ *         far. If strings are not interned, all the counts will be zero.
+ */
+struct neo4j_intern_stats neo4j_intern_stats(neo4j_result_stream_t *results);
+
 
 struct neo4j_statement_execution_step;
 
@@ -2047,9 +2849,17 @@ void neo4j_statement_plan_release(struct neo4j_statement_plan *plan);
 /**
  * Get a field from a result.
  *
+ * When records are decoded lazily (see
+ * neo4j_config_set_lazy_record_decoding()), the field is decoded on first
+ * access, and #neo4j_null is returned if it cannot be decoded (errno will
+ * be set). If the result is the last fetched from its stream, the stream
+ * then fails, and the error is reported by neo4j_check_failure() and
+ * neo4j_fetch_next().
+ *
  * @param [result] A result.
  * @param [index] The field index to get.
- * @return The field from the result, or #neo4j_null if index is out of bounds.
+ * @return The field from the result, or #neo4j_null if index is out of bounds
+ *         or the field cannot be decoded.
  */
 neo4j_value_t neo4j_result_field(const neo4j_result_t *result,
         unsigned int index);
@@ -23,9 +23,9 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/socket.h>
-#include <sys/select.h>
 #include <unistd.h>
 
 static void init_getaddrinfo_hints(struct addrinfo *hints);
@@ -165,14 +165,7 @@ void set_socket_options(int fd, const neo4j_config_t *config,
 int connect_with_timeout(int fd, const struct sockaddr *address,
         socklen_t address_len, time_t timeout, neo4j_logger_t *logger)
 {
-    struct timeval tv, *tvp = NULL;
-
-    if (timeout > 0)
-    {
-        tv.tv_sec = timeout;
-        tv.tv_usec = 0;
-        tvp = &tv;
-    }
+    int timeout_ms = (timeout > 0)? (int)(timeout * 1000) : -1;
 
     if (update_socket_flags(fd, O_NONBLOCK, 0, logger))
     {
@@ -188,18 +181,17 @@ int connect_with_timeout(int fd, const struct sockaddr *address,
             return 1;
         }
 
-        fd_set fdset;
-        FD_ZERO(&fdset);
-        FD_SET(fd, &fdset);
-
+        // poll, unlike select, is not limited to descriptors below
+        // FD_SETSIZE
+        struct pollfd pfd = { .fd = fd, .events = POLLOUT };
         do
         {
-            err = select(fd + 1, NULL, &fdset, NULL, tvp);
+            err = poll(&pfd, 1, timeout_ms);
         } while (err < 0 && errno == EINTR);
 
         if (err < 0)
         {
-            neo4j_log_error_errno(logger, "select");
+            neo4j_log_error_errno(logger, "poll");
             return -1;
         }
 
@@ -234,6 +226,13 @@ int connect_with_timeout(int fd, const struct sockaddr *address,
 }
 
 
+int neo4j_socket_set_nonblocking(int fd, neo4j_logger_t *logger)
+{
+    REQUIRE(fd >= 0, -1);
+    return update_socket_flags(fd, O_NONBLOCK, 0, logger);
+}
+
+
 int update_socket_flags(int fd, int flags_to_set, int flags_to_clear,
         neo4j_logger_t *logger)
 {
@@ -245,7 +244,7 @@ int update_socket_flags(int fd, int flags_to_set, int flags_to_clear,
     }
 
     arg |= flags_to_set;
-    arg &= flags_to_clear;
+    arg &= ~flags_to_clear;
 
     if (fcntl(fd, F_SETFL, arg) < 0)
     {
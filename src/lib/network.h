@@ -34,4 +34,16 @@ __neo4j_must_check
 int neo4j_connect_tcp_socket(const char *hostname, const char *servname,
         const neo4j_config_t *config, struct neo4j_logger *logger);
 
+/**
+ * Place a socket into non-blocking mode.
+ *
+ * @internal
+ *
+ * @param [fd] The socket file descriptor.
+ * @param [logger] A logger to write diagnostics and errors to.
+ * @return 0 on success, or -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_socket_set_nonblocking(int fd, struct neo4j_logger *logger);
+
 #endif/*NEO4J_NETWORK_H*/
@@ -23,6 +23,11 @@
 #include "tofu.h"
 #include "util.h"
 #include <assert.h>
+#include <dirent.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <sys/stat.h>
 // FIXME: openssl 1.1.0-pre4 has issues with cast-qual
 // (and perhaps earlier versions?)
 #pragma GCC diagnostic push
@@ -32,13 +37,96 @@
 #pragma GCC diagnostic pop
 
 #define NEO4J_CYPHER_LIST "HIGH:!EXPORT:!aNULL@STRENGTH"
+#define NEO4J_CTX_CACHE_SIZE 8
+#define NEO4J_SESSION_CACHE_SIZE 32
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+#define SSL_CTX_up_ref(ctx) \
+        CRYPTO_add(&((ctx)->references), 1, CRYPTO_LOCK_SSL_CTX)
+#define SSL_SESSION_up_ref(session) \
+        CRYPTO_add(&((session)->references), 1, CRYPTO_LOCK_SSL_SESSION)
+#endif
+
+struct file_stamp
+{
+    bool exists;
+    dev_t dev;
+    ino_t ino;
+    off_t size;
+    time_t mtime;
+    // for a directory, a summary of the entries within it
+    unsigned int nentries;
+    off_t entries_size;
+    time_t entries_mtime;
+};
+
+struct ctx_cache_entry
+{
+    struct ctx_cache_entry *next;
+    char *private_key_file;
+    char *ca_file;
+    char *ca_dir;
+    neo4j_password_callback_t pem_pw_callback;
+    void *pem_pw_callback_userdata;
+    struct file_stamp stamps[3];
+    SSL_CTX *ctx;
+};
+
+struct session_cache
+{
+    neo4j_mutex_t lock;
+    unsigned int next;
+    struct session_cache_entry
+    {
+        char *hostname;
+        int port;
+        SSL_SESSION *session;
+    } entries[NEO4J_SESSION_CACHE_SIZE];
+};
+
+struct session_target
+{
+    char *hostname;
+    int port;
+    bool verified;
+    SSL_SESSION *pending;
+};
 
 static neo4j_mutex_t *thread_locks;
+static neo4j_mutex_t ctx_cache_lock;
+static struct ctx_cache_entry *ctx_cache;
+static int session_cache_index = -1;
+static int session_target_index = -1;
+static atomic_ulong session_hits;
+static atomic_ulong session_misses;
 
 #ifdef HAVE_CRYPTO_SET_LOCKING_CALLBACK
 static void locking_callback(int mode, int type, const char *file, int line);
 #endif
+static SSL_CTX *cached_ctx(const neo4j_config_t *config,
+        neo4j_logger_t *logger);
+static bool cache_entry_matches(const struct ctx_cache_entry *entry,
+        const neo4j_config_t *config);
+static struct ctx_cache_entry *new_cache_entry(const neo4j_config_t *config,
+        const struct file_stamp stamps[3], neo4j_logger_t *logger);
+static void cache_entry_free(struct ctx_cache_entry *entry);
+static void file_stamps(struct file_stamp stamps[3],
+        const neo4j_config_t *config);
+static void file_stamp(struct file_stamp *stamp, const char *path);
+static void dir_stamp(struct file_stamp *stamp, const char *path);
+static bool str_equal(const char *s1, const char *s2);
 static SSL_CTX *new_ctx(const neo4j_config_t *config, neo4j_logger_t *logger);
+static int attach_session_cache(SSL_CTX *ctx);
+static void free_session_cache(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+        int idx, long argl, void *argp);
+static int set_session_target(SSL *ssl, const char *hostname, int port);
+static void free_session_target(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+        int idx, long argl, void *argp);
+static int new_session_callback(SSL *ssl, SSL_SESSION *session);
+static void store_session(SSL_CTX *ctx, const char *hostname, int port,
+        SSL_SESSION *session);
+static SSL_SESSION *find_session(SSL_CTX *ctx, const char *hostname, int port);
+static void session_verified(SSL *ssl);
 static int load_private_key(SSL_CTX *ctx, const neo4j_config_t *config,
         neo4j_logger_t *logger);
 static int pem_pw_callback(char *buf, int size, int rwflag, void *userdata);
@@ -112,12 +200,43 @@ int neo4j_openssl_init(void)
     SSL_CTX_set_options(ctx, SSL_OP_NO_SSLv2 | SSL_OP_NO_SSLv3);
     SSL_CTX_free(ctx);
 
+    int err = neo4j_mutex_init(&ctx_cache_lock);
+    if (err)
+    {
+        errno = err;
+        return -1;
+    }
+    ctx_cache = NULL;
+
+    if (session_cache_index < 0)
+    {
+        session_cache_index = SSL_CTX_get_ex_new_index(0, NULL, NULL, NULL,
+                free_session_cache);
+        session_target_index = SSL_get_ex_new_index(0, NULL, NULL, NULL,
+                free_session_target);
+        if (session_cache_index < 0 || session_target_index < 0)
+        {
+            errno = openssl_error(NULL, NEO4J_LOG_ERROR, __FILE__, __LINE__);
+            return -1;
+        }
+    }
+    atomic_init(&session_hits, 0);
+    atomic_init(&session_misses, 0);
+
     return 0;
 }
 
 
 int neo4j_openssl_cleanup(void)
 {
+    while (ctx_cache != NULL)
+    {
+        struct ctx_cache_entry *entry = ctx_cache;
+        ctx_cache = entry->next;
+        cache_entry_free(entry);
+    }
+    neo4j_mutex_destroy(&ctx_cache_lock);
+
 #ifdef HAVE_CRYPTO_SET_LOCKING_CALLBACK
     if (CRYPTO_get_locking_callback() == locking_callback)
     {
@@ -159,7 +278,7 @@ BIO *neo4j_openssl_new_bio(BIO *delegate, const char *hostname, int port,
 {
     neo4j_logger_t *logger = neo4j_get_logger(config, "tls");
 
-    SSL_CTX *ctx = new_ctx(config, logger);
+    SSL_CTX *ctx = cached_ctx(config, logger);
     if (ctx == NULL)
     {
         neo4j_logger_release(logger);
@@ -174,6 +293,28 @@ BIO *neo4j_openssl_new_bio(BIO *delegate, const char *hostname, int port,
         goto failure;
     }
 
+    SSL *ssl = NULL;
+    BIO_get_ssl(ssl_bio, &ssl);
+    assert(ssl != NULL);
+    if (set_session_target(ssl, hostname, port))
+    {
+        SSL_CTX_free(ctx);
+        goto failure;
+    }
+    // a non-blocking write may be retried from a relocated buffer
+    SSL_set_mode(ssl, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+
+    SSL_SESSION *session = find_session(ctx, hostname, port);
+    if (session != NULL)
+    {
+        if (SSL_set_session(ssl, session) != 1)
+        {
+            // fall back to a full handshake
+            ERR_clear_error();
+        }
+        SSL_SESSION_free(session);
+    }
+
     SSL_CTX_free(ctx);
 
     BIO_push(ssl_bio, delegate);
@@ -202,13 +343,21 @@ BIO *neo4j_openssl_new_bio(BIO *delegate, const char *hostname, int port,
         goto failure;
     }
 
-    SSL *ssl = NULL;
-    BIO_get_ssl(ssl_bio, &ssl);
-    assert(ssl != NULL);
+    if (SSL_session_reused(ssl))
+    {
+        atomic_fetch_add(&session_hits, 1);
+        neo4j_log_debug(logger, "resumed TLS session");
+    }
+    else
+    {
+        atomic_fetch_add(&session_misses, 1);
+    }
+
     if (verify(ssl, hostname, port, config, flags, logger))
     {
         goto failure;
     }
+    session_verified(ssl);
 
     neo4j_logger_release(logger);
     return ssl_bio;
@@ -223,6 +372,221 @@ failure:
 }
 
 
+SSL_CTX *neo4j_openssl_ctx(const neo4j_config_t *config)
+{
+    neo4j_logger_t *logger = neo4j_get_logger(config, "tls");
+    SSL_CTX *ctx = cached_ctx(config, logger);
+    neo4j_logger_release(logger);
+    return ctx;
+}
+
+
+SSL_CTX *cached_ctx(const neo4j_config_t *config, neo4j_logger_t *logger)
+{
+    struct file_stamp stamps[3];
+    file_stamps(stamps, config);
+
+    neo4j_mutex_lock(&ctx_cache_lock);
+
+    struct ctx_cache_entry **prev = &ctx_cache;
+    struct ctx_cache_entry *entry = ctx_cache;
+    for (; entry != NULL; prev = &(entry->next), entry = entry->next)
+    {
+        if (cache_entry_matches(entry, config))
+        {
+            break;
+        }
+    }
+
+    if (entry != NULL)
+    {
+        // unlink, and move to the front if still valid
+        *prev = entry->next;
+        if (memcmp(entry->stamps, stamps, sizeof(entry->stamps)) != 0)
+        {
+            neo4j_log_debug(logger, "TLS files changed, reloading context");
+            cache_entry_free(entry);
+            entry = NULL;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        entry = new_cache_entry(config, stamps, logger);
+        if (entry == NULL)
+        {
+            int errsv = errno;
+            neo4j_mutex_unlock(&ctx_cache_lock);
+            errno = errsv;
+            return NULL;
+        }
+
+        // evict the least recently used context (connections using it
+        // retain their own reference)
+        unsigned int n = 0;
+        struct ctx_cache_entry **last = &ctx_cache;
+        for (; *last != NULL; last = &((*last)->next))
+        {
+            if (++n == NEO4J_CTX_CACHE_SIZE)
+            {
+                cache_entry_free(*last);
+                *last = NULL;
+                break;
+            }
+        }
+    }
+
+    entry->next = ctx_cache;
+    ctx_cache = entry;
+    SSL_CTX_up_ref(entry->ctx);
+
+    neo4j_mutex_unlock(&ctx_cache_lock);
+    return entry->ctx;
+}
+
+
+bool cache_entry_matches(const struct ctx_cache_entry *entry,
+        const neo4j_config_t *config)
+{
+    return str_equal(entry->private_key_file, config->tls_private_key_file) &&
+        str_equal(entry->ca_file, config->tls_ca_file) &&
+        str_equal(entry->ca_dir, config->tls_ca_dir) &&
+        entry->pem_pw_callback == config->tls_pem_pw_callback &&
+        entry->pem_pw_callback_userdata ==
+                config->tls_pem_pw_callback_userdata;
+}
+
+
+struct ctx_cache_entry *new_cache_entry(const neo4j_config_t *config,
+        const struct file_stamp stamps[3], neo4j_logger_t *logger)
+{
+    struct ctx_cache_entry *entry = calloc(1, sizeof(struct ctx_cache_entry));
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    if (config->tls_private_key_file != NULL &&
+        (entry->private_key_file = strdup(config->tls_private_key_file))
+            == NULL)
+    {
+        goto failure;
+    }
+    if (config->tls_ca_file != NULL &&
+        (entry->ca_file = strdup(config->tls_ca_file)) == NULL)
+    {
+        goto failure;
+    }
+    if (config->tls_ca_dir != NULL &&
+        (entry->ca_dir = strdup(config->tls_ca_dir)) == NULL)
+    {
+        goto failure;
+    }
+    entry->pem_pw_callback = config->tls_pem_pw_callback;
+    entry->pem_pw_callback_userdata = config->tls_pem_pw_callback_userdata;
+    memcpy(entry->stamps, stamps, sizeof(entry->stamps));
+
+    entry->ctx = new_ctx(config, logger);
+    if (entry->ctx == NULL)
+    {
+        goto failure;
+    }
+
+    return entry;
+
+    int errsv;
+failure:
+    errsv = errno;
+    cache_entry_free(entry);
+    errno = errsv;
+    return NULL;
+}
+
+
+void cache_entry_free(struct ctx_cache_entry *entry)
+{
+    if (entry->ctx != NULL)
+    {
+        SSL_CTX_free(entry->ctx);
+    }
+    free(entry->private_key_file);
+    free(entry->ca_file);
+    free(entry->ca_dir);
+    free(entry);
+}
+
+
+void file_stamps(struct file_stamp stamps[3], const neo4j_config_t *config)
+{
+    memset(stamps, 0, 3 * sizeof(struct file_stamp));
+    file_stamp(&(stamps[0]), config->tls_private_key_file);
+    file_stamp(&(stamps[1]), config->tls_ca_file);
+    file_stamp(&(stamps[2]), config->tls_ca_dir);
+}
+
+
+void file_stamp(struct file_stamp *stamp, const char *path)
+{
+    struct stat sb;
+    if (path == NULL || stat(path, &sb) != 0)
+    {
+        return;
+    }
+    stamp->exists = true;
+    stamp->dev = sb.st_dev;
+    stamp->ino = sb.st_ino;
+    stamp->size = sb.st_size;
+    stamp->mtime = sb.st_mtime;
+    if (S_ISDIR(sb.st_mode))
+    {
+        dir_stamp(stamp, path);
+    }
+}
+
+
+void dir_stamp(struct file_stamp *stamp, const char *path)
+{
+    // replacing a file in place does not update the directory mtime, so
+    // also summarize the files within it
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL)
+    {
+        char entry_path[PATH_MAX];
+        int n = snprintf(entry_path, sizeof(entry_path), "%s/%s",
+                path, de->d_name);
+        struct stat sb;
+        if (n < 0 || (size_t)n >= sizeof(entry_path) ||
+                stat(entry_path, &sb) != 0 || S_ISDIR(sb.st_mode))
+        {
+            continue;
+        }
+        stamp->nentries++;
+        stamp->entries_size += sb.st_size;
+        if (sb.st_mtime > stamp->entries_mtime)
+        {
+            stamp->entries_mtime = sb.st_mtime;
+        }
+    }
+    closedir(dir);
+}
+
+
+bool str_equal(const char *s1, const char *s2)
+{
+    if (s1 == NULL || s2 == NULL)
+    {
+        return s1 == s2;
+    }
+    return strcmp(s1, s2) == 0;
+}
+
+
 SSL_CTX *new_ctx(const neo4j_config_t *config, neo4j_logger_t *logger)
 {
     SSL_CTX *ctx = SSL_CTX_new(SSLv23_method());
@@ -242,8 +606,14 @@ SSL_CTX *new_ctx(const neo4j_config_t *config, neo4j_logger_t *logger)
     // Necessary when using blocking sockets
     SSL_CTX_set_mode(ctx, SSL_MODE_AUTO_RETRY);
 
-    // Caching should be done at the protocol layer anyway
-    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    // Sessions are cached per host and port (see store_session)
+    SSL_CTX_set_session_cache_mode(ctx,
+            SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(ctx, new_session_callback);
+    if (attach_session_cache(ctx))
+    {
+        goto failure;
+    }
 
     if (load_private_key(ctx, config, logger))
     {
@@ -266,6 +636,226 @@ failure:
 }
 
 
+void neo4j_openssl_session_stats(unsigned long *hits, unsigned long *misses)
+{
+    if (hits != NULL)
+    {
+        *hits = atomic_load(&session_hits);
+    }
+    if (misses != NULL)
+    {
+        *misses = atomic_load(&session_misses);
+    }
+}
+
+
+int attach_session_cache(SSL_CTX *ctx)
+{
+    struct session_cache *cache = calloc(1, sizeof(struct session_cache));
+    if (cache == NULL)
+    {
+        return -1;
+    }
+    int err = neo4j_mutex_init(&(cache->lock));
+    if (err)
+    {
+        free(cache);
+        errno = err;
+        return -1;
+    }
+    if (SSL_CTX_set_ex_data(ctx, session_cache_index, cache) != 1)
+    {
+        neo4j_mutex_destroy(&(cache->lock));
+        free(cache);
+        errno = openssl_error(NULL, NEO4J_LOG_ERROR, __FILE__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+
+void free_session_cache(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+        int idx, long argl, void *argp)
+{
+    struct session_cache *cache = (struct session_cache *)ptr;
+    if (cache == NULL)
+    {
+        return;
+    }
+    for (unsigned int i = 0; i < NEO4J_SESSION_CACHE_SIZE; ++i)
+    {
+        struct session_cache_entry *entry = &(cache->entries[i]);
+        if (entry->session != NULL)
+        {
+            SSL_SESSION_free(entry->session);
+        }
+        free(entry->hostname);
+    }
+    neo4j_mutex_destroy(&(cache->lock));
+    free(cache);
+}
+
+
+int set_session_target(SSL *ssl, const char *hostname, int port)
+{
+    struct session_target *target = calloc(1, sizeof(struct session_target));
+    if (target == NULL)
+    {
+        return -1;
+    }
+    target->hostname = strdup(hostname);
+    if (target->hostname == NULL)
+    {
+        free(target);
+        return -1;
+    }
+    target->port = port;
+    if (SSL_set_ex_data(ssl, session_target_index, target) != 1)
+    {
+        free(target->hostname);
+        free(target);
+        errno = openssl_error(NULL, NEO4J_LOG_ERROR, __FILE__, __LINE__);
+        return -1;
+    }
+    return 0;
+}
+
+
+void free_session_target(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+        int idx, long argl, void *argp)
+{
+    struct session_target *target = (struct session_target *)ptr;
+    if (target == NULL)
+    {
+        return;
+    }
+    if (target->pending != NULL)
+    {
+        SSL_SESSION_free(target->pending);
+    }
+    free(target->hostname);
+    free(target);
+}
+
+
+int new_session_callback(SSL *ssl, SSL_SESSION *session)
+{
+    struct session_target *target =
+        SSL_get_ex_data(ssl, session_target_index);
+    if (target == NULL)
+    {
+        return 0;
+    }
+
+    if (!target->verified)
+    {
+        // the session may arrive before the server has been verified, in
+        // which case it is held until verification succeeds
+        if (target->pending != NULL)
+        {
+            SSL_SESSION_free(target->pending);
+        }
+        target->pending = session;
+        return 1;
+    }
+
+    store_session(SSL_get_SSL_CTX(ssl), target->hostname, target->port,
+            session);
+    return 1;
+}
+
+
+void session_verified(SSL *ssl)
+{
+    struct session_target *target =
+        SSL_get_ex_data(ssl, session_target_index);
+    assert(target != NULL);
+    target->verified = true;
+    if (target->pending != NULL)
+    {
+        store_session(SSL_get_SSL_CTX(ssl), target->hostname, target->port,
+                target->pending);
+        target->pending = NULL;
+    }
+}
+
+
+void store_session(SSL_CTX *ctx, const char *hostname, int port,
+        SSL_SESSION *session)
+{
+    struct session_cache *cache = SSL_CTX_get_ex_data(ctx, session_cache_index);
+    if (cache == NULL)
+    {
+        SSL_SESSION_free(session);
+        return;
+    }
+
+    neo4j_mutex_lock(&(cache->lock));
+
+    struct session_cache_entry *entry = NULL;
+    for (unsigned int i = 0; i < NEO4J_SESSION_CACHE_SIZE; ++i)
+    {
+        struct session_cache_entry *e = &(cache->entries[i]);
+        if (e->hostname != NULL && e->port == port &&
+                strcmp(e->hostname, hostname) == 0)
+        {
+            entry = e;
+            break;
+        }
+    }
+
+    if (entry == NULL)
+    {
+        char *h = strdup(hostname);
+        if (h == NULL)
+        {
+            neo4j_mutex_unlock(&(cache->lock));
+            SSL_SESSION_free(session);
+            return;
+        }
+        entry = &(cache->entries[cache->next]);
+        cache->next = (cache->next + 1) % NEO4J_SESSION_CACHE_SIZE;
+        free(entry->hostname);
+        entry->hostname = h;
+        entry->port = port;
+    }
+
+    if (entry->session != NULL)
+    {
+        SSL_SESSION_free(entry->session);
+    }
+    entry->session = session;
+
+    neo4j_mutex_unlock(&(cache->lock));
+}
+
+
+SSL_SESSION *find_session(SSL_CTX *ctx, const char *hostname, int port)
+{
+    struct session_cache *cache = SSL_CTX_get_ex_data(ctx, session_cache_index);
+    if (cache == NULL)
+    {
+        return NULL;
+    }
+
+    SSL_SESSION *session = NULL;
+    neo4j_mutex_lock(&(cache->lock));
+    for (unsigned int i = 0; i < NEO4J_SESSION_CACHE_SIZE; ++i)
+    {
+        struct session_cache_entry *e = &(cache->entries[i]);
+        if (e->session != NULL && e->port == port &&
+                strcmp(e->hostname, hostname) == 0)
+        {
+            session = e->session;
+            SSL_SESSION_up_ref(session);
+            break;
+        }
+    }
+    neo4j_mutex_unlock(&(cache->lock));
+    return session;
+}
+
+
 int load_private_key(SSL_CTX *ctx, const neo4j_config_t *config,
         neo4j_logger_t *logger)
 {
@@ -275,18 +865,25 @@ int load_private_key(SSL_CTX *ctx, const neo4j_config_t *config,
         return 0;
     }
 
-    if (SSL_CTX_use_certificate_chain_file(ctx, private_key) != 1)
-    {
-        errno = openssl_error(logger, NEO4J_LOG_ERROR, __FILE__, __LINE__);
-        return -1;
-    }
-
+    // the context is shared beyond the lifetime of the config, so the
+    // callback is only installed while loading
     if (config->tls_pem_pw_callback != NULL)
     {
         SSL_CTX_set_default_passwd_cb_userdata(ctx, (void *)(intptr_t)config);
         SSL_CTX_set_default_passwd_cb(ctx, pem_pw_callback);
     }
 
+    int result = SSL_CTX_use_certificate_chain_file(ctx, private_key);
+
+    SSL_CTX_set_default_passwd_cb(ctx, NULL);
+    SSL_CTX_set_default_passwd_cb_userdata(ctx, NULL);
+
+    if (result != 1)
+    {
+        errno = openssl_error(logger, NEO4J_LOG_ERROR, __FILE__, __LINE__);
+        return -1;
+    }
+
     return 0;
 }
 
@@ -294,7 +891,7 @@ int load_private_key(SSL_CTX *ctx, const neo4j_config_t *config,
 int pem_pw_callback(char *buf, int size, int rwflag, void *userdata)
 {
     const neo4j_config_t *config = (const neo4j_config_t *)userdata;
-    if (config->tls_pem_pw_callback != NULL)
+    if (config->tls_pem_pw_callback == NULL)
     {
         return 0;
     }
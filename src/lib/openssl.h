@@ -49,6 +49,22 @@ int neo4j_openssl_init(void);
 __neo4j_must_check
 int neo4j_openssl_cleanup(void);
 
+/**
+ * Obtain the SSL context for a configuration.
+ *
+ * Contexts are cached and shared by all connections using the same TLS
+ * configuration, and are only reloaded when the private key or certificate
+ * authority files change.
+ *
+ * @internal
+ *
+ * @param [config] The client configuration.
+ * @return A reference to the SSL context, which must be released using
+ *         `SSL_CTX_free(...)`, or `NULL` on failure (errno will be set).
+ */
+__neo4j_must_check
+SSL_CTX *neo4j_openssl_ctx(const neo4j_config_t *config);
+
 /**
  * Create a SSL BIO.
  *
@@ -65,4 +81,16 @@ __neo4j_must_check
 BIO *neo4j_openssl_new_bio(BIO *delegate, const char *hostname, int port,
         const neo4j_config_t *config, uint_fast32_t flags);
 
+/**
+ * Obtain counts of TLS session resumption.
+ *
+ * @internal
+ *
+ * @param [hits] A pointer to receive the number of handshakes that resumed
+ *         a cached session, or `NULL`.
+ * @param [misses] A pointer to receive the number of full handshakes,
+ *         or `NULL`.
+ */
+void neo4j_openssl_session_stats(unsigned long *hits, unsigned long *misses);
+
 #endif/*NEO4J_OPENSSL_H*/
@@ -31,6 +31,7 @@ struct openssl_iostream {
     neo4j_iostream_t _iostream;
     BIO *bio;
     neo4j_iostream_t *delegate;
+    int fd;
 };
 
 
@@ -43,6 +44,11 @@ static ssize_t openssl_writev(neo4j_iostream_t *self,
         const struct iovec *iov, unsigned int iovcnt);
 static int openssl_flush(neo4j_iostream_t *self);
 static int openssl_close(neo4j_iostream_t *self);
+static int openssl_fileno(neo4j_iostream_t *self);
+static ssize_t retry_result(struct openssl_iostream *ios, int result);
+static neo4j_iostream_t *new_openssl_iostream(BIO *delegate_bio,
+        neo4j_iostream_t *delegate, int fd, const char *hostname, int port,
+        const neo4j_config_t *config, uint_fast32_t flags);
 
 static int iostream_bio_write(BIO *bio, const char *buf, int nbyte);
 static int iostream_bio_read(BIO *bio, char *buf, int nbyte);
@@ -120,9 +126,37 @@ neo4j_iostream_t *neo4j_openssl_iostream(neo4j_iostream_t *delegate,
     }
     BIO_set_data(iostream_bio, delegate);
 
+    return new_openssl_iostream(iostream_bio, delegate, -1, hostname, port,
+            config, flags);
+}
+
+
+neo4j_iostream_t *neo4j_openssl_socket_iostream(int fd,
+        const char *hostname, int port,
+        const neo4j_config_t *config, uint_fast32_t flags)
+{
+    REQUIRE(fd >= 0, NULL);
+    REQUIRE(hostname != NULL, NULL);
+    REQUIRE(config != NULL, NULL);
+
+    BIO *socket_bio = BIO_new_socket(fd, BIO_NOCLOSE);
+    if (socket_bio == NULL)
+    {
+        return NULL;
+    }
+
+    return new_openssl_iostream(socket_bio, NULL, fd, hostname, port,
+            config, flags);
+}
+
+
+neo4j_iostream_t *new_openssl_iostream(BIO *delegate_bio,
+        neo4j_iostream_t *delegate, int fd, const char *hostname, int port,
+        const neo4j_config_t *config, uint_fast32_t flags)
+{
     struct openssl_iostream *ios = NULL;
 
-    BIO *ssl_bio = neo4j_openssl_new_bio(iostream_bio, hostname, port,
+    BIO *ssl_bio = neo4j_openssl_new_bio(delegate_bio, hostname, port,
             config, flags);
     if (ssl_bio == NULL)
     {
@@ -137,6 +171,7 @@ neo4j_iostream_t *neo4j_openssl_iostream(neo4j_iostream_t *delegate,
 
     ios->bio = ssl_bio;
     ios->delegate = delegate;
+    ios->fd = fd;
     neo4j_iostream_t *iostream = &(ios->_iostream);
     iostream->read = openssl_read;
     iostream->readv = openssl_readv;
@@ -144,6 +179,7 @@ neo4j_iostream_t *neo4j_openssl_iostream(neo4j_iostream_t *delegate,
     iostream->writev = openssl_writev;
     iostream->flush = openssl_flush;
     iostream->close = openssl_close;
+    iostream->fileno = openssl_fileno;
     return iostream;
 
     int errsv;
@@ -153,7 +189,7 @@ failure:
     {
         BIO_free(ssl_bio);
     }
-    BIO_free(iostream_bio);
+    BIO_free(delegate_bio);
     errno = errsv;
     return NULL;
 }
@@ -170,7 +206,7 @@ ssize_t openssl_read(neo4j_iostream_t *self, void *buf, size_t nbyte)
     }
     // TODO: check if BIO_read sets errno on error
     int len = (nbyte < INT_MAX)? nbyte : INT_MAX;
-    return BIO_read(ios->bio, buf, len);
+    return retry_result(ios, BIO_read(ios->bio, buf, len));
 }
 
 
@@ -187,10 +223,32 @@ ssize_t openssl_readv(neo4j_iostream_t *self,
     }
 
     // TODO: check if BIO_read sets errno on error
-    // TODO: if iovcnt > 1, this will always be a short read, so instead
-    // consider reading entire vector
-    int len = (iov[0].iov_len < INT_MAX)? iov[0].iov_len : INT_MAX;
-    return BIO_read(ios->bio, iov[0].iov_base, len);
+    // Decrypt directly into each vector, continuing only whilst decrypted
+    // data is already pending (so as not to block after a partial read)
+    ssize_t total = 0;
+    for (unsigned int i = 0; i < iovcnt; ++i)
+    {
+        if (iov[i].iov_len == 0)
+        {
+            continue;
+        }
+        if (i > 0 && BIO_pending(ios->bio) <= 0)
+        {
+            break;
+        }
+        int len = (iov[i].iov_len < INT_MAX)? iov[i].iov_len : INT_MAX;
+        int result = BIO_read(ios->bio, iov[i].iov_base, len);
+        if (result <= 0)
+        {
+            return (total > 0)? total : retry_result(ios, result);
+        }
+        total += result;
+        if ((size_t)result < iov[i].iov_len)
+        {
+            break;
+        }
+    }
+    return total;
 }
 
 
@@ -205,7 +263,7 @@ ssize_t openssl_write(neo4j_iostream_t *self, const void *buf, size_t nbyte)
     }
     // TODO: check if BIO_write sets errno on error
     int len = (nbyte < INT_MAX)? nbyte : INT_MAX;
-    return BIO_write(ios->bio, buf, len);
+    return retry_result(ios, BIO_write(ios->bio, buf, len));
 }
 
 
@@ -221,10 +279,26 @@ ssize_t openssl_writev(neo4j_iostream_t *self,
         return -1;
     }
     // TODO: check if BIO_write sets errno on error
-    // TODO: if iovcnt > 1, this will always be a short write, so instead
-    // consider reading entire vector
-    int len = (iov[0].iov_len < INT_MAX)? iov[0].iov_len : INT_MAX;
-    return BIO_write(ios->bio, iov[0].iov_base, len);
+    ssize_t total = 0;
+    for (unsigned int i = 0; i < iovcnt; ++i)
+    {
+        if (iov[i].iov_len == 0)
+        {
+            continue;
+        }
+        int len = (iov[i].iov_len < INT_MAX)? iov[i].iov_len : INT_MAX;
+        int result = BIO_write(ios->bio, iov[i].iov_base, len);
+        if (result <= 0)
+        {
+            return (total > 0)? total : retry_result(ios, result);
+        }
+        total += result;
+        if ((size_t)result < iov[i].iov_len)
+        {
+            break;
+        }
+    }
+    return total;
 }
 
 
@@ -252,10 +326,44 @@ int openssl_close(neo4j_iostream_t *self)
     }
     BIO_free_all(ios->bio);
     ios->bio = NULL;
-    neo4j_ios_close(ios->delegate);
-    ios->delegate = NULL;
+    int result = 0;
+    if (ios->delegate != NULL)
+    {
+        result = neo4j_ios_close(ios->delegate);
+        ios->delegate = NULL;
+    }
+    else
+    {
+        result = close(ios->fd);
+    }
     free(ios);
-    return 0;
+    return result;
+}
+
+
+int openssl_fileno(neo4j_iostream_t *self)
+{
+    struct openssl_iostream *ios = container_of(self,
+            struct openssl_iostream, _iostream);
+    if (ios->bio == NULL)
+    {
+        errno = EPIPE;
+        return -1;
+    }
+    return (ios->delegate != NULL)? neo4j_ios_fileno(ios->delegate) : ios->fd;
+}
+
+
+ssize_t retry_result(struct openssl_iostream *ios, int result)
+{
+    // on a non-blocking socket, the TLS layer may need to read or write
+    // before the operation can be completed
+    if (result <= 0 && BIO_should_retry(ios->bio))
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+    return result;
 }
 
 
@@ -267,8 +375,13 @@ int iostream_bio_write(BIO *bio, const char *buf, int nbyte)
         errno = EPIPE;
         return -1;
     }
+    BIO_clear_retry_flags(bio);
     ssize_t result = neo4j_ios_write(ios, buf, nbyte);
     assert(result < INT_MAX);
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        BIO_set_retry_write(bio);
+    }
     return result;
 }
 
@@ -281,8 +394,13 @@ int iostream_bio_read(BIO *bio, char *buf, int nbyte)
         errno = EPIPE;
         return -1;
     }
+    BIO_clear_retry_flags(bio);
     ssize_t result = neo4j_ios_read(ios, buf, nbyte);
     assert(result < INT_MAX);
+    if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+        BIO_set_retry_read(bio);
+    }
     return result;
 }
 
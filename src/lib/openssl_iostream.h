@@ -53,4 +53,25 @@ neo4j_iostream_t *neo4j_openssl_iostream(neo4j_iostream_t *delegate,
         const char *hostname, int port,
         const neo4j_config_t *config, uint_fast32_t flags);
 
+/**
+ * Create an iostream for an OpenSSL BIO bound directly to a socket.
+ *
+ * Avoids passing ciphertext through another iostream when the transport is
+ * a plain socket. On success, the iostream takes ownership of the socket
+ * and will close it when the iostream is closed.
+ *
+ * @internal
+ *
+ * @param [fd] The connected socket to establish SSL over.
+ * @param [hostname] The hostname of the server the socket is connected to.
+ * @param [port] The TCP port the socket is connected to.
+ * @param [config] The neo4j client configuration in use for this connection.
+ * @param [flags] A bitmask of flags for controling connections.
+ * @return The SSL iostream, or `NULL` if an error occurred (errno will be set).
+ */
+__neo4j_must_check
+neo4j_iostream_t *neo4j_openssl_socket_iostream(int fd,
+        const char *hostname, int port,
+        const neo4j_config_t *config, uint_fast32_t flags);
+
 #endif/*NEO4J_OPENSSL_IOSTREAM_H*/
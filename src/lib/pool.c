@@ -0,0 +1,348 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "pool.h"
+#include "client_config.h"
+#include "connection.h"
+#include "thread.h"
+#include "util.h"
+#include <assert.h>
+
+#define NO_SLOT UINT32_MAX
+
+static_assert(NEO4J_POOL_AFFINITY_SLOTS == 16,
+        "affinity_slot hashes to 4 bits");
+
+
+static neo4j_connection_t *new_connection(neo4j_pool_t *pool);
+static void top_up(neo4j_pool_t *pool);
+static int put_idle(neo4j_pool_t *pool, neo4j_connection_t *connection);
+static neo4j_connection_t *take_idle(neo4j_pool_t *pool);
+static inline _Atomic(neo4j_connection_t *) *affinity_slot(
+        neo4j_pool_t *pool);
+static void push_slot(_Atomic uint64_t *stack,
+        struct neo4j_pool_slot *slots, uint32_t i);
+static uint32_t pop_slot(_Atomic uint64_t *stack,
+        struct neo4j_pool_slot *slots);
+
+
+neo4j_pool_t *neo4j_new_pool(const char *uri, neo4j_config_t *config,
+        uint_fast32_t flags)
+{
+    REQUIRE(uri != NULL, NULL);
+
+    neo4j_pool_t *pool = calloc(1, sizeof(neo4j_pool_t));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    atomic_init(&(pool->nidle), 0);
+    for (unsigned int i = 0; i < NEO4J_POOL_AFFINITY_SLOTS; ++i)
+    {
+        atomic_init(&(pool->affinity[i]), NULL);
+    }
+    atomic_init(&(pool->idle), 0);
+    atomic_init(&(pool->free), 0);
+
+    pool->config = neo4j_config_dup(config);
+    if (pool->config == NULL)
+    {
+        goto failure;
+    }
+    pool->logger = neo4j_get_logger(pool->config, "pool");
+
+    pool->hostname = neo4j_resolve_uri(uri, pool->config, &(pool->port));
+    if (pool->hostname == NULL)
+    {
+        goto failure;
+    }
+    pool->flags = flags;
+
+    pool->max_idle = pool->config->pool_max_idle;
+    if (pool->max_idle > 0)
+    {
+        pool->slots = calloc(pool->max_idle, sizeof(struct neo4j_pool_slot));
+        if (pool->slots == NULL)
+        {
+            goto failure;
+        }
+    }
+    for (uint32_t i = pool->max_idle; i-- > 0; )
+    {
+        atomic_init(&(pool->slots[i].next), 0);
+        push_slot(&(pool->free), pool->slots, i);
+    }
+
+    pool->min_idle = minu(pool->config->pool_min_idle, pool->max_idle);
+    for (unsigned int i = 0; i < pool->min_idle; ++i)
+    {
+        neo4j_connection_t *connection = new_connection(pool);
+        if (connection == NULL)
+        {
+            goto failure;
+        }
+        if (put_idle(pool, connection))
+        {
+            neo4j_close(connection);
+            goto failure;
+        }
+    }
+
+    neo4j_log_debug(pool->logger, "created pool (%p) for %s:%u",
+            (void *)pool, pool->hostname, pool->port);
+    return pool;
+
+    int errsv;
+failure:
+    errsv = errno;
+    neo4j_pool_free(pool);
+    errno = errsv;
+    return NULL;
+}
+
+
+void neo4j_pool_free(neo4j_pool_t *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    neo4j_connection_t *connection;
+    while ((connection = take_idle(pool)) != NULL)
+    {
+        neo4j_close(connection);
+    }
+
+    free(pool->slots);
+    free(pool->hostname);
+    neo4j_logger_release(pool->logger);
+    neo4j_config_free(pool->config);
+    free(pool);
+}
+
+
+neo4j_connection_t *neo4j_pool_checkout(neo4j_pool_t *pool)
+{
+    REQUIRE(pool != NULL, NULL);
+
+    bool discarded = false;
+    neo4j_connection_t *connection;
+    while ((connection = take_idle(pool)) != NULL)
+    {
+        // idle connections are only validated when checked out
+        if (neo4j_connection_is_usable(connection))
+        {
+            neo4j_log_trace(pool->logger, "checked out %p from pool %p",
+                    (void *)connection, (void *)pool);
+            break;
+        }
+        neo4j_log_debug(pool->logger, "discarding unusable connection %p"
+                " from pool %p", (void *)connection, (void *)pool);
+        neo4j_close(connection);
+        discarded = true;
+    }
+
+    if (connection == NULL)
+    {
+        connection = new_connection(pool);
+    }
+    if (connection != NULL && discarded)
+    {
+        top_up(pool);
+    }
+    return connection;
+}
+
+
+int neo4j_pool_return(neo4j_pool_t *pool, neo4j_connection_t *connection)
+{
+    REQUIRE(pool != NULL, -1);
+    REQUIRE(connection != NULL, -1);
+
+    if (connection->session != NULL)
+    {
+        errno = NEO4J_SESSION_ACTIVE;
+        return -1;
+    }
+
+    // a connection is closed when a session on it fails
+    if (connection->iostream == NULL)
+    {
+        neo4j_log_debug(pool->logger, "closing failed connection %p"
+                " returned to pool %p", (void *)connection, (void *)pool);
+        int result = neo4j_close(connection);
+        int errsv = errno;
+        top_up(pool);
+        errno = errsv;
+        return result;
+    }
+    if (put_idle(pool, connection))
+    {
+        neo4j_log_trace(pool->logger, "closing %p returned to pool %p",
+                (void *)connection, (void *)pool);
+        return neo4j_close(connection);
+    }
+
+    neo4j_log_trace(pool->logger, "returned %p to pool %p",
+            (void *)connection, (void *)pool);
+    return 0;
+}
+
+
+neo4j_connection_t *new_connection(neo4j_pool_t *pool)
+{
+    neo4j_config_t *config = neo4j_config_dup(pool->config);
+    if (config == NULL)
+    {
+        return NULL;
+    }
+
+    neo4j_connection_t *connection = neo4j_establish_connection(
+            pool->hostname, pool->port, config, pool->flags);
+    if (connection == NULL)
+    {
+        int errsv = errno;
+        neo4j_config_free(config);
+        errno = errsv;
+        return NULL;
+    }
+
+    neo4j_log_debug(pool->logger, "added %p to pool %p",
+            (void *)connection, (void *)pool);
+    return connection;
+}
+
+
+void top_up(neo4j_pool_t *pool)
+{
+    // replaces idle connections found to be unusable
+    while (atomic_load(&(pool->nidle)) < pool->min_idle)
+    {
+        neo4j_connection_t *connection = new_connection(pool);
+        if (connection == NULL)
+        {
+            neo4j_log_debug_errno(pool->logger,
+                    "failed to replace idle connection");
+            return;
+        }
+        if (put_idle(pool, connection))
+        {
+            neo4j_close(connection);
+            return;
+        }
+    }
+}
+
+
+int put_idle(neo4j_pool_t *pool, neo4j_connection_t *connection)
+{
+    if (atomic_fetch_add(&(pool->nidle), 1) >= pool->max_idle)
+    {
+        atomic_fetch_sub(&(pool->nidle), 1);
+        return -1;
+    }
+
+    // prefer reuse by the same thread, as its buffers are likely warm
+    neo4j_connection_t *expected = NULL;
+    if (atomic_compare_exchange_strong(affinity_slot(pool),
+                &expected, connection))
+    {
+        return 0;
+    }
+
+    // a slot is always free, as slots in use never exceed nidle
+    uint32_t i = pop_slot(&(pool->free), pool->slots);
+    assert(i != NO_SLOT);
+    pool->slots[i].connection = connection;
+    push_slot(&(pool->idle), pool->slots, i);
+    return 0;
+}
+
+
+neo4j_connection_t *take_idle(neo4j_pool_t *pool)
+{
+    neo4j_connection_t *connection =
+        atomic_exchange(affinity_slot(pool), NULL);
+
+    if (connection == NULL)
+    {
+        uint32_t i = pop_slot(&(pool->idle), pool->slots);
+        if (i != NO_SLOT)
+        {
+            connection = pool->slots[i].connection;
+            pool->slots[i].connection = NULL;
+            push_slot(&(pool->free), pool->slots, i);
+        }
+    }
+
+    // otherwise, take a connection last used by another thread
+    for (unsigned int i = 0;
+            connection == NULL && i < NEO4J_POOL_AFFINITY_SLOTS; ++i)
+    {
+        if (atomic_load(&(pool->affinity[i])) != NULL)
+        {
+            connection = atomic_exchange(&(pool->affinity[i]), NULL);
+        }
+    }
+
+    if (connection != NULL)
+    {
+        atomic_fetch_sub(&(pool->nidle), 1);
+    }
+    return connection;
+}
+
+
+_Atomic(neo4j_connection_t *) *affinity_slot(neo4j_pool_t *pool)
+{
+    uint64_t id = neo4j_current_thread_id();
+    // fibonacci hashing, using the upper bits of the product
+    unsigned int i = (id * UINT64_C(11400714819323198485)) >> 60;
+    return &(pool->affinity[i]);
+}
+
+
+void push_slot(_Atomic uint64_t *stack, struct neo4j_pool_slot *slots,
+        uint32_t i)
+{
+    uint64_t head = atomic_load(stack);
+    uint64_t nhead;
+    do
+    {
+        atomic_store(&(slots[i].next), (uint32_t)head);
+        nhead = (((head >> 32) + 1) << 32) | (i + 1);
+    } while (!atomic_compare_exchange_weak(stack, &head, nhead));
+}
+
+
+uint32_t pop_slot(_Atomic uint64_t *stack, struct neo4j_pool_slot *slots)
+{
+    uint64_t head = atomic_load(stack);
+    uint64_t nhead;
+    do
+    {
+        uint32_t top = (uint32_t)head;
+        if (top == 0)
+        {
+            return NO_SLOT;
+        }
+        nhead = (((head >> 32) + 1) << 32) | atomic_load(&(slots[top-1].next));
+    } while (!atomic_compare_exchange_weak(stack, &head, nhead));
+    return (uint32_t)head - 1;
+}
@@ -0,0 +1,56 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NEO4J_POOL_H
+#define NEO4J_POOL_H
+
+#include "neo4j-client.h"
+#include "logging.h"
+#include <stdatomic.h>
+
+#define NEO4J_POOL_AFFINITY_SLOTS 16
+
+struct neo4j_pool_slot
+{
+    neo4j_connection_t *connection;
+    _Atomic uint32_t next;
+};
+
+struct neo4j_pool
+{
+    neo4j_config_t *config;
+    neo4j_logger_t *logger;
+
+    char *hostname;
+    unsigned int port;
+    uint_fast32_t flags;
+
+    unsigned int min_idle;
+    unsigned int max_idle;
+    atomic_uint nidle;
+
+    // the connection most recently returned by each thread, hashed by
+    // thread id
+    _Atomic(neo4j_connection_t *) affinity[NEO4J_POOL_AFFINITY_SLOTS];
+
+    // stacks of slot indices (offset by 1), tagged with a counter in the
+    // upper 32 bits to avoid ABA
+    struct neo4j_pool_slot *slots;
+    _Atomic uint64_t idle;
+    _Atomic uint64_t free;
+};
+
+#endif/*NEO4J_POOL_H*/
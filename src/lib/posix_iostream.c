@@ -38,6 +38,7 @@ static ssize_t neo4j_posix_writev(neo4j_iostream_t *self,
         const struct iovec *iov, unsigned int iovcnt);
 static int neo4j_posix_flush(neo4j_iostream_t *self);
 static int neo4j_posix_close(neo4j_iostream_t *self);
+static int neo4j_posix_fileno(neo4j_iostream_t *self);
 
 
 neo4j_iostream_t *neo4j_posix_iostream(int fd)
@@ -60,6 +61,7 @@ neo4j_iostream_t *neo4j_posix_iostream(int fd)
     iostream->writev = neo4j_posix_writev;
     iostream->flush = neo4j_posix_flush;
     iostream->close = neo4j_posix_close;
+    iostream->fileno = neo4j_posix_fileno;
     return iostream;
 }
 
@@ -146,3 +148,16 @@ int neo4j_posix_close(neo4j_iostream_t *self)
     free(ios);
     return close(fd);
 }
+
+
+int neo4j_posix_fileno(neo4j_iostream_t *self)
+{
+    struct neo4j_posix_iostream *ios = container_of(self,
+            struct neo4j_posix_iostream, _iostream);
+    if (ios->fd < 0)
+    {
+        errno = EPIPE;
+        return -1;
+    }
+    return ios->fd;
+}
@@ -30,10 +30,8 @@ static size_t string_str(char *buf, size_t n, char quot, const char *s,
         size_t len);
 static ssize_t string_fprint(FILE *stream, char quot, const char *s,
         size_t len);
-static size_t list_str(char *buf, size_t n, const neo4j_value_t *values,
-        unsigned int nvalues);
-static ssize_t list_fprint(const neo4j_value_t *values, unsigned int nvalues,
-        FILE *stream);
+static size_t list_str(char *buf, size_t n, const struct neo4j_list *list);
+static ssize_t list_fprint(const struct neo4j_list *list, FILE *stream);
 
 
 /* null */
@@ -151,7 +149,7 @@ size_t neo4j_string_str(const neo4j_value_t *value, char *buf, size_t n)
     REQUIRE(n == 0 || buf != NULL, -1);
     assert(neo4j_type(*value) == NEO4J_STRING);
     const struct neo4j_string *v = (const struct neo4j_string *)value;
-    return string_str(buf, n, '"', (const char *)v->ustring, v->length);
+    return string_str(buf, n, '"', neo4j_string_content(v), v->length);
 }
 
 
@@ -160,7 +158,7 @@ ssize_t neo4j_string_fprint(const neo4j_value_t *value, FILE *stream)
     REQUIRE(value != NULL, -1);
     assert(neo4j_type(*value) == NEO4J_STRING);
     const struct neo4j_string *v = (const struct neo4j_string *)value;
-    return string_fprint(stream, '"', (const char *)v->ustring, v->length);
+    return string_fprint(stream, '"', neo4j_string_content(v), v->length);
 }
 
 
@@ -168,7 +166,7 @@ size_t identifier_str(char *buf, size_t n, const neo4j_value_t *value)
 {
     assert(neo4j_type(*value) == NEO4J_STRING);
     const struct neo4j_string *v = (const struct neo4j_string *)value;
-    const char *s = (const char *)v->ustring;
+    const char *s = neo4j_string_content(v);
 
     if (memspn_ident(s, v->length) < v->length)
     {
@@ -189,7 +187,7 @@ ssize_t identifier_fprint(const neo4j_value_t *value, FILE *stream)
 {
     assert(neo4j_type(*value) == NEO4J_STRING);
     const struct neo4j_string *v = (const struct neo4j_string *)value;
-    const char *s = (const char *)v->ustring;
+    const char *s = neo4j_string_content(v);
 
     if (memspn_ident(s, v->length) < v->length)
     {
@@ -315,7 +313,7 @@ size_t neo4j_list_str(const neo4j_value_t *value, char *buf, size_t n)
     }
     size_t l = 1;
 
-    l += list_str(buf+l, (l < n)? n-l : 0, v->items, v->length);
+    l += list_str(buf+l, (l < n)? n-l : 0, v);
 
     if ((l+1) < n)
     {
@@ -341,7 +339,7 @@ ssize_t neo4j_list_fprint(const neo4j_value_t *value, FILE *stream)
         return -1;
     }
 
-    ssize_t l = list_fprint(v->items, v->length, stream);
+    ssize_t l = list_fprint(v, stream);
     if (l < 0)
     {
         return -1;
@@ -356,15 +354,15 @@ ssize_t neo4j_list_fprint(const neo4j_value_t *value, FILE *stream)
 }
 
 
-size_t list_str(char *buf, size_t n, const neo4j_value_t *values,
-        unsigned int nvalues)
+size_t list_str(char *buf, size_t n, const struct neo4j_list *list)
 {
     size_t l = 0;
-    for (unsigned int i = 0; i < nvalues; ++i)
+    for (unsigned int i = 0; i < list->length; ++i)
     {
-        l += neo4j_ntostring(values[i], buf+l, (l < n)? n-l : 0);
+        l += neo4j_ntostring(neo4j_list_item(list, i), buf+l,
+                (l < n)? n-l : 0);
 
-        if ((i+1) < nvalues)
+        if ((i+1) < list->length)
         {
             if ((l+1) < n)
             {
@@ -377,20 +375,19 @@ size_t list_str(char *buf, size_t n, const neo4j_value_t *values,
 }
 
 
-ssize_t list_fprint(const neo4j_value_t *values, unsigned int nvalues,
-        FILE *stream)
+ssize_t list_fprint(const struct neo4j_list *list, FILE *stream)
 {
     size_t l = 0;
-    for (unsigned int i = 0; i < nvalues; ++i)
+    for (unsigned int i = 0; i < list->length; ++i)
     {
-        ssize_t ll = neo4j_fprint(values[i], stream);
+        ssize_t ll = neo4j_fprint(neo4j_list_item(list, i), stream);
         if (ll < 0)
         {
             return -1;
         }
         l += (size_t)ll;
 
-        if ((i+1) < nvalues)
+        if ((i+1) < list->length)
         {
             if (fputc(',', stream) == EOF)
             {
@@ -878,7 +875,9 @@ size_t neo4j_struct_str(const neo4j_value_t *value, char *buf, size_t n)
     }
     l++;
 
-    l += list_str(buf+l, (l < n)? n-l : 0, v->fields, v->nfields);
+    neo4j_value_t fields = neo4j_list(v->fields, v->nfields);
+    l += list_str(buf+l, (l < n)? n-l : 0,
+            (const struct neo4j_list *)&fields);
 
     if ((l+1) < n)
     {
@@ -912,7 +911,8 @@ ssize_t neo4j_struct_fprint(const neo4j_value_t *value, FILE *stream)
     }
     size_t l = (size_t)hlen + 1;
 
-    ssize_t ll =  list_fprint(v->fields, v->nfields, stream);
+    neo4j_value_t fields = neo4j_list(v->fields, v->nfields);
+    ssize_t ll = list_fprint((const struct neo4j_list *)&fields, stream);
     if (ll < 0)
     {
         return -1;
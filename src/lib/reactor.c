@@ -0,0 +1,383 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "reactor.h"
+#include "util.h"
+#include <assert.h>
+#include <unistd.h>
+
+
+static struct neo4j_reactor_entry *find_entry(neo4j_reactor_t *reactor,
+        neo4j_session_t *session, unsigned int *index);
+static int update_interest(neo4j_reactor_t *reactor);
+static int set_interest(neo4j_reactor_t *reactor,
+        struct neo4j_reactor_entry *entry, int events);
+static int reserve_ready(neo4j_reactor_t *reactor);
+static int wait_and_process(neo4j_reactor_t *reactor, int timeout);
+static void process(struct neo4j_reactor_entry *entry);
+
+
+neo4j_reactor_t *neo4j_new_reactor(void)
+{
+    neo4j_reactor_t *reactor = calloc(1, sizeof(neo4j_reactor_t));
+    if (reactor == NULL)
+    {
+        return NULL;
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    reactor->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (reactor->epfd < 0)
+    {
+        int errsv = errno;
+        free(reactor);
+        errno = errsv;
+        return NULL;
+    }
+#endif
+    return reactor;
+}
+
+
+void neo4j_reactor_free(neo4j_reactor_t *reactor)
+{
+    if (reactor == NULL)
+    {
+        return;
+    }
+    assert(!reactor->polling);
+
+    for (unsigned int i = 0; i < reactor->nentries; ++i)
+    {
+        free(reactor->entries[i]);
+    }
+    free(reactor->entries);
+#ifdef HAVE_SYS_EPOLL_H
+    close(reactor->epfd);
+    free(reactor->ready);
+#else
+    free(reactor->pollfds);
+    free(reactor->polled);
+#endif
+    free(reactor);
+}
+
+
+int neo4j_reactor_add(neo4j_reactor_t *reactor, neo4j_session_t *session)
+{
+    REQUIRE(reactor != NULL, -1);
+    REQUIRE(session != NULL, -1);
+
+    if (find_entry(reactor, session, NULL) != NULL)
+    {
+        errno = EEXIST;
+        return -1;
+    }
+
+    if (neo4j_session_set_nonblocking(session))
+    {
+        return -1;
+    }
+    int fd = neo4j_session_fd(session);
+    if (fd < 0)
+    {
+        return -1;
+    }
+
+    if (reactor->nentries >= reactor->entries_size)
+    {
+        unsigned int nsize = (reactor->entries_size > 0)?
+            reactor->entries_size * 2 : 8;
+        struct neo4j_reactor_entry **entries = realloc(reactor->entries,
+                nsize * sizeof(struct neo4j_reactor_entry *));
+        if (entries == NULL)
+        {
+            return -1;
+        }
+        reactor->entries = entries;
+        reactor->entries_size = nsize;
+    }
+
+    struct neo4j_reactor_entry *entry =
+        calloc(1, sizeof(struct neo4j_reactor_entry));
+    if (entry == NULL)
+    {
+        return -1;
+    }
+    entry->session = session;
+    entry->fd = fd;
+
+    if (set_interest(reactor, entry, neo4j_session_events(session)))
+    {
+        int errsv = errno;
+        free(entry);
+        errno = errsv;
+        return -1;
+    }
+
+    reactor->entries[reactor->nentries] = entry;
+    (reactor->nentries)++;
+    return 0;
+}
+
+
+int neo4j_reactor_remove(neo4j_reactor_t *reactor, neo4j_session_t *session)
+{
+    REQUIRE(reactor != NULL, -1);
+    REQUIRE(session != NULL, -1);
+    REQUIRE(!reactor->polling, -1);
+
+    unsigned int index;
+    struct neo4j_reactor_entry *entry = find_entry(reactor, session, &index);
+    if (entry == NULL)
+    {
+        errno = ENOENT;
+        return -1;
+    }
+
+    int result = set_interest(reactor, entry, 0);
+    int errsv = errno;
+    (reactor->nentries)--;
+    reactor->entries[index] = reactor->entries[reactor->nentries];
+    free(entry);
+    errno = errsv;
+    return result;
+}
+
+
+int neo4j_reactor_poll(neo4j_reactor_t *reactor, int timeout)
+{
+    REQUIRE(reactor != NULL, -1);
+    REQUIRE(!reactor->polling, -1);
+
+    // requests may have been made in any session since the last poll
+    if (update_interest(reactor))
+    {
+        return -1;
+    }
+    if (reactor->npending == 0)
+    {
+        return 0;
+    }
+    if (reserve_ready(reactor))
+    {
+        return -1;
+    }
+
+    reactor->polling = true;
+    int result = wait_and_process(reactor, timeout);
+    reactor->polling = false;
+    if (result < 0 || update_interest(reactor))
+    {
+        return -1;
+    }
+    return reactor->npending;
+}
+
+
+struct neo4j_reactor_entry *find_entry(neo4j_reactor_t *reactor,
+        neo4j_session_t *session, unsigned int *index)
+{
+    for (unsigned int i = 0; i < reactor->nentries; ++i)
+    {
+        if (reactor->entries[i]->session == session)
+        {
+            if (index != NULL)
+            {
+                *index = i;
+            }
+            return reactor->entries[i];
+        }
+    }
+    return NULL;
+}
+
+
+int update_interest(neo4j_reactor_t *reactor)
+{
+    for (unsigned int i = 0; i < reactor->nentries; ++i)
+    {
+        struct neo4j_reactor_entry *entry = reactor->entries[i];
+        if (set_interest(reactor, entry, neo4j_session_events(entry->session)))
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+int set_interest(neo4j_reactor_t *reactor, struct neo4j_reactor_entry *entry,
+        int events)
+{
+    if (events < 0)
+    {
+        events = 0;
+    }
+    if (events == entry->events)
+    {
+        return 0;
+    }
+
+#ifdef HAVE_SYS_EPOLL_H
+    // idle sessions are not polled at all, so that a hangup on an idle
+    // connection does not repeatedly wake the reactor
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.data.ptr = entry;
+    if (events & NEO4J_SESSION_WANT_READ)
+    {
+        event.events |= EPOLLIN;
+    }
+    if (events & NEO4J_SESSION_WANT_WRITE)
+    {
+        event.events |= EPOLLOUT;
+    }
+    int op = (entry->events == 0)? EPOLL_CTL_ADD :
+        (events == 0)? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+    if (epoll_ctl(reactor->epfd, op, entry->fd, &event))
+    {
+        return -1;
+    }
+#endif
+
+    if (entry->events == 0)
+    {
+        (reactor->npending)++;
+    }
+    else if (events == 0)
+    {
+        assert(reactor->npending > 0);
+        (reactor->npending)--;
+    }
+    entry->events = events;
+    return 0;
+}
+
+
+int reserve_ready(neo4j_reactor_t *reactor)
+{
+    if (reactor->ready_size >= reactor->nentries)
+    {
+        return 0;
+    }
+    unsigned int nsize = reactor->entries_size;
+    assert(nsize >= reactor->nentries);
+
+#ifdef HAVE_SYS_EPOLL_H
+    struct epoll_event *ready = realloc(reactor->ready,
+            nsize * sizeof(struct epoll_event));
+    if (ready == NULL)
+    {
+        return -1;
+    }
+    reactor->ready = ready;
+#else
+    struct pollfd *pollfds = realloc(reactor->pollfds,
+            nsize * sizeof(struct pollfd));
+    if (pollfds == NULL)
+    {
+        return -1;
+    }
+    reactor->pollfds = pollfds;
+    struct neo4j_reactor_entry **polled = realloc(reactor->polled,
+            nsize * sizeof(struct neo4j_reactor_entry *));
+    if (polled == NULL)
+    {
+        return -1;
+    }
+    reactor->polled = polled;
+#endif
+    reactor->ready_size = nsize;
+    return 0;
+}
+
+
+#ifdef HAVE_SYS_EPOLL_H
+int wait_and_process(neo4j_reactor_t *reactor, int timeout)
+{
+    int n = epoll_wait(reactor->epfd, reactor->ready, reactor->ready_size,
+            timeout);
+    if (n < 0)
+    {
+        // an interrupted wait is reported as no events
+        return (errno == EINTR)? 0 : -1;
+    }
+
+    for (int i = 0; i < n; ++i)
+    {
+        process((struct neo4j_reactor_entry *)reactor->ready[i].data.ptr);
+    }
+    return 0;
+}
+#else
+int wait_and_process(neo4j_reactor_t *reactor, int timeout)
+{
+    // sessions added whilst processing are not polled until the next call
+    unsigned int npolled = 0;
+    for (unsigned int i = 0; i < reactor->nentries; ++i)
+    {
+        struct neo4j_reactor_entry *entry = reactor->entries[i];
+        if (entry->events == 0)
+        {
+            continue;
+        }
+        struct pollfd *pfd = &(reactor->pollfds[npolled]);
+        pfd->fd = entry->fd;
+        pfd->events = 0;
+        pfd->revents = 0;
+        if (entry->events & NEO4J_SESSION_WANT_READ)
+        {
+            pfd->events |= POLLIN;
+        }
+        if (entry->events & NEO4J_SESSION_WANT_WRITE)
+        {
+            pfd->events |= POLLOUT;
+        }
+        reactor->polled[npolled] = entry;
+        ++npolled;
+    }
+
+    int n = poll(reactor->pollfds, npolled, timeout);
+    if (n < 0)
+    {
+        // an interrupted wait is reported as no events
+        return (errno == EINTR)? 0 : -1;
+    }
+
+    for (unsigned int i = 0; n > 0 && i < npolled; ++i)
+    {
+        if (reactor->pollfds[i].revents != 0)
+        {
+            process(reactor->polled[i]);
+            --n;
+        }
+    }
+    return 0;
+}
+#endif
+
+
+void process(struct neo4j_reactor_entry *entry)
+{
+    if (neo4j_session_process(entry->session))
+    {
+        // the session has failed, and its outstanding requests have been
+        // completed with the failure, so it will no longer be polled
+        assert(neo4j_session_events(entry->session) == 0);
+    }
+}
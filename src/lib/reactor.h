@@ -0,0 +1,54 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NEO4J_REACTOR_H
+#define NEO4J_REACTOR_H
+
+#include "neo4j-client.h"
+#ifdef HAVE_SYS_EPOLL_H
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+struct neo4j_reactor_entry
+{
+    neo4j_session_t *session;
+    int fd;
+    // the events the descriptor is currently polled for, if any
+    int events;
+};
+
+struct neo4j_reactor
+{
+    struct neo4j_reactor_entry **entries;
+    unsigned int nentries;
+    unsigned int entries_size;
+    // the number of sessions awaiting events
+    unsigned int npending;
+    bool polling;
+
+#ifdef HAVE_SYS_EPOLL_H
+    int epfd;
+    struct epoll_event *ready;
+#else
+    struct pollfd *pollfds;
+    struct neo4j_reactor_entry **polled;
+#endif
+    unsigned int ready_size;
+};
+
+#endif/*NEO4J_REACTOR_H*/
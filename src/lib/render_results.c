@@ -371,7 +371,7 @@ int write_value(FILE *stream, const neo4j_value_t *value,
 
     if (type == NEO4J_STRING)
     {
-        return write_quoted_string(stream, neo4j_ustring_value(*value),
+        return write_quoted_string(stream, neo4j_ustring_pointer(value),
                 neo4j_string_length(*value), '"');
     }
 
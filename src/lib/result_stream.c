@@ -17,10 +17,14 @@
 #include "../../config.h"
 #include "result_stream.h"
 #include "client_config.h"
+#include "deserialization.h"
 #include "job.h"
 #include "metadata.h"
 #include "session.h"
+#include "spsc_queue.h"
+#include "thread.h"
 #include "util.h"
+#include "worker_pool.h"
 #include <assert.h>
 #include <stddef.h>
 
@@ -69,6 +73,15 @@ const char *neo4j_fieldname(neo4j_result_stream_t *results,
 }
 
 
+int neo4j_set_projection(neo4j_result_stream_t *results,
+        const unsigned int *field_indices, unsigned int n)
+{
+    REQUIRE(results != NULL, -1);
+    REQUIRE(field_indices != NULL || n == 0, -1);
+    return results->set_projection(results, field_indices, n);
+}
+
+
 neo4j_result_t *neo4j_fetch_next(neo4j_result_stream_t *results)
 {
     REQUIRE(results != NULL, NULL);
@@ -103,6 +116,18 @@ struct neo4j_update_counts neo4j_update_counts(neo4j_result_stream_t *results)
 }
 
 
+struct neo4j_intern_stats neo4j_intern_stats(neo4j_result_stream_t *results)
+{
+    if (results == NULL || results->intern_stats == NULL)
+    {
+        struct neo4j_intern_stats stats;
+        memset(&stats, 0, sizeof(stats));
+        return stats;
+    }
+    return results->intern_stats(results);
+}
+
+
 int neo4j_close_results(neo4j_result_stream_t *results)
 {
     REQUIRE(results != NULL, -1);
@@ -110,6 +135,13 @@ int neo4j_close_results(neo4j_result_stream_t *results)
 }
 
 
+int neo4j_cancel_results(neo4j_result_stream_t *results)
+{
+    REQUIRE(results != NULL, -1);
+    return results->cancel(results);
+}
+
+
 neo4j_value_t neo4j_result_field(const neo4j_result_t *result,
         unsigned int index)
 {
@@ -143,6 +175,24 @@ struct result_record
     unsigned int refcount;
     neo4j_mpool_t mpool;
     neo4j_value_t list;
+    // when decoding lazily, the field values (backing the list) and the
+    // position of each field not yet decoded
+    neo4j_value_t *fields;
+    const uint8_t **encoded;
+    const uint8_t *encoded_end;
+    bool borrow_strings;
+    bool inline_strings;
+    // the table holding any strings interned in the record
+    neo4j_intern_table_t *interns;
+    // when decoded by a worker, the pool it was submitted to, the encoded
+    // list (ending at encoded_end) and any error decoding it
+    neo4j_work_t decoding;
+    neo4j_worker_pool_t *workers;
+    const uint8_t *encoded_list;
+    int decode_error;
+    // the stream, whilst the record is the last fetched from it, so that a
+    // failure decoding a field can fail the stream
+    run_result_stream_t *results;
     result_record_t *next;
 };
 
@@ -157,9 +207,29 @@ struct run_result_stream
     neo4j_memory_allocator_t *allocator;
     neo4j_mpool_t mpool;
     neo4j_mpool_t record_mpool;
+    size_t record_mpool_cache_size;
     unsigned int refcount;
     unsigned int starting;
     unsigned int streaming;
+    // when batched, records are pulled in batches as they are fetched
+    bool batched;
+    // when cancelled, the server has been sent a RESET to interrupt the
+    // statement
+    bool cancelled;
+    // when asynchronous, records are delivered to a callback as they are
+    // received, and the stream is closed once complete
+    bool async;
+    neo4j_record_callback_t on_record;
+    neo4j_results_callback_t on_complete;
+    void *userdata;
+    bool lazy_records;
+    bool borrow_strings;
+    bool inline_strings;
+    neo4j_intern_table_t *interns;
+    // when projecting, fields at indices not flagged are skipped
+    bool projecting;
+    bool *projection;
+    unsigned int projection_length;
     int statement_type;
     struct neo4j_statement_plan *statement_plan;
     struct neo4j_update_counts update_counts;
@@ -171,6 +241,11 @@ struct run_result_stream
     result_record_t *records_tail;
     result_record_t *last_fetched;
     unsigned int awaiting_records;
+    // when reading ahead, records are received in another thread and passed
+    // through the queue, until the session is reclaimed
+    neo4j_spsc_queue_t *read_ahead;
+    neo4j_thread_t reader;
+    unsigned int reading;
 };
 
 
@@ -183,32 +258,76 @@ const struct neo4j_failure_details *run_rs_failure_details(
 static unsigned int run_rs_nfields(neo4j_result_stream_t *results);
 static const char *run_rs_fieldname(neo4j_result_stream_t *self,
         unsigned int index);
+static int run_rs_set_projection(neo4j_result_stream_t *self,
+        const unsigned int *field_indices, unsigned int n);
 static neo4j_result_t *run_rs_fetch_next(neo4j_result_stream_t *self);
 static int run_rs_statement_type(neo4j_result_stream_t *self);
 static struct neo4j_statement_plan *run_rs_statement_plan(
         neo4j_result_stream_t *self);
 static struct neo4j_update_counts run_rs_update_counts(
         neo4j_result_stream_t *self);
+static struct neo4j_intern_stats run_rs_intern_stats(
+        neo4j_result_stream_t *self);
 static int run_rs_close(neo4j_result_stream_t *self);
+static int run_rs_cancel(neo4j_result_stream_t *self);
 
 static neo4j_value_t run_result_field(const neo4j_result_t *self,
         unsigned int index);
 static neo4j_result_t *run_result_retain(neo4j_result_t *self);
 static void run_result_release(neo4j_result_t *self);
 
+struct run_each
+{
+    neo4j_record_callback_t on_record;
+    void *userdata;
+    unsigned int running;
+    int failure;
+};
+
+static int run_each_record(void *userdata, neo4j_value_t fields);
+static void run_each_complete(void *userdata, neo4j_result_stream_t *results);
+static run_result_stream_t *run_rs_start(neo4j_session_t *session,
+        const char *statement, neo4j_value_t params, unsigned int fetch_size);
 static void notify_session_ending(neo4j_job_t *job);
+static void release_session(neo4j_job_t *job);
+static int start_read_ahead(run_result_stream_t *results);
+static void *read_ahead(void *data);
+static inline void stop_read_ahead(run_result_stream_t *results);
 static int run_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc);
 static int pull_all_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc);
+static int pull_all_response(run_result_stream_t *results,
+        neo4j_message_type_t type, const neo4j_value_t *argv, uint16_t argc);
+static void complete_async(run_result_stream_t *results);
+static int batch_end(run_result_stream_t *results,
+        const neo4j_value_t *argv, uint16_t argc);
+static int pull_all_record_callback(void *cdata, const uint8_t *record,
+        size_t length, uint16_t argc);
 static int discard_all_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc);
 static int stream_end(run_result_stream_t *results, neo4j_message_type_t type,
         const char *src_message_type, const neo4j_value_t *argv, uint16_t argc);
 static int await(run_result_stream_t *results, const unsigned int *condition);
 static int append_result(run_result_stream_t *results,
-        const neo4j_value_t *argv, uint16_t argc);
+        const uint8_t *data, size_t length, uint16_t argc);
+static int deliver_record(run_result_stream_t *results,
+        const uint8_t *data, size_t length);
+static void recycle_record_mpool(run_result_stream_t *results);
+static int decode_projected_fields(run_result_stream_t *results,
+        result_record_t *record, const uint8_t *data, const uint8_t *end);
+static inline bool is_projected(const run_result_stream_t *results,
+        unsigned int index);
+static int index_fields(run_result_stream_t *results, result_record_t *record,
+        const uint8_t *data, const uint8_t *end);
+static int decode_field(result_record_t *record, unsigned int index);
+static void decode_record(neo4j_work_t *work);
+static void set_decode_failure(run_result_stream_t *results, int error);
+static int await_decoded(run_result_stream_t *results,
+        result_record_t *record);
 void result_record_release(result_record_t *record);
+static void recycle_record(run_result_stream_t *results,
+        result_record_t *record);
 static int set_eval_failure(run_result_stream_t *results,
         const char *src_message_type, const neo4j_value_t *argv, uint16_t argc);
 static void set_failure(run_result_stream_t *results, int error);
@@ -220,7 +339,99 @@ neo4j_result_stream_t *neo4j_run(neo4j_session_t *session,
     REQUIRE(session != NULL, NULL);
     REQUIRE(statement != NULL, NULL);
     REQUIRE(neo4j_type(params) == NEO4J_MAP || neo4j_is_null(params), NULL);
+    neo4j_config_t *config = neo4j_session_config(session);
+    neo4j_session_reclaim(session);
 
+    // from version 4, records can be pulled in batches, except within
+    // an explicit transaction, where pulling all records allows the
+    // statements that follow to be pipelined
+    unsigned int fetch_size = (session->connection->version >= 4 &&
+            !session->in_transaction)? config->fetch_size : 0;
+
+    run_result_stream_t *results = run_rs_start(session, statement, params,
+            fetch_size);
+    return (results != NULL)? &(results->_result_stream) : NULL;
+}
+
+
+int neo4j_run_async(neo4j_session_t *session, const char *statement,
+        neo4j_value_t params, neo4j_record_callback_t on_record,
+        neo4j_results_callback_t on_complete, void *userdata)
+{
+    REQUIRE(session != NULL, -1);
+    REQUIRE(statement != NULL, -1);
+    REQUIRE(neo4j_type(params) == NEO4J_MAP || neo4j_is_null(params), -1);
+
+    // records are not held, so there is no need to pull them in batches
+    run_result_stream_t *results = run_rs_start(session, statement, params, 0);
+    if (results == NULL)
+    {
+        return -1;
+    }
+    results->async = true;
+    results->on_record = on_record;
+    results->on_complete = on_complete;
+    results->userdata = userdata;
+    return 0;
+}
+
+
+int neo4j_run_each(neo4j_session_t *session, const char *statement,
+        neo4j_value_t params, neo4j_record_callback_t on_record,
+        void *userdata)
+{
+    REQUIRE(on_record != NULL, -1);
+
+    struct run_each each =
+        { .on_record = on_record, .userdata = userdata, .running = 1 };
+    if (neo4j_run_async(session, statement, params, run_each_record,
+            run_each_complete, &each))
+    {
+        return -1;
+    }
+
+    while (each.running > 0)
+    {
+        if (neo4j_session_sync(session, &(each.running)))
+        {
+            // the queue is drained when the session fails, which completes
+            // the results
+            assert(each.running == 0);
+            if (each.failure == 0)
+            {
+                each.failure = errno;
+            }
+            break;
+        }
+    }
+
+    if (each.failure != 0)
+    {
+        errno = each.failure;
+        return -1;
+    }
+    return 0;
+}
+
+
+int run_each_record(void *userdata, neo4j_value_t fields)
+{
+    struct run_each *each = (struct run_each *)userdata;
+    return each->on_record(each->userdata, fields);
+}
+
+
+void run_each_complete(void *userdata, neo4j_result_stream_t *results)
+{
+    struct run_each *each = (struct run_each *)userdata;
+    each->failure = neo4j_check_failure(results);
+    each->running = 0;
+}
+
+
+run_result_stream_t *run_rs_start(neo4j_session_t *session,
+        const char *statement, neo4j_value_t params, unsigned int fetch_size)
+{
     run_result_stream_t *results = run_rs_open(session);
     if (results == NULL)
     {
@@ -235,17 +446,20 @@ neo4j_result_stream_t *neo4j_run(neo4j_session_t *session,
     }
     (results->refcount)++;
 
-    if (neo4j_session_pull_all(results->session, &(results->record_mpool),
-            pull_all_callback, results))
+    if (neo4j_session_pull_encoded(results->session,
+            &(results->record_mpool), fetch_size, pull_all_callback,
+            pull_all_record_callback, results))
     {
-        neo4j_log_debug_errno(results->logger, "neo4j_session_pull_all failed");
+        neo4j_log_debug_errno(results->logger,
+                "neo4j_session_pull_encoded failed");
         goto failure;
     }
     (results->refcount)++;
+    results->batched = (fetch_size > 0);
 
     results->starting = true;
     results->streaming = true;
-    return &(results->_result_stream);
+    return results;
 
     int errsv;
 failure:
@@ -312,10 +526,25 @@ run_result_stream_t *run_rs_open(neo4j_session_t *session)
     results->allocator = config->allocator;
     results->mpool = neo4j_std_mpool(config);
     results->record_mpool = neo4j_std_mpool(config);
+    results->record_mpool_cache_size = config->record_mpool_cache_size;
     results->statement_type = -1;
     results->refcount = 1;
+    results->lazy_records = config->lazy_record_decoding;
+    results->borrow_strings = config->zero_copy_strings;
+    results->inline_strings = config->inline_strings;
+    if (config->intern_strings && !results->borrow_strings)
+    {
+        results->interns = neo4j_intern_table_new(config);
+        if (results->interns == NULL)
+        {
+            neo4j_log_debug_errno(results->logger,
+                    "failed to create intern table");
+            // continue, copying strings into each record
+        }
+    }
 
     results->job.notify_session_ending = notify_session_ending;
+    results->job.release_session = release_session;
     if (neo4j_attach_job(session, &(results->job)))
     {
         neo4j_log_debug_errno(results->logger,
@@ -330,11 +559,14 @@ run_result_stream_t *run_rs_open(neo4j_session_t *session)
     result_stream->failure_details = run_rs_failure_details;
     result_stream->nfields = run_rs_nfields;
     result_stream->fieldname = run_rs_fieldname;
+    result_stream->set_projection = run_rs_set_projection;
     result_stream->fetch_next = run_rs_fetch_next;
     result_stream->statement_type = run_rs_statement_type;
     result_stream->statement_plan = run_rs_statement_plan;
     result_stream->update_counts = run_rs_update_counts;
+    result_stream->intern_stats = run_rs_intern_stats;
     result_stream->close = run_rs_close;
+    result_stream->cancel = run_rs_cancel;
     return results;
 
     int errsv;
@@ -352,6 +584,12 @@ int run_rs_check_failure(neo4j_result_stream_t *self)
             run_result_stream_t, _result_stream);
     REQUIRE(results != NULL, -1);
 
+    if (results->read_ahead != NULL)
+    {
+        // the reader began once the RUN succeeded, and any later failure
+        // is only reported once reached by neo4j_fetch_next()
+        return 0;
+    }
     if (results->failure != 0 || await(results, &(results->starting)))
     {
         assert(results->failure != 0);
@@ -395,7 +633,9 @@ unsigned int run_rs_nfields(neo4j_result_stream_t *self)
             run_result_stream_t, _result_stream);
     REQUIRE(results != NULL, -1);
 
-    if (results->failure != 0 || await(results, &(results->starting)))
+    // the fields are known before reading ahead begins
+    if (results->read_ahead == NULL && (results->failure != 0 ||
+            await(results, &(results->starting))))
     {
         assert(results->failure != 0);
         errno = results->failure;
@@ -412,7 +652,8 @@ const char *run_rs_fieldname(neo4j_result_stream_t *self,
             run_result_stream_t, _result_stream);
     REQUIRE(results != NULL, NULL);
 
-    if (results->failure != 0 || await(results, &(results->starting)))
+    if (results->read_ahead == NULL && (results->failure != 0 ||
+            await(results, &(results->starting))))
     {
         assert(results->failure != 0);
         errno = results->failure;
@@ -429,6 +670,54 @@ const char *run_rs_fieldname(neo4j_result_stream_t *self,
 }
 
 
+int run_rs_set_projection(neo4j_result_stream_t *self,
+        const unsigned int *field_indices, unsigned int n)
+{
+    run_result_stream_t *results = container_of(self,
+            run_result_stream_t, _result_stream);
+    REQUIRE(results != NULL, -1);
+    // the projection is applied as records are received
+    stop_read_ahead(results);
+
+    if (field_indices == NULL)
+    {
+        results->projecting = false;
+        results->projection = NULL;
+        results->projection_length = 0;
+        return 0;
+    }
+
+    unsigned int length = 0;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        if (field_indices[i] >= length)
+        {
+            length = field_indices[i] + 1;
+        }
+    }
+
+    bool *projection = NULL;
+    if (length > 0)
+    {
+        projection = neo4j_mpool_calloc(&(results->mpool),
+                length, sizeof(bool));
+        if (projection == NULL)
+        {
+            return -1;
+        }
+        for (unsigned int i = 0; i < n; ++i)
+        {
+            projection[field_indices[i]] = true;
+        }
+    }
+
+    results->projecting = true;
+    results->projection = projection;
+    results->projection_length = length;
+    return 0;
+}
+
+
 neo4j_result_t *run_rs_fetch_next(neo4j_result_stream_t *self)
 {
     run_result_stream_t *results = container_of(self,
@@ -437,40 +726,79 @@ neo4j_result_t *run_rs_fetch_next(neo4j_result_stream_t *self)
 
     if (results->last_fetched != NULL)
     {
-        result_record_release(results->last_fetched);
+        results->last_fetched->results = NULL;
+        // whilst reading ahead, the stream's memory pool is in use by the
+        // reader
+        if (results->read_ahead != NULL)
+        {
+            result_record_release(results->last_fetched);
+        }
+        else
+        {
+            recycle_record(results, results->last_fetched);
+        }
         results->last_fetched = NULL;
     }
 
-    if (results->records == NULL)
+    if (results->records == NULL && results->read_ahead == NULL &&
+            results->streaming && results->failure == 0 &&
+            neo4j_session_config(results->session)->read_ahead > 0 &&
+            start_read_ahead(results))
     {
-        if (!results->streaming)
+        neo4j_log_debug_errno(results->logger, "failed to start read ahead");
+        // continue, reading records as they are fetched
+    }
+
+    result_record_t *record = NULL;
+    if (results->read_ahead != NULL)
+    {
+        record = neo4j_spsc_queue_pop(results->read_ahead);
+        if (record == NULL)
         {
-            errno = results->failure;
-            return NULL;
+            // the reader has received all records
+            stop_read_ahead(results);
         }
-        assert(results->failure == 0);
-        results->awaiting_records = 1;
-        if (await(results, &(results->awaiting_records)))
+    }
+
+    if (record == NULL)
+    {
+        if (results->records == NULL)
         {
-            errno = results->failure;
-            return NULL;
+            if (!results->streaming)
+            {
+                errno = results->failure;
+                return NULL;
+            }
+            assert(results->failure == 0);
+            results->awaiting_records = 1;
+            if (await(results, &(results->awaiting_records)))
+            {
+                errno = results->failure;
+                return NULL;
+            }
+            if (results->records == NULL)
+            {
+                assert(!results->streaming);
+                errno = results->failure;
+                return NULL;
+            }
         }
+
+        record = results->records;
+        results->records = record->next;
         if (results->records == NULL)
         {
-            assert(!results->streaming);
-            errno = results->failure;
-            return NULL;
+            results->records_tail = NULL;
         }
+        record->next = NULL;
     }
 
-    result_record_t *record = results->records;
-    results->records = record->next;
-    if (results->records == NULL)
+    if (await_decoded(results, record))
     {
-        results->records_tail = NULL;
+        return NULL;
     }
-    record->next = NULL;
 
+    record->results = results;
     results->last_fetched = record;
     return &(record->_result);
 }
@@ -480,6 +808,7 @@ int run_rs_statement_type(neo4j_result_stream_t *self)
 {
     run_result_stream_t *results = container_of(self,
             run_result_stream_t, _result_stream);
+    stop_read_ahead(results);
     if (results == NULL || results->failure != 0 ||
             await(results, &(results->streaming)))
     {
@@ -496,6 +825,7 @@ struct neo4j_statement_plan *run_rs_statement_plan(neo4j_result_stream_t *self)
 {
     run_result_stream_t *results = container_of(self,
             run_result_stream_t, _result_stream);
+    stop_read_ahead(results);
     if (results == NULL || results->failure != 0 ||
             await(results, &(results->streaming)))
     {
@@ -517,6 +847,7 @@ struct neo4j_update_counts run_rs_update_counts(neo4j_result_stream_t *self)
 {
     run_result_stream_t *results = container_of(self,
             run_result_stream_t, _result_stream);
+    stop_read_ahead(results);
 
     if (results == NULL || results->failure != 0 ||
             await(results, &(results->streaming)))
@@ -535,11 +866,29 @@ failure:
 }
 
 
+struct neo4j_intern_stats run_rs_intern_stats(neo4j_result_stream_t *self)
+{
+    run_result_stream_t *results = container_of(self,
+            run_result_stream_t, _result_stream);
+    // the table is locked whilst strings are interned, so the statistics
+    // can be read whilst reading ahead
+    if (results != NULL && results->interns != NULL)
+    {
+        return neo4j_intern_table_stats(results->interns);
+    }
+
+    struct neo4j_intern_stats stats;
+    memset(&stats, 0, sizeof(stats));
+    return stats;
+}
+
+
 int run_rs_close(neo4j_result_stream_t *self)
 {
     run_result_stream_t *results = container_of(self,
             run_result_stream_t, _result_stream);
     REQUIRE(results != NULL, -1);
+    stop_read_ahead(results);
 
     results->streaming = false;
     assert(results->refcount > 0);
@@ -556,6 +905,7 @@ int run_rs_close(neo4j_result_stream_t *self)
 
     if (results->last_fetched != NULL)
     {
+        results->last_fetched->results = NULL;
         result_record_release(results->last_fetched);
         results->last_fetched = NULL;
     }
@@ -568,6 +918,8 @@ int run_rs_close(neo4j_result_stream_t *self)
 
     neo4j_statement_plan_release(results->statement_plan);
     results->statement_plan = NULL;
+    neo4j_intern_table_release(results->interns);
+    results->interns = NULL;
     neo4j_logger_release(results->logger);
     results->logger = NULL;
     neo4j_mpool_drain(&(results->record_mpool));
@@ -577,12 +929,68 @@ int run_rs_close(neo4j_result_stream_t *self)
 }
 
 
+int run_rs_cancel(neo4j_result_stream_t *self)
+{
+    run_result_stream_t *results = container_of(self,
+            run_result_stream_t, _result_stream);
+    REQUIRE(results != NULL, -1);
+    stop_read_ahead(results);
+
+    neo4j_session_t *session = results->session;
+
+    // the RUN must complete before the RESET, so only PULL is interrupted
+    if (session != NULL && results->streaming &&
+            results->failure == 0 &&
+            await(results, &(results->starting)) == 0 &&
+            results->streaming)
+    {
+        int result = neo4j_session_interrupt(session, results);
+        if (result < 0)
+        {
+            neo4j_log_trace_errno(results->logger,
+                    "neo4j_session_interrupt failed");
+            set_failure(results, errno);
+        }
+        else if (result == 0)
+        {
+            neo4j_log_trace(results->logger, "interrupted results in %p",
+                    (void *)session);
+            results->cancelled = true;
+        }
+    }
+
+    bool cancelled = results->cancelled;
+    int err = run_rs_close(self);
+    int errsv = errno;
+
+    // await the RESET, so the session is left ready for further requests
+    if (cancelled && neo4j_session_sync(session, NULL) && err == 0)
+    {
+        err = -1;
+        errsv = errno;
+    }
+    errno = errsv;
+    return err;
+}
+
+
 neo4j_value_t run_result_field(const neo4j_result_t *self,
         unsigned int index)
 {
-    const result_record_t *record = container_of(self,
-            result_record_t, _result);
+    result_record_t *record = container_of(self, result_record_t, _result);
     REQUIRE(record != NULL, neo4j_null);
+    if (record->encoded != NULL &&
+            index < neo4j_list_length(record->list) &&
+            record->encoded[index] != NULL &&
+            decode_field(record, index))
+    {
+        // a record no longer current can no longer fail its stream
+        if (record->results != NULL)
+        {
+            set_decode_failure(record->results, errno);
+        }
+        return neo4j_null;
+    }
     return neo4j_list_get(record->list, index);
 }
 
@@ -623,6 +1031,113 @@ void notify_session_ending(neo4j_job_t *job)
 }
 
 
+void release_session(neo4j_job_t *job)
+{
+    run_result_stream_t *results = container_of(job,
+            run_result_stream_t, job);
+    assert(results->read_ahead != NULL);
+
+    neo4j_spsc_queue_shutdown(results->read_ahead);
+    neo4j_thread_join(results->reader);
+
+    // records still queued were received before any the reader appended
+    // after the queue was shutdown
+    result_record_t *head = NULL;
+    result_record_t *tail = NULL;
+    result_record_t *record;
+    while ((record = neo4j_spsc_queue_try_pop(results->read_ahead)) != NULL)
+    {
+        if (tail == NULL)
+        {
+            head = record;
+        }
+        else
+        {
+            tail->next = record;
+        }
+        tail = record;
+    }
+    if (tail != NULL)
+    {
+        tail->next = results->records;
+        if (results->records == NULL)
+        {
+            results->records_tail = tail;
+        }
+        results->records = head;
+    }
+
+    neo4j_spsc_queue_free(results->read_ahead);
+    results->read_ahead = NULL;
+    neo4j_log_trace(results->logger, "stopped read ahead in %p",
+            (void *)(results->session));
+}
+
+
+int start_read_ahead(run_result_stream_t *results)
+{
+    neo4j_session_t *session = results->session;
+    assert(session != NULL);
+
+    // the reader can only take the session once the RUN is complete and
+    // no other requests are queued after the PULL
+    if (await(results, &(results->starting)) || !results->streaming ||
+            results->cancelled || session->request_queue_depth != 1)
+    {
+        return 0;
+    }
+
+    results->read_ahead = neo4j_spsc_queue_new(
+            neo4j_session_config(session)->read_ahead);
+    if (results->read_ahead == NULL)
+    {
+        return -1;
+    }
+    results->reading = 1;
+    neo4j_session_lend(session, &(results->job));
+
+    int err = neo4j_thread_create(&(results->reader), read_ahead, results);
+    if (err != 0)
+    {
+        session->owner = NULL;
+        neo4j_spsc_queue_free(results->read_ahead);
+        results->read_ahead = NULL;
+        errno = err;
+        return -1;
+    }
+
+    neo4j_log_trace(results->logger, "started read ahead in %p",
+            (void *)session);
+    return 0;
+}
+
+
+void *read_ahead(void *data)
+{
+    run_result_stream_t *results = (run_result_stream_t *)data;
+
+    // records are pushed into the queue as they are received, until the
+    // stream ends or the queue is shutdown
+    if (neo4j_session_sync_exclusive(results->session, &(results->reading)))
+    {
+        neo4j_log_trace_errno(results->logger, "neo4j_session_sync failed");
+        set_failure(results, errno);
+    }
+    neo4j_spsc_queue_close(results->read_ahead);
+    return NULL;
+}
+
+
+static inline void stop_read_ahead(run_result_stream_t *results)
+{
+    if (results != NULL && results->read_ahead != NULL)
+    {
+        assert(results->session->owner == &(results->job));
+        neo4j_session_reclaim(results->session);
+    }
+}
+
+
 int run_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc)
 {
@@ -648,7 +1163,11 @@ int run_callback(void *cdata, neo4j_message_type_t type,
     {
         if (results->failure == 0)
         {
-            set_failure(results, NEO4J_STATEMENT_PREVIOUS_FAILURE);
+            // a pipelined initialization may have failed to authenticate,
+            // or the session may have failed
+            set_failure(results, (session->init_error != 0)?
+                    session->init_error : session->failed?
+                    NEO4J_SESSION_FAILED : NEO4J_STATEMENT_PREVIOUS_FAILURE);
         }
         return 0;
     }
@@ -694,15 +1213,34 @@ int pull_all_callback(void *cdata, neo4j_message_type_t type,
     assert(argc == 0 || argv != NULL);
     run_result_stream_t *results = (run_result_stream_t *)cdata;
 
-    if (type == NEO4J_RECORD_MESSAGE)
+    int result = pull_all_response(results, type, argv, argc);
+    if (result <= 0 && results->async)
     {
-        if (append_result(results, argv, argc))
+        complete_async(results);
+    }
+    return result;
+}
+
+
+int pull_all_response(run_result_stream_t *results, neo4j_message_type_t type,
+        const neo4j_value_t *argv, uint16_t argc)
+{
+    if (results->cancelled)
+    {
+        // any response ends the stream once interrupted
+        --(results->refcount);
+        results->streaming = false;
+        return 0;
+    }
+
+    if (results->batched && type == NEO4J_SUCCESS_MESSAGE &&
+            results->session != NULL)
+    {
+        int result = batch_end(results, argv, argc);
+        if (result != 0)
         {
-            neo4j_log_trace_errno(results->logger, "append_result failed");
-            set_failure(results, errno);
-            return -1;
+            return result;
         }
-        return 1;
     }
 
     --(results->refcount);
@@ -720,6 +1258,70 @@ int pull_all_callback(void *cdata, neo4j_message_type_t type,
 }
 
 
+void complete_async(run_result_stream_t *results)
+{
+    neo4j_result_stream_t *result_stream = &(results->_result_stream);
+    if (results->on_complete != NULL)
+    {
+        results->on_complete(results->userdata, result_stream);
+    }
+    run_rs_close(result_stream);
+}
+
+
+int batch_end(run_result_stream_t *results, const neo4j_value_t *argv,
+        uint16_t argc)
+{
+    neo4j_logger_t *logger = results->logger;
+    neo4j_session_t *session = results->session;
+
+    char description[128];
+    snprintf(description, sizeof(description),
+            "SUCCESS in %p (response to PULL)", (void *)session);
+
+    const neo4j_value_t *metadata = neo4j_validate_metadata(argv, argc,
+            description, logger);
+    int has_more = (metadata != NULL)?
+        neo4j_meta_has_more(*metadata, description, logger) : -1;
+    if (has_more <= 0)
+    {
+        if (has_more < 0)
+        {
+            --(results->refcount);
+            set_failure(results, errno);
+        }
+        return has_more;
+    }
+
+    neo4j_log_trace(logger, "batch of records complete in %p",
+            (void *)session);
+
+    // the metadata isn't retained, so reuse its memory for the next batch
+    recycle_record_mpool(results);
+
+    // once the stream is closed, no further records are wanted
+    return results->streaming?
+        NEO4J_REQUEST_BATCH_END : NEO4J_REQUEST_BATCH_DISCARD;
+}
+
+
+int pull_all_record_callback(void *cdata, const uint8_t *record,
+        size_t length, uint16_t argc)
+{
+    assert(cdata != NULL);
+    assert(record != NULL);
+    run_result_stream_t *results = (run_result_stream_t *)cdata;
+
+    if (append_result(results, record, length, argc))
+    {
+        neo4j_log_trace_errno(results->logger, "append_result failed");
+        set_failure(results, errno);
+        return -1;
+    }
+    return 1;
+}
+
+
 int discard_all_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc)
 {
@@ -749,6 +1351,12 @@ int stream_end(run_result_stream_t *results, neo4j_message_type_t type,
 
     if (type == NEO4J_IGNORED_MESSAGE)
     {
+        if (results->failure == 0 && session->failed)
+        {
+            // drained from the queue of a failed session
+            set_failure(results, NEO4J_SESSION_FAILED);
+            return 0;
+        }
         if (results->failure == 0)
         {
             neo4j_log_error(logger,
@@ -761,7 +1369,11 @@ int stream_end(run_result_stream_t *results, neo4j_message_type_t type,
         return 0;
     }
 
-    assert(results->failure == 0);
+    if (results->failure != 0)
+    {
+        // the stream was aborted whilst receiving records
+        return 0;
+    }
 
     if (type == NEO4J_FAILURE_MESSAGE)
     {
@@ -834,7 +1446,7 @@ int await(run_result_stream_t *results, const unsigned int *condition)
 
 
 int append_result(run_result_stream_t *results,
-        const neo4j_value_t *argv, uint16_t argc)
+        const uint8_t *data, size_t length, uint16_t argc)
 {
     assert(results != NULL);
     neo4j_session_t *session = results->session;
@@ -848,43 +1460,96 @@ int append_result(run_result_stream_t *results,
         return -1;
     }
 
-    assert(argv != NULL);
-
-    neo4j_type_t arg_type = neo4j_type(argv[0]);
-    if (arg_type != NEO4J_LIST)
+    if (!results->streaming)
     {
-        neo4j_log_error(results->logger,
-                "invalid field in RECORD message received in %p"
-                " (got %s, expected List)", (void *)session,
-                neo4j_typestr(arg_type));
-        errno = EPROTO;
-        return -1;
+        // discard the record without decoding it
+        return 0;
     }
 
-    if (!results->streaming)
+    if (results->async)
     {
-        // discard memory for the record
-        neo4j_mpool_drain(&(results->record_mpool));
-        return 0;
+        return deliver_record(results, data, length);
     }
 
     assert(session != NULL);
     neo4j_config_t *config = neo4j_session_config(session);
 
+    // lazy and projected records are decoded only in part, which is left to
+    // the receiving thread
+    neo4j_worker_pool_t *workers = NULL;
+    if (!results->lazy_records && !results->projecting)
+    {
+        workers = neo4j_session_workers(session);
+    }
+
+    // records decoded lazily or by a worker always reference the received
+    // message, as do records borrowing strings from it
+    if ((results->lazy_records || results->borrow_strings ||
+                workers != NULL) &&
+            neo4j_connection_retain_frame(session->connection,
+                &(results->record_mpool), &data))
+    {
+        goto failure;
+    }
+    const uint8_t *end = data + length;
+
     result_record_t *record = neo4j_mpool_calloc(&(results->record_mpool),
             1, sizeof(result_record_t));
     if (record == NULL)
     {
-        return -1;
+        goto failure;
+    }
+
+    if (results->lazy_records)
+    {
+        if (index_fields(results, record, data, end))
+        {
+            goto failure;
+        }
+    }
+    else if (results->projecting)
+    {
+        if (decode_projected_fields(results, record, data, end))
+        {
+            goto failure;
+        }
+    }
+    else if (workers != NULL)
+    {
+        record->encoded_list = data;
+        record->encoded_end = end;
+        record->borrow_strings = results->borrow_strings;
+        record->inline_strings = results->inline_strings;
+        record->decoding.run = decode_record;
+    }
+    else if (neo4j_deserialize_interned(&data, end, results->borrow_strings,
+                results->inline_strings, results->interns,
+                &(results->record_mpool), &(record->list)))
+    {
+        goto failure;
+    }
+    else if (neo4j_type(record->list) != NEO4J_LIST)
+    {
+        neo4j_log_error(results->logger,
+                "invalid field in RECORD message received in %p"
+                " (got %s, expected List)", (void *)session,
+                neo4j_typestr(neo4j_type(record->list)));
+        errno = EPROTO;
+        goto failure;
     }
 
     record->refcount = 1;
+    if (results->interns != NULL)
+    {
+        record->interns = neo4j_intern_table_retain(results->interns);
+    }
 
     // save memory for the record with the record
     record->mpool = results->record_mpool;
     results->record_mpool = neo4j_std_mpool(config);
+    // but keep any spare memory for the next record
+    neo4j_mpool_take_spares(&(results->record_mpool), &(record->mpool));
 
-    record->list = argv[0];
     record->next = NULL;
 
     neo4j_result_t *result = &(record->_result);
@@ -892,6 +1557,29 @@ int append_result(run_result_stream_t *results,
     result->retain = run_result_retain;
     result->release = run_result_release;
 
+    if (workers != NULL)
+    {
+        if (neo4j_worker_pool_submit(workers, &(record->decoding)) == 0)
+        {
+            record->workers = workers;
+        }
+        else
+        {
+            decode_record(&(record->decoding));
+        }
+    }
+
+    if (results->read_ahead != NULL)
+    {
+        if (neo4j_spsc_queue_push(results->read_ahead, record) == 0)
+        {
+            return 0;
+        }
+        // the reader is being stopped, so the record is held by the stream
+        // as usual, and no further responses are awaited
+        results->reading = 0;
+    }
+
     if (results->records == NULL)
     {
         assert(results->records_tail == NULL);
@@ -910,6 +1598,251 @@ int append_result(run_result_stream_t *results,
     }
 
     return 0;
+
+    int errsv;
+failure:
+    errsv = errno;
+    neo4j_mpool_drain(&(results->record_mpool));
+    errno = errsv;
+    return -1;
+}
+
+
+int deliver_record(run_result_stream_t *results,
+        const uint8_t *data, size_t length)
+{
+    neo4j_session_t *session = results->session;
+    assert(session != NULL);
+
+    // the record is only valid until the callback returns, so strings are
+    // always borrowed from the received message
+    neo4j_value_t fields;
+    if (neo4j_deserialize_buffer(&data, data + length, true,
+                &(results->record_mpool), &fields))
+    {
+        goto failure;
+    }
+    if (neo4j_type(fields) != NEO4J_LIST)
+    {
+        neo4j_log_error(results->logger,
+                "invalid field in RECORD message received in %p"
+                " (got %s, expected List)", (void *)session,
+                neo4j_typestr(neo4j_type(fields)));
+        errno = EPROTO;
+        goto failure;
+    }
+
+    errno = 0;
+    int result = (results->on_record != NULL)?
+        results->on_record(results->userdata, fields) : 0;
+    int error = errno;
+    recycle_record_mpool(results);
+
+    if (result != 0)
+    {
+        neo4j_log_trace(results->logger,
+                "record callback aborted results in %p", (void *)session);
+        set_failure(results, (error != 0)? error : ECANCELED);
+        // interrupt the statement, if possible, otherwise the remaining
+        // records will be discarded as they are received
+        if (neo4j_session_interrupt(session, results) == 0)
+        {
+            results->cancelled = true;
+        }
+    }
+    return 0;
+
+    int errsv;
+failure:
+    errsv = errno;
+    neo4j_mpool_drain(&(results->record_mpool));
+    errno = errsv;
+    return -1;
+}
+
+
+void recycle_record_mpool(run_result_stream_t *results)
+{
+    neo4j_mpool_t mpool = results->record_mpool;
+    results->record_mpool = neo4j_std_mpool(
+            neo4j_session_config(results->session));
+    neo4j_mpool_recycle(&mpool, &(results->record_mpool),
+            results->record_mpool_cache_size);
+}
+
+
+int decode_projected_fields(run_result_stream_t *results,
+        result_record_t *record, const uint8_t *data, const uint8_t *end)
+{
+    uint32_t nfields;
+    if (neo4j_deserialize_list_header(&data, end, &nfields))
+    {
+        if (errno == EPROTO)
+        {
+            neo4j_log_error(results->logger,
+                    "invalid field in RECORD message received in %p"
+                    " (expected List)", (void *)(results->session));
+        }
+        return -1;
+    }
+
+    neo4j_value_t *fields = NULL;
+    if (nfields > 0)
+    {
+        fields = neo4j_mpool_calloc(&(results->record_mpool),
+                nfields, sizeof(neo4j_value_t));
+        if (fields == NULL)
+        {
+            return -1;
+        }
+    }
+
+    // fields not in the projection are stepped over and left null
+    for (unsigned int i = 0; i < nfields; ++i)
+    {
+        int err = is_projected(results, i)?
+            neo4j_deserialize_interned(&data, end, results->borrow_strings,
+                    results->inline_strings, results->interns,
+                    &(results->record_mpool), &(fields[i])) :
+            neo4j_deserialize_skip(&data, end);
+        if (err)
+        {
+            return -1;
+        }
+    }
+
+    record->list = neo4j_list(fields, nfields);
+    return 0;
+}
+
+
+bool is_projected(const run_result_stream_t *results, unsigned int index)
+{
+    return !results->projecting ||
+        (index < results->projection_length && results->projection[index]);
+}
+
+
+int index_fields(run_result_stream_t *results, result_record_t *record,
+        const uint8_t *data, const uint8_t *end)
+{
+    uint32_t nfields;
+    if (neo4j_deserialize_list_header(&data, end, &nfields))
+    {
+        if (errno == EPROTO)
+        {
+            neo4j_log_error(results->logger,
+                    "invalid field in RECORD message received in %p"
+                    " (expected List)", (void *)(results->session));
+        }
+        return -1;
+    }
+
+    neo4j_value_t *fields = NULL;
+    const uint8_t **encoded = NULL;
+    if (nfields > 0)
+    {
+        fields = neo4j_mpool_calloc(&(results->record_mpool),
+                nfields, sizeof(neo4j_value_t));
+        encoded = neo4j_mpool_calloc(&(results->record_mpool),
+                nfields, sizeof(const uint8_t *));
+        if (fields == NULL || encoded == NULL)
+        {
+            return -1;
+        }
+    }
+
+    // locate each field, without decoding it
+    for (unsigned int i = 0; i < nfields; ++i)
+    {
+        encoded[i] = is_projected(results, i)? data : NULL;
+        if (neo4j_deserialize_skip(&data, end))
+        {
+            return -1;
+        }
+    }
+
+    record->list = neo4j_list(fields, nfields);
+    record->fields = fields;
+    record->encoded = encoded;
+    record->encoded_end = end;
+    record->borrow_strings = results->borrow_strings;
+    record->inline_strings = results->inline_strings;
+    return 0;
+}
+
+
+int decode_field(result_record_t *record, unsigned int index)
+{
+    assert(record->encoded != NULL);
+    const uint8_t *data = record->encoded[index];
+    assert(data != NULL);
+
+    if (neo4j_deserialize_interned(&data, record->encoded_end,
+                record->borrow_strings, record->inline_strings,
+                record->interns, &(record->mpool), &(record->fields[index])))
+    {
+        return -1;
+    }
+    record->encoded[index] = NULL;
+    return 0;
+}
+
+
+void decode_record(neo4j_work_t *work)
+{
+    result_record_t *record = container_of(work, result_record_t, decoding);
+    const uint8_t *data = record->encoded_list;
+
+    if (neo4j_deserialize_interned(&data, record->encoded_end,
+                record->borrow_strings, record->inline_strings,
+                record->interns, &(record->mpool), &(record->list)))
+    {
+        record->decode_error = errno;
+    }
+    else if (neo4j_type(record->list) != NEO4J_LIST)
+    {
+        record->decode_error = EPROTO;
+    }
+}
+
+
+int await_decoded(run_result_stream_t *results, result_record_t *record)
+{
+    if (record->workers != NULL)
+    {
+        neo4j_worker_pool_await(record->workers, &(record->decoding));
+        record->workers = NULL;
+    }
+    if (record->decode_error == 0)
+    {
+        return 0;
+    }
+
+    int error = record->decode_error;
+    result_record_release(record);
+    set_decode_failure(results, error);
+    return -1;
+}
+
+
+void set_decode_failure(run_result_stream_t *results, int error)
+{
+    errno = error;
+    neo4j_log_error_errno(results->logger,
+            "failed to decode RECORD message");
+
+    // records are delivered in order, so no others can follow
+    stop_read_ahead(results);
+    set_failure(results, error);
+    while (results->records != NULL)
+    {
+        result_record_t *next = results->records->next;
+        result_record_release(results->records);
+        results->records = next;
+    }
+    results->records_tail = NULL;
+    errno = error;
 }
 
 
@@ -918,11 +1851,35 @@ void result_record_release(result_record_t *record)
     assert(record->refcount > 0);
     if (--(record->refcount) == 0)
     {
+        // a record not yet fetched may still be being decoded (once done,
+        // the worker pool is not referenced, so it may have been freed)
+        if (record->workers != NULL)
+        {
+            neo4j_worker_pool_await(record->workers, &(record->decoding));
+        }
         // record was allocated in its own pool, so draining the pool
         // deallocates the record - so we have to copy the pool out first
         // or it'll be deallocated whist still draining
+        neo4j_intern_table_t *interns = record->interns;
         neo4j_mpool_t mpool = record->mpool;
         neo4j_mpool_drain(&mpool);
+        neo4j_intern_table_release(interns);
+    }
+}
+
+
+void recycle_record(run_result_stream_t *results, result_record_t *record)
+{
+    assert(record->refcount > 0);
+    if (--(record->refcount) == 0)
+    {
+        // as in result_record_release, but the memory is retained by the
+        // stream for the next record received
+        neo4j_intern_table_t *interns = record->interns;
+        neo4j_mpool_t mpool = record->mpool;
+        neo4j_mpool_recycle(&mpool, &(results->record_mpool),
+                results->record_mpool_cache_size);
+        neo4j_intern_table_release(interns);
     }
 }
 
@@ -89,6 +89,18 @@ struct neo4j_result_stream
      */
     const char *(*fieldname)(neo4j_result_stream_t *self, unsigned int index);
 
+    /**
+     * Restrict the fields decoded from subsequently received records.
+     *
+     * @param [self] This result stream.
+     * @param [field_indices] The indices of the fields to decode, or
+     *         `NULL` to decode all fields.
+     * @param [n] The number of indices in `field_indices`.
+     * @return 0 on success, or -1 on failure (errno will be set).
+     */
+    int (*set_projection)(neo4j_result_stream_t *self,
+            const unsigned int *field_indices, unsigned int n);
+
     /**
      * Fetch the next record from the result stream.
      *
@@ -112,6 +124,14 @@ struct neo4j_result_stream
      */
     struct neo4j_update_counts (*update_counts)(neo4j_result_stream_t *self);
 
+    /**
+     * Return the statistics for strings interned in the result stream.
+     *
+     * @param [self] The result stream.
+     * @return The statistics.
+     */
+    struct neo4j_intern_stats (*intern_stats)(neo4j_result_stream_t *self);
+
     /**
      * Return the statement type for the result stream.
      *
@@ -161,6 +181,18 @@ struct neo4j_result_stream
      * @return 0 on success, or -1 on failure (errno will be set).
      */
     int (*close)(neo4j_result_stream_t *self);
+
+    /**
+     * Cancel and close a result stream.
+     *
+     * As for `close`, but any results not yet received are abandoned
+     * rather than awaited.
+     *
+     * @param [self] This result stream. The pointer will be invalid after the
+     *         function returns.
+     * @return 0 on success, or -1 on failure (errno will be set).
+     */
+    int (*cancel)(neo4j_result_stream_t *self);
 };
 
 
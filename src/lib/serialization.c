@@ -185,7 +185,7 @@ int neo4j_string_serialize(const neo4j_value_t *value, neo4j_iostream_t *stream)
     struct iovec iov[3];
     struct length_header header;
     int iovcnt = build_header(iov, &header, v->length, &string_markers);
-    iov[iovcnt].iov_base = (void *)(uintptr_t)(v->ustring);
+    iov[iovcnt].iov_base = (void *)(uintptr_t)neo4j_string_content(v);
     iov[iovcnt].iov_len = v->length;
     iovcnt++;
 
@@ -214,7 +214,7 @@ int neo4j_list_serialize(const neo4j_value_t *value, neo4j_iostream_t *stream)
 
     for (unsigned i = 0; i < v->length; ++i)
     {
-        if (neo4j_serialize(v->items[i], stream))
+        if (neo4j_serialize(neo4j_list_item(v, i), stream))
         {
             return -1;
         }
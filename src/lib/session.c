@@ -28,25 +28,65 @@ static_assert(NEO4J_REQUEST_ARGV_PREALLOC >= 2,
         "NEO4J_REQUEST_ARGV_PREALLOC too small");
 
 
+struct init_cdata
+{
+    neo4j_session_t *session;
+    int error;
+};
+
+
+struct transaction_cdata
+{
+    neo4j_session_t *session;
+    const char *statement;
+    unsigned int awaiting;
+    int error;
+};
+
+
 static int session_start(neo4j_session_t *session);
 static int session_clear(neo4j_session_t *session);
 static int send_requests(neo4j_session_t *session);
 static int receive_responses(neo4j_session_t *session,
-        const unsigned int *condition);
+        const unsigned int *condition, bool nonblocking);
+static int recover(neo4j_session_t *session);
 static int drain_queued_requests(neo4j_session_t *session);
+static int flush_recovery(neo4j_session_t *session);
 
 static struct neo4j_request *new_request(neo4j_session_t *session);
+static struct neo4j_request *new_statement_request(neo4j_session_t *session);
 static void pop_request(neo4j_session_t* session);
 
 static int initialize(neo4j_session_t *session, unsigned int attempts);
+static int enqueue_init(neo4j_session_t *session,
+        neo4j_response_recv_t callback, void *cdata,
+        const char *username, const char *password);
+static int enqueue_hello(neo4j_session_t *session,
+        neo4j_response_recv_t callback, void *cdata,
+        const char *username, const char *password);
 static int initialize_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc);
+static int pipelined_init_callback(void *cdata, neo4j_message_type_t type,
+        const neo4j_value_t *argv, uint16_t argc);
 static int ack_failure(neo4j_session_t *session);
 static int ack_failure_callback(void *cdata, neo4j_message_type_t type,
        const neo4j_value_t *argv, uint16_t argc);
 static int reset(neo4j_session_t *session);
 static int reset_callback(void *cdata, neo4j_message_type_t type,
        const neo4j_value_t *argv, uint16_t argc);
+static int discard_remaining(neo4j_session_t *session,
+        struct neo4j_request *req);
+static int set_fetch_size(neo4j_session_t *session,
+        struct neo4j_request *req, unsigned int n);
+static int enqueue_transaction(neo4j_session_t *session,
+        neo4j_message_type_t type, const char *statement,
+        neo4j_response_recv_t callback, void *cdata);
+static int begin_callback(void *cdata, neo4j_message_type_t type,
+       const neo4j_value_t *argv, uint16_t argc);
+static int end_transaction(neo4j_session_t *session,
+        neo4j_message_type_t type, const char *statement);
+static int end_transaction_callback(void *cdata, neo4j_message_type_t type,
+       const neo4j_value_t *argv, uint16_t argc);
 
 
 neo4j_session_t *neo4j_new_session(neo4j_connection_t *connection)
@@ -96,6 +136,26 @@ neo4j_connection_t *neo4j_session_connection(neo4j_session_t *session)
 }
 
 
+neo4j_worker_pool_t *neo4j_session_workers(neo4j_session_t *session)
+{
+    unsigned int nworkers =
+        neo4j_session_config(session)->deserialization_workers;
+    if (session->workers == NULL && nworkers > 0)
+    {
+        session->workers = neo4j_worker_pool_new(nworkers);
+        if (session->workers == NULL)
+        {
+            neo4j_log_debug_errno(session->logger,
+                    "failed to start workers");
+            return NULL;
+        }
+        neo4j_log_trace(session->logger, "started %u workers in %p",
+                nworkers, (void *)session);
+    }
+    return session->workers;
+}
+
+
 int session_start(neo4j_session_t *session)
 {
     if (neo4j_attach_session(session->connection, session))
@@ -113,7 +173,8 @@ int session_start(neo4j_session_t *session)
 
     if (initialize(session, 0))
     {
-        assert(session->request_queue_depth <= 1);
+        // INIT, or HELLO and LOGON, may remain queued
+        assert(session->request_queue_depth <= 2);
         session->request_queue_depth = 0;
         goto failure;
     }
@@ -144,8 +205,19 @@ static int session_clear(neo4j_session_t *session)
         job = next;
     }
     session->jobs = NULL;
+    session->in_transaction = false;
+    session->transaction_failed = false;
 
-    if (!session->failed && receive_responses(session, NULL))
+    if (!session->failed && receive_responses(session, NULL, false))
+    {
+        err = -1;
+        errsv = errno;
+        session->failed = true;
+    }
+
+    // a queued ACK_FAILURE or RESET must still reach the server before the
+    // connection is reused
+    if (!session->failed && flush_recovery(session))
     {
         err = -1;
         errsv = errno;
@@ -169,6 +241,7 @@ int neo4j_end_session(neo4j_session_t *session)
 {
     REQUIRE(session != NULL, -1);
     REQUIRE(session->connection != NULL, -1);
+    neo4j_session_reclaim(session);
     int err = 0;
     int errsv = errno;
 
@@ -186,6 +259,10 @@ int neo4j_end_session(neo4j_session_t *session)
         errsv = errno;
     }
 
+    // the workers finish decoding any records still held by result streams
+    neo4j_worker_pool_free(session->workers);
+    session->workers = NULL;
+
     neo4j_log_debug(session->logger, "session ended (%p)", (void *)session);
 
     session->connection = NULL;
@@ -199,6 +276,8 @@ int neo4j_end_session(neo4j_session_t *session)
 
 int neo4j_reset_session(neo4j_session_t *session)
 {
+    neo4j_session_reclaim(session);
+
     if (session_clear(session))
     {
         return -1;
@@ -212,6 +291,77 @@ int neo4j_reset_session(neo4j_session_t *session)
 }
 
 
+int neo4j_begin_tx(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+
+    if (session->in_transaction)
+    {
+        errno = NEO4J_TRANSACTION_ACTIVE;
+        return -1;
+    }
+
+    // the response is not awaited, so BEGIN is pipelined with the statements
+    // that follow
+    if (enqueue_transaction(session, session->connection->messages->begin,
+                "BEGIN", begin_callback, session) < 0)
+    {
+        return -1;
+    }
+
+    session->in_transaction = true;
+    session->transaction_failed = false;
+    return 0;
+}
+
+
+int neo4j_commit(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+
+    if (!session->in_transaction)
+    {
+        errno = NEO4J_NO_TRANSACTION;
+        return -1;
+    }
+    if (session->transaction_failed)
+    {
+        session->in_transaction = false;
+        session->transaction_failed = false;
+        errno = NEO4J_TRANSACTION_FAILED;
+        return -1;
+    }
+
+    return end_transaction(session, session->connection->messages->commit,
+            "COMMIT");
+}
+
+
+int neo4j_rollback(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+
+    if (!session->in_transaction)
+    {
+        errno = NEO4J_NO_TRANSACTION;
+        return -1;
+    }
+    if (session->transaction_failed)
+    {
+        // already rolled back by the server
+        session->in_transaction = false;
+        session->transaction_failed = false;
+        return 0;
+    }
+
+    return end_transaction(session, session->connection->messages->rollback,
+            "ROLLBACK");
+}
+
+
 bool neo4j_credentials_expired(const neo4j_session_t *session)
 {
     return session->credentials_expired;
@@ -223,6 +373,7 @@ int neo4j_attach_job(neo4j_session_t *session, neo4j_job_t *job)
     REQUIRE(session != NULL, -1);
     REQUIRE(job != NULL, -1);
     REQUIRE(job->next == NULL, -1);
+    neo4j_session_reclaim(session);
 
     if (session->failed)
     {
@@ -262,6 +413,15 @@ int neo4j_detach_job(neo4j_session_t *session, neo4j_job_t *job)
 
 
 int neo4j_session_sync(neo4j_session_t *session, const unsigned int *condition)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+    return neo4j_session_sync_exclusive(session, condition);
+}
+
+
+int neo4j_session_sync_exclusive(neo4j_session_t *session,
+        const unsigned int *condition)
 {
     REQUIRE(session != NULL, -1);
     ENSURE_NOT_NULL(unsigned int, condition, 1);
@@ -274,24 +434,19 @@ int neo4j_session_sync(neo4j_session_t *session, const unsigned int *condition)
 
     while (*condition > 0 && session->request_queue_depth > 0)
     {
-        int result = receive_responses(session, condition);
+        int result = receive_responses(session, condition, false);
         if (result < 0)
         {
             goto error;
         }
         if (result > 0)
         {
-            assert(session->inflight_requests == 0);
-            if (drain_queued_requests(session))
-            {
-                assert(session->request_queue_depth == 0);
-                return -1;
-            }
-            assert(session->request_queue_depth == 0);
-            return ack_failure(session);
+            return recover(session);
         }
 
-        if (send_requests(session))
+        // a batched request is only sent again if further responses are
+        // awaited
+        if (*condition > 0 && send_requests(session))
         {
             goto error;
         }
@@ -309,6 +464,137 @@ error:
 }
 
 
+int neo4j_session_set_nonblocking(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+    return neo4j_connection_set_nonblocking(session->connection);
+}
+
+
+int neo4j_session_fd(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+    neo4j_connection_t *connection = session->connection;
+    if (connection->iostream == NULL)
+    {
+        errno = NEO4J_CONNECTION_CLOSED;
+        return -1;
+    }
+    return connection->nonblocking? connection->fd :
+        neo4j_ios_fileno(connection->iostream);
+}
+
+
+int neo4j_session_events(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+    if (session->failed)
+    {
+        return 0;
+    }
+
+    int events = 0;
+    if (session->inflight_requests > 0)
+    {
+        events |= NEO4J_SESSION_WANT_READ;
+    }
+    else if (session->request_queue_depth > 0)
+    {
+        // requests are waiting to be sent
+        events |= NEO4J_SESSION_WANT_WRITE;
+    }
+    if (neo4j_connection_flush_pending(session->connection))
+    {
+        events |= NEO4J_SESSION_WANT_WRITE;
+    }
+    return events;
+}
+
+
+int neo4j_session_process(neo4j_session_t *session)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+    neo4j_connection_t *connection = session->connection;
+    REQUIRE(connection->nonblocking, -1);
+
+    if (session->failed)
+    {
+        errno = NEO4J_SESSION_FAILED;
+        return -1;
+    }
+
+    for (;;)
+    {
+        if (send_requests(session) || neo4j_connection_flush(connection) < 0)
+        {
+            goto error;
+        }
+        if (session->inflight_requests == 0)
+        {
+            return 0;
+        }
+
+        int result = receive_responses(session, NULL, true);
+        if (result < 0)
+        {
+            goto error;
+        }
+        if (result > 0)
+        {
+            if (recover(session))
+            {
+                session->failed = true;
+                return -1;
+            }
+            continue;
+        }
+        if (session->inflight_requests > 0)
+        {
+            // awaiting further data from the server
+            return 0;
+        }
+    }
+
+    int errsv;
+error:
+    errsv = errno;
+    // a partial message may have been sent or received, so the session
+    // cannot continue
+    session->failed = true;
+    drain_queued_requests(session);
+    assert(session->request_queue_depth == 0);
+    errno = errsv;
+    return -1;
+}
+
+
+int recover(neo4j_session_t *session)
+{
+    assert(session->inflight_requests == 0);
+    // any open transaction is rolled back by the server
+    session->transaction_failed = session->in_transaction;
+    if (drain_queued_requests(session))
+    {
+        assert(session->request_queue_depth == 0);
+        return -1;
+    }
+    assert(session->request_queue_depth == 0);
+    if (session->init_error != 0)
+    {
+        // a pipelined initialization failed, so the session cannot be
+        // recovered
+        session->failed = true;
+        errno = session->init_error;
+        return -1;
+    }
+    return ack_failure(session);
+}
+
+
 int send_requests(neo4j_session_t *session)
 {
     assert(session != NULL);
@@ -322,6 +608,15 @@ int send_requests(neo4j_session_t *session)
         int offset =
             (session->request_queue_head + i) % session->request_queue_size;
         struct neo4j_request *request = &(session->request_queue[offset]);
+        if (i > 0)
+        {
+            int prev = (offset > 0)?
+                offset - 1 : (int)session->request_queue_size - 1;
+            if (session->request_queue[prev].batched)
+            {
+                break;
+            }
+        }
 
         if (neo4j_connection_send(connection, request->type,
                     request->argv, request->argc))
@@ -339,30 +634,49 @@ int send_requests(neo4j_session_t *session)
 }
 
 
-int receive_responses(neo4j_session_t *session, const unsigned int *condition)
+int receive_responses(neo4j_session_t *session, const unsigned int *condition,
+        bool nonblocking)
 {
     assert(session != NULL);
     ENSURE_NOT_NULL(unsigned int, condition, 1);
     neo4j_connection_t *connection = session->connection;
 
-    bool failure = false;
-    while ((failure || *condition > 0) && session->inflight_requests > 0)
+    while ((session->awaiting_ignored || *condition > 0) &&
+            session->inflight_requests > 0)
     {
         neo4j_message_type_t type;
         const neo4j_value_t *argv;
         uint16_t argc;
+        const uint8_t *record = NULL;
+        size_t rlength;
 
         struct neo4j_request *request =
             &(session->request_queue[session->request_queue_head]);
-        if (neo4j_connection_recv(connection, request->mpool,
-                    &type, &argv, &argc))
+        int result = nonblocking?
+            neo4j_connection_try_recv(connection, request->mpool,
+                    &type, &argv, &argc,
+                    (request->receive_record != NULL)? &record : NULL,
+                    &rlength) :
+            neo4j_connection_recv(connection, request->mpool,
+                    &type, &argv, &argc,
+                    (request->receive_record != NULL)? &record : NULL,
+                    &rlength);
+        if (result < 0)
         {
             neo4j_log_trace_errno(session->logger,
                     "neo4j_connection_recv failed");
             return -1;
         }
+        if (result > 0)
+        {
+            // no whole message is available yet
+            return 0;
+        }
 
-        if (failure && type != NEO4J_IGNORED_MESSAGE)
+        // a RESET sent to interrupt a request clears any failure
+        bool reset = (request->receive == reset_callback);
+        if (session->awaiting_ignored && type != NEO4J_IGNORED_MESSAGE &&
+                !reset)
         {
             neo4j_log_error(session->logger,
                     "unexpected %s message received in %p"
@@ -374,29 +688,142 @@ int receive_responses(neo4j_session_t *session, const unsigned int *condition)
         }
         if (type == NEO4J_FAILURE_MESSAGE)
         {
-            failure = true;
+            session->awaiting_ignored = true;
         }
 
         neo4j_log_debug(session->logger, "rcvd %s in response to %s (%p)",
                 neo4j_message_type_str(type),
                 neo4j_message_type_str(request->type), (void *)request);
 
-        int result = request->receive(request->cdata, type, argv, argc);
+        result = (record != NULL)?
+                request->receive_record(request->cdata, record, rlength, argc) :
+                request->receive(request->cdata, type, argv, argc);
         int errsv = errno;
         if (result <= 0)
         {
             pop_request(session);
             (session->inflight_requests)--;
         }
+        else if (result == NEO4J_REQUEST_BATCH_END ||
+                result == NEO4J_REQUEST_BATCH_DISCARD)
+        {
+            // send again when further responses are awaited
+            assert(request->batched);
+            assert(session->inflight_requests == 1);
+            (session->inflight_requests)--;
+            if (result == NEO4J_REQUEST_BATCH_DISCARD &&
+                    discard_remaining(session, request))
+            {
+                result = -1;
+                errsv = errno;
+            }
+        }
         if (result < 0)
         {
             session->failed = true;
             errno = errsv;
             return -1;
         }
+        if (reset)
+        {
+            session->awaiting_ignored = false;
+        }
+    }
+
+    if (session->awaiting_ignored && session->inflight_requests == 0)
+    {
+        session->awaiting_ignored = false;
+        return 1;
+    }
+    return 0;
+}
+
+
+int flush_recovery(neo4j_session_t *session)
+{
+    assert(session != NULL);
+    if (session->request_queue_depth == 0 || session->inflight_requests > 0)
+    {
+        return 0;
+    }
+
+    struct neo4j_request *request =
+        &(session->request_queue[session->request_queue_head]);
+    if (request->receive != ack_failure_callback &&
+            request->receive != reset_callback)
+    {
+        return 0;
+    }
+
+    if (neo4j_connection_send(session->connection, request->type,
+                request->argv, request->argc))
+    {
+        return -1;
+    }
+    session->inflight_requests = 1;
+    neo4j_log_debug(session->logger, "sent %s (%p) in %p",
+            neo4j_message_type_str(request->type),
+            (void *)request, (void *)session);
+
+    unsigned int condition = 1;
+    return (receive_responses(session, &condition, false) == 0)? 0 : -1;
+}
+
+
+int neo4j_session_interrupt(neo4j_session_t *session, void *cdata)
+{
+    REQUIRE(session != NULL, -1);
+    neo4j_session_reclaim(session);
+
+    if (session->failed)
+    {
+        errno = NEO4J_SESSION_FAILED;
+        return -1;
+    }
+
+    // a RESET would also roll back the transaction, or interrupt other
+    // queued requests
+    if (session->in_transaction || session->request_queue_depth != 1 ||
+            session->request_queue[session->request_queue_head].cdata != cdata)
+    {
+        return 1;
+    }
+
+    struct neo4j_request *request =
+        &(session->request_queue[session->request_queue_head]);
+    if (session->inflight_requests == 0)
+    {
+        // a batched request awaiting resending need not pull another batch
+        // only for it to be interrupted
+        if (request->batched && discard_remaining(session, request))
+        {
+            return -1;
+        }
+        if (send_requests(session))
+        {
+            return -1;
+        }
+    }
+    assert(session->inflight_requests == 1);
+
+    struct neo4j_request *req = new_request(session);
+    if (req == NULL)
+    {
+        return -1;
     }
+    req->type = session->connection->messages->reset;
+    req->argc = 0;
+    req->receive = reset_callback;
+    req->cdata = session;
 
-    return failure? 1 : 0;
+    if (neo4j_connection_send(session->connection, req->type, NULL, 0))
+    {
+        return -1;
+    }
+    (session->inflight_requests)++;
+    neo4j_log_debug(session->logger, "sent RESET (%p) in %p to interrupt",
+            (void *)req, (void *)session);
+    return 0;
 }
 
 
@@ -426,6 +853,7 @@ int drain_queued_requests(neo4j_session_t *session)
     }
 
     session->inflight_requests = 0;
+    session->awaiting_ignored = false;
     errno = errsv;
     return err;
 }
@@ -465,6 +893,20 @@ struct neo4j_request *new_request(neo4j_session_t *session)
 }
 
 
+struct neo4j_request *new_statement_request(neo4j_session_t *session)
+{
+    // once a statement fails in a transaction, the server has rolled it back
+    // and any further statement would be committed on its own, so only
+    // COMMIT or ROLLBACK may follow
+    if (session->in_transaction && session->transaction_failed)
+    {
+        errno = NEO4J_TRANSACTION_FAILED;
+        return NULL;
+    }
+    return new_request(session);
+}
+
+
 void pop_request(neo4j_session_t* session)
 {
     assert(session != NULL);
@@ -485,66 +927,69 @@ void pop_request(neo4j_session_t* session)
 }
 
 
-struct init_cdata
-{
-    neo4j_session_t *session;
-    int error;
-};
-
-
-int initialize(neo4j_session_t *session, unsigned int attempts)
+int initialize(neo4j_session_t *session, unsigned int attempts)
 {
     assert(session != NULL);
     neo4j_config_t *config = neo4j_session_config(session);
-    const char *client_id = config->client_id;
 
     struct init_cdata cdata = { .session = session, .error = 0 };
 
     const char *username = (config->username != NULL)? config->username : "";
     const char *password = (config->password != NULL)? config->password : "";
 
-    if (attempts > 0 || config->auth_reattempt_callback == NULL ||
-            config->password != NULL || config->attempt_empty_password)
+    bool hello = (session->connection->messages->init ==
+            NEO4J_HELLO_MESSAGE);
+    if (hello && session->connection->initialized)
     {
-        struct neo4j_request *req = new_request(session);
-        if (req == NULL)
-        {
-            return -1;
-        }
-
-        req->type = NEO4J_INIT_MESSAGE;
-        req->_argv[0] = neo4j_string(client_id);
-        neo4j_map_entry_t auth_token[3] =
-            { neo4j_map_entry("scheme", neo4j_string("basic")),
-              neo4j_map_entry("principal", neo4j_string(username)),
-              neo4j_map_entry("credentials", neo4j_string(password)) };
-        req->_argv[1] = neo4j_map(auth_token, 3);
-        req->argv = req->_argv;
-        req->argc = 2;
-        req->receive = initialize_callback;
-        req->cdata = &cdata;
+        // a later session on the same connection only resets its state
+        return reset(session);
+    }
 
-        neo4j_log_trace(session->logger, "enqu INIT{\"%s\"} (%p) in %p",
-                client_id, (void *)req, (void *)session);
+    if (attempts == 0 && config->pipelined_init &&
+            config->auth_reattempt_callback == NULL)
+    {
+        // sent together with the first requests of the session, rather
+        // than awaiting the response here
+        return hello?
+            enqueue_hello(session, pipelined_init_callback, session,
+                    username, password) :
+            enqueue_init(session, pipelined_init_callback, session,
+                    username, password);
+    }
 
-        if (neo4j_session_sync(session, NULL))
+    if (attempts > 0 || config->auth_reattempt_callback == NULL ||
+            config->password != NULL || config->attempt_empty_password)
+    {
+        int result = hello?
+            enqueue_hello(session, initialize_callback, &cdata,
+                    username, password) :
+            enqueue_init(session, initialize_callback, &cdata,
+                    username, password);
+        if (result == 0)
         {
-            return -1;
+            result = neo4j_session_sync(session, NULL);
         }
 
         if (cdata.error == 0)
         {
-            return 0;
+            session->connection->initialized = (result == 0);
+            return result;
         }
 
         assert(cdata.error == NEO4J_INVALID_CREDENTIALS ||
                 cdata.error == NEO4J_AUTH_RATE_LIMIT);
 
-        if (config->auth_reattempt_callback == NULL)
+        // after a failed HELLO, the server closes the connection, so
+        // authentication cannot be reattempted
+        if (config->auth_reattempt_callback == NULL || hello)
         {
             errno = cdata.error;
             return -1;
         }
+        if (result)
+        {
+            return -1;
+        }
 
         ++attempts;
     }
@@ -596,6 +1041,126 @@ int initialize(neo4j_session_t *session, unsigned int attempts)
 }
 
 
+int enqueue_init(neo4j_session_t *session,
+        neo4j_response_recv_t callback, void *cdata,
+        const char *username, const char *password)
+{
+    const char *client_id = neo4j_session_config(session)->client_id;
+
+    struct neo4j_request *req = new_request(session);
+    if (req == NULL)
+    {
+        return -1;
+    }
+
+    neo4j_map_entry_t *auth_token = neo4j_mpool_calloc(req->mpool,
+            3, sizeof(neo4j_map_entry_t));
+    if (auth_token == NULL)
+    {
+        return -1;
+    }
+    auth_token[0] = neo4j_map_entry("scheme", neo4j_string("basic"));
+    auth_token[1] = neo4j_map_entry("principal", neo4j_string(username));
+    auth_token[2] = neo4j_map_entry("credentials", neo4j_string(password));
+
+    req->type = NEO4J_INIT_MESSAGE;
+    req->_argv[0] = neo4j_string(client_id);
+    req->_argv[1] = neo4j_map(auth_token, 3);
+    req->argv = req->_argv;
+    req->argc = 2;
+    req->receive = callback;
+    req->cdata = cdata;
+
+    neo4j_log_trace(session->logger, "enqu INIT{\"%s\"} (%p) in %p",
+            client_id, (void *)req, (void *)session);
+    return 0;
+}
+
+
+int enqueue_hello(neo4j_session_t *session,
+        neo4j_response_recv_t callback, void *cdata,
+        const char *username, const char *password)
+{
+    const char *client_id = neo4j_session_config(session)->client_id;
+    const neo4j_connection_t *connection = session->connection;
+    const struct neo4j_message_table *messages = connection->messages;
+    bool logon = (messages->logon != NULL);
+
+    struct neo4j_request *req = new_request(session);
+    if (req == NULL)
+    {
+        return -1;
+    }
+
+    // without LOGON, the auth token is sent in the HELLO metadata
+    neo4j_map_entry_t *metadata = neo4j_mpool_calloc(req->mpool,
+            4, sizeof(neo4j_map_entry_t));
+    if (metadata == NULL)
+    {
+        return -1;
+    }
+    unsigned int n = 0;
+    metadata[n++] = neo4j_map_entry("user_agent", neo4j_string(client_id));
+    if (!logon)
+    {
+        metadata[n++] = neo4j_map_entry("scheme", neo4j_string("basic"));
+        metadata[n++] = neo4j_map_entry("principal", neo4j_string(username));
+        metadata[n++] = neo4j_map_entry("credentials",
+                neo4j_string(password));
+    }
+    else if (connection->version == 5 && connection->minor_version >= 3)
+    {
+        // the bolt agent is required from 5.3
+        neo4j_map_entry_t *agent = metadata + 2;
+        agent[0] = neo4j_map_entry("product",
+                neo4j_string(libneo4j_client_id()));
+        metadata[n++] = neo4j_map_entry("bolt_agent", neo4j_map(agent, 1));
+    }
+
+    req->type = messages->init;
+    req->_argv[0] = neo4j_map(metadata, n);
+    req->argv = req->_argv;
+    req->argc = 1;
+    req->receive = callback;
+    req->cdata = cdata;
+
+    neo4j_log_trace(session->logger, "enqu HELLO{\"%s\"} (%p) in %p",
+            client_id, (void *)req, (void *)session);
+
+    if (!logon)
+    {
+        return 0;
+    }
+
+    req = new_request(session);
+    if (req == NULL)
+    {
+        return -1;
+    }
+
+    neo4j_map_entry_t *auth_token = neo4j_mpool_calloc(req->mpool,
+            3, sizeof(neo4j_map_entry_t));
+    if (auth_token == NULL)
+    {
+        return -1;
+    }
+    auth_token[0] = neo4j_map_entry("scheme", neo4j_string("basic"));
+    auth_token[1] = neo4j_map_entry("principal", neo4j_string(username));
+    auth_token[2] = neo4j_map_entry("credentials", neo4j_string(password));
+
+    req->type = messages->logon;
+    req->_argv[0] = neo4j_map(auth_token, 3);
+    req->argv = req->_argv;
+    req->argc = 1;
+    req->receive = callback;
+    req->cdata = cdata;
+
+    neo4j_log_trace(session->logger, "enqu LOGON (%p) in %p",
+            (void *)req, (void *)session);
+    return 0;
+}
+
+
 int initialize_callback(void *cdata, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc)
 {
@@ -604,6 +1169,13 @@ int initialize_callback(void *cdata, neo4j_message_type_t type,
 
     char description[128];
 
+    if (type == NEO4J_IGNORED_MESSAGE &&
+            ((struct init_cdata *)cdata)->error != 0)
+    {
+        // LOGON following a failed HELLO
+        return 0;
+    }
+
     if (type == NEO4J_SUCCESS_MESSAGE)
     {
         snprintf(description, sizeof(description),
@@ -693,6 +1265,33 @@ cleanup:
 }
 
 
+int pipelined_init_callback(void *cdata, neo4j_message_type_t type,
+        const neo4j_value_t *argv, uint16_t argc)
+{
+    assert(cdata != NULL);
+    neo4j_session_t *session = (neo4j_session_t *)cdata;
+
+    if (type == NEO4J_IGNORED_MESSAGE && session->init_error == 0)
+    {
+        // only when draining before the request was sent
+        return 0;
+    }
+
+    struct init_cdata init_cdata =
+            { .session = session, .error = session->init_error };
+    int result = initialize_callback(&init_cdata, type, argv, argc);
+    if (result == 0 && init_cdata.error != 0)
+    {
+        session->init_error = init_cdata.error;
+    }
+    else if (result == 0 && type == NEO4J_SUCCESS_MESSAGE)
+    {
+        session->connection->initialized = true;
+    }
+    return result;
+}
+
+
 int ack_failure(neo4j_session_t *session)
 {
     assert(session != NULL);
@@ -702,15 +1301,16 @@ int ack_failure(neo4j_session_t *session)
     {
         return -1;
     }
-    req->type = NEO4J_ACK_FAILURE_MESSAGE;
+    req->type = session->connection->messages->ack_failure;
     req->argc = 0;
     req->receive = ack_failure_callback;
     req->cdata = session;
 
-    neo4j_log_trace(session->logger, "enqu ACK_FAILURE (%p) in %p",
-            (void *)req, (void *)session);
+    neo4j_log_trace(session->logger, "enqu %s (%p) in %p",
+            neo4j_message_type_str(req->type), (void *)req, (void *)session);
 
-    return neo4j_session_sync(session, NULL);
+    // sent at the front of the next flush, rather than awaited here
+    return 0;
 }
 
 
@@ -750,7 +1350,7 @@ int reset(neo4j_session_t *session)
     {
         return -1;
     }
-    req->type = NEO4J_RESET_MESSAGE;
+    req->type = session->connection->messages->reset;
     req->argc = 0;
     req->receive = reset_callback;
     req->cdata = session;
@@ -758,7 +1358,8 @@ int reset(neo4j_session_t *session)
     neo4j_log_trace(session->logger, "enqu RESET (%p) in %p",
             (void *)req, (void *)session);
 
-    return neo4j_session_sync(session, NULL);
+    // sent at the front of the next flush, rather than awaited here
+    return 0;
 }
 
 
@@ -798,17 +1399,20 @@ int neo4j_session_run(neo4j_session_t *session, neo4j_mpool_t *mpool,
     REQUIRE(statement != NULL, -1);
     REQUIRE(neo4j_type(params) == NEO4J_MAP || neo4j_is_null(params), -1);
     REQUIRE(callback != NULL, -1);
+    neo4j_session_reclaim(session);
 
-    struct neo4j_request *req = new_request(session);
+    struct neo4j_request *req = new_statement_request(session);
     if (req == NULL)
     {
         return -1;
     }
-    req->type = NEO4J_RUN_MESSAGE;
+    req->type = session->connection->messages->run;
     req->_argv[0] = neo4j_string(statement);
     req->_argv[1] = neo4j_is_null(params)? neo4j_map(NULL, 0) : params;
+    // from version 3, RUN has additional metadata
+    req->_argv[2] = neo4j_map(NULL, 0);
     req->argv = req->_argv;
-    req->argc = 2;
+    req->argc = (session->connection->version >= 3)? 3 : 2;
     req->mpool = mpool;
     req->receive = callback;
     req->cdata = cdata;
@@ -822,53 +1426,299 @@ int neo4j_session_run(neo4j_session_t *session, neo4j_mpool_t *mpool,
 
 int neo4j_session_pull_all(neo4j_session_t *session, neo4j_mpool_t *mpool,
         neo4j_response_recv_t callback, void *cdata)
+{
+    return neo4j_session_pull_all_encoded(session, mpool, callback, NULL,
+            cdata);
+}
+
+
+int neo4j_session_pull_all_encoded(neo4j_session_t *session,
+        neo4j_mpool_t *mpool, neo4j_response_recv_t callback,
+        neo4j_record_recv_t record_callback, void *cdata)
+{
+    return neo4j_session_pull_encoded(session, mpool, 0, callback,
+            record_callback, cdata);
+}
+
+
+int neo4j_session_pull_encoded(neo4j_session_t *session,
+        neo4j_mpool_t *mpool, unsigned int n, neo4j_response_recv_t callback,
+        neo4j_record_recv_t record_callback, void *cdata)
 {
     REQUIRE(session != NULL, -1);
     REQUIRE(mpool != NULL, -1);
     REQUIRE(callback != NULL, -1);
+    neo4j_session_reclaim(session);
 
-    struct neo4j_request *req = new_request(session);
+    struct neo4j_request *req = new_statement_request(session);
     if (req == NULL)
     {
         return -1;
     }
 
-    req->type = NEO4J_PULL_ALL_MESSAGE;
-    req->argv = NULL;
-    req->argc = 0;
+    req->type = session->connection->messages->pull_all;
+    if (set_fetch_size(session, req, n))
+    {
+        return -1;
+    }
     req->mpool = mpool;
     req->receive = callback;
+    req->receive_record = record_callback;
     req->cdata = cdata;
 
-    neo4j_log_trace(session->logger, "enqu PULL_ALL (%p) in %p",
-            (void *)req, (void *)session);
+    neo4j_log_trace(session->logger, "enqu %s (%p) in %p",
+            neo4j_message_type_str(req->type), (void *)req, (void *)session);
 
     return 0;
 }
 
 
+int discard_remaining(neo4j_session_t *session, struct neo4j_request *req)
+{
+    assert(req->batched);
+    neo4j_log_trace(session->logger, "discarding remaining records of %s"
+            " (%p) in %p", neo4j_message_type_str(req->type), (void *)req,
+            (void *)session);
+    if (set_fetch_size(session, req, 0))
+    {
+        return -1;
+    }
+    req->type = session->connection->messages->discard_all;
+    return 0;
+}
+
+
+int set_fetch_size(neo4j_session_t *session, struct neo4j_request *req,
+        unsigned int n)
+{
+    if (session->connection->version < 4)
+    {
+        req->argv = NULL;
+        req->argc = 0;
+        return 0;
+    }
+
+    // from version 4, PULL and DISCARD specify the number of records
+    neo4j_map_entry_t *entry = neo4j_mpool_alloc(&(req->_mpool),
+            sizeof(neo4j_map_entry_t));
+    if (entry == NULL)
+    {
+        return -1;
+    }
+    *entry = neo4j_map_entry("n", neo4j_int((n > 0)? (long long)n : -1));
+    req->batched = (n > 0);
+    req->_argv[0] = neo4j_map(entry, 1);
+    req->argv = req->_argv;
+    req->argc = 1;
+    return 0;
+}
+
+
 int neo4j_session_discard_all(neo4j_session_t *session, neo4j_mpool_t *mpool,
         neo4j_response_recv_t callback, void *cdata)
 {
     REQUIRE(session != NULL, -1);
     REQUIRE(mpool != NULL, -1);
     REQUIRE(callback != NULL, -1);
+    neo4j_session_reclaim(session);
+
+    struct neo4j_request *req = new_statement_request(session);
+    if (req == NULL)
+    {
+        return -1;
+    }
+
+    req->type = session->connection->messages->discard_all;
+    if (set_fetch_size(session, req, 0))
+    {
+        return -1;
+    }
+    req->mpool = mpool;
+    req->receive = callback;
+    req->cdata = cdata;
+
+    neo4j_log_trace(session->logger, "enqu %s (%p) in %p",
+            neo4j_message_type_str(req->type), (void *)req, (void *)session);
+
+    return 0;
+}
+
+
+int enqueue_transaction(neo4j_session_t *session, neo4j_message_type_t type,
+        const char *statement, neo4j_response_recv_t callback, void *cdata)
+{
+    assert(session != NULL);
 
+    // requests are enqueued together, or not at all
+    unsigned int n = (type != NULL)? 1 : 2;
+    if (!session->failed &&
+            session->request_queue_size - session->request_queue_depth < n)
+    {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    if (type != NULL)
+    {
+        struct neo4j_request *req = new_request(session);
+        if (req == NULL)
+        {
+            return -1;
+        }
+        req->type = type;
+        // BEGIN has additional metadata
+        req->_argv[0] = neo4j_map(NULL, 0);
+        req->argv = req->_argv;
+        req->argc = (type == NEO4J_BEGIN_MESSAGE)? 1 : 0;
+        req->receive = callback;
+        req->cdata = cdata;
+
+        neo4j_log_trace(session->logger, "enqu %s (%p) in %p",
+                neo4j_message_type_str(type), (void *)req, (void *)session);
+        return 1;
+    }
+
+    // before version 3, transactions are controlled using statements
     struct neo4j_request *req = new_request(session);
     if (req == NULL)
     {
         return -1;
     }
+    req->type = session->connection->messages->run;
+    req->_argv[0] = neo4j_string(statement);
+    req->_argv[1] = neo4j_map(NULL, 0);
+    req->argv = req->_argv;
+    req->argc = 2;
+    req->receive = callback;
+    req->cdata = cdata;
 
-    req->type = NEO4J_DISCARD_ALL_MESSAGE;
-    req->argv = NULL;
+    neo4j_log_trace(session->logger, "enqu RUN{\"%s\"} (%p) in %p",
+            statement, (void *)req, (void *)session);
+
+    req = new_request(session);
+    if (req == NULL)
+    {
+        return -1;
+    }
+    req->type = session->connection->messages->discard_all;
     req->argc = 0;
-    req->mpool = mpool;
     req->receive = callback;
     req->cdata = cdata;
 
     neo4j_log_trace(session->logger, "enqu DISCARD_ALL (%p) in %p",
             (void *)req, (void *)session);
+    return 2;
+}
+
+
+int begin_callback(void *cdata, neo4j_message_type_t type,
+        const neo4j_value_t *argv, uint16_t argc)
+{
+    assert(cdata != NULL);
+    neo4j_session_t *session = (neo4j_session_t *)cdata;
+
+    // on FAILURE, the statements in the transaction are drained and the
+    // failure is reported when it ends
+    if (type != NEO4J_SUCCESS_MESSAGE && type != NEO4J_FAILURE_MESSAGE &&
+            type != NEO4J_IGNORED_MESSAGE)
+    {
+        neo4j_log_error(session->logger,
+                "unexpected %s message received in %p"
+                " (expected SUCCESS in response to BEGIN)",
+                neo4j_message_type_str(type), (void *)session);
+        errno = EPROTO;
+        return -1;
+    }
+
+    neo4j_log_trace(session->logger, "BEGIN %s in %p",
+            (type == NEO4J_SUCCESS_MESSAGE)? "complete" : "failed",
+            (void *)session);
+    return 0;
+}
+
+
+int end_transaction(neo4j_session_t *session, neo4j_message_type_t type,
+        const char *statement)
+{
+    assert(session != NULL);
+    assert(session->in_transaction && !session->transaction_failed);
+
+    struct transaction_cdata cdata =
+        { .session = session, .statement = statement, .error = 0 };
+    int n = enqueue_transaction(session, type, statement,
+            end_transaction_callback, &cdata);
+    if (n < 0)
+    {
+        return -1;
+    }
+    cdata.awaiting = n;
+    session->in_transaction = false;
+
+    // sends any statements still queued, along with the COMMIT or ROLLBACK
+    int result = neo4j_session_sync(session, &(cdata.awaiting));
+    session->transaction_failed = false;
+    if (result)
+    {
+        return -1;
+    }
+    if (cdata.error != 0)
+    {
+        errno = cdata.error;
+        return -1;
+    }
+
+    neo4j_log_trace(session->logger, "%s complete in %p", statement,
+            (void *)session);
+    return 0;
+}
+
 
+int end_transaction_callback(void *cdata, neo4j_message_type_t type,
+        const neo4j_value_t *argv, uint16_t argc)
+{
+    assert(cdata != NULL);
+    struct transaction_cdata *tx = (struct transaction_cdata *)cdata;
+    neo4j_session_t *session = tx->session;
+
+    assert(tx->awaiting > 0);
+    --(tx->awaiting);
+
+    if (type == NEO4J_SUCCESS_MESSAGE)
+    {
+        return 0;
+    }
+    if (type == NEO4J_IGNORED_MESSAGE)
+    {
+        if (tx->error == 0)
+        {
+            tx->error = NEO4J_TRANSACTION_FAILED;
+        }
+        return 0;
+    }
+    if (type != NEO4J_FAILURE_MESSAGE)
+    {
+        neo4j_log_error(session->logger,
+                "unexpected %s message received in %p"
+                " (expected SUCCESS in response to %s)",
+                neo4j_message_type_str(type), (void *)session, tx->statement);
+        errno = EPROTO;
+        return -1;
+    }
+
+    char description[128];
+    snprintf(description, sizeof(description),
+            "FAILURE in %p (response to %s)", (void *)session, tx->statement);
+    const neo4j_value_t *metadata = neo4j_validate_metadata(argv, argc,
+            description, session->logger);
+    if (metadata == NULL)
+    {
+        return -1;
+    }
+    if (neo4j_log_is_enabled(session->logger, NEO4J_LOG_DEBUG))
+    {
+        neo4j_metadata_log(session->logger, NEO4J_LOG_DEBUG, description,
+                *metadata);
+    }
+    tx->error = NEO4J_TRANSACTION_FAILED;
     return 0;
 }
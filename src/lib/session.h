@@ -21,11 +21,36 @@
 #include "connection.h"
 #include "job.h"
 #include "memory.h"
+#include "worker_pool.h"
+#include <assert.h>
 
 
 typedef int (*neo4j_response_recv_t)(void *cdata, neo4j_message_type_t type,
             const neo4j_value_t *argv, uint16_t argc);
 
+/*
+ * Receives a RECORD message with its arguments still encoded. The encoded
+ * arguments are only valid for the duration of the callback, unless
+ * retained using neo4j_connection_retain_frame().
+ */
+typedef int (*neo4j_record_recv_t)(void *cdata, const uint8_t *record,
+            size_t length, uint16_t argc);
+
+/*
+ * Returned by a response callback when the response ends a batch of records
+ * (e.g. SUCCESS {has_more: true} in response to PULL {n}). The request then
+ * remains at the head of the queue, and is sent again when further responses
+ * are awaited.
+ */
+#define NEO4J_REQUEST_BATCH_END 2
+
+/*
+ * Returned by a response callback when the response ends a batch of records,
+ * but no further records are wanted. The request then remains at the head of
+ * the queue, and is sent again as a DISCARD of all remaining records.
+ */
+#define NEO4J_REQUEST_BATCH_DISCARD 3
+
 #define NEO4J_REQUEST_ARGV_PREALLOC 4
 
 struct neo4j_request
@@ -39,7 +64,12 @@ struct neo4j_request
     neo4j_mpool_t *mpool;
 
     neo4j_response_recv_t receive;
+    neo4j_record_recv_t receive_record;
     void *cdata;
+
+    // a batched request may be sent repeatedly, so no later request can be
+    // sent until it is complete
+    bool batched;
 };
 
 
@@ -50,6 +80,10 @@ struct neo4j_session
 
     bool credentials_expired;
     bool failed;
+    bool in_transaction;
+    bool transaction_failed;
+    // set when a pipelined initialization fails to authenticate
+    int init_error;
 
     struct neo4j_request *request_queue;
     unsigned int request_queue_size;
@@ -57,8 +91,16 @@ struct neo4j_session
     unsigned int request_queue_depth;
 
     unsigned int inflight_requests;
+    // set when a FAILURE is received, until the responses to the remaining
+    // inflight requests have been received
+    bool awaiting_ignored;
 
     neo4j_job_t *jobs;
+    // a job using the session from another thread, which has exclusive use
+    // of it until reclaimed
+    neo4j_job_t *owner;
+    // threads decoding records, started when first required
+    neo4j_worker_pool_t *workers;
 };
 
 
@@ -73,6 +115,27 @@ struct neo4j_session
  */
 #define neo4j_session_config(s) ((s)->connection->config)
 
+/**
+ * Interrupt the request currently being processed by the server.
+ *
+ * Sends a RESET immediately, after any requests already sent, such that the
+ * server stops processing the current request. Responses to requests sent
+ * before the RESET will be FAILURE or IGNORED, or may still be SUCCESS if
+ * the server completed them before the RESET arrived.
+ *
+ * The request is only interrupted if it is the sole request queued in the
+ * session and the session is not within an explicit transaction.
+ *
+ * @internal
+ *
+ * @param [session] The session.
+ * @param [cdata] The callback data of the request to interrupt.
+ * @return 0 if the request was interrupted, 1 if it could not be
+ *         interrupted, or -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_interrupt(neo4j_session_t *session, void *cdata);
+
 /**
  * Attach a job to a session.
  *
@@ -96,6 +159,58 @@ int neo4j_attach_job(neo4j_session_t *session, neo4j_job_t *job);
  */
 int neo4j_detach_job(neo4j_session_t *session, neo4j_job_t *job);
 
+/**
+ * Lend a session to a job, for its exclusive use from another thread.
+ *
+ * Whilst lent, the job may use neo4j_session_sync_exclusive() in another
+ * thread. Any other use of the session first reclaims it.
+ *
+ * @internal
+ *
+ * @param [session] The session to lend.
+ * @param [job] The job to lend it to, which must be attached to the session.
+ */
+static inline void neo4j_session_lend(neo4j_session_t *session,
+        neo4j_job_t *job)
+{
+    assert(session->owner == NULL);
+    session->owner = job;
+}
+
+/**
+ * Reclaim a session lent to a job.
+ *
+ * Returns once the job has stopped using the session. Does nothing if the
+ * session is not lent.
+ *
+ * @internal
+ *
+ * @param [session] The session to reclaim.
+ */
+static inline void neo4j_session_reclaim(neo4j_session_t *session)
+{
+    neo4j_job_t *owner = session->owner;
+    if (owner != NULL)
+    {
+        session->owner = NULL;
+        neo4j_job_release_session(owner);
+    }
+}
+
+/**
+ * Get the pool of workers for decoding records received in a session.
+ *
+ * The workers are started on first use, and stopped when the session ends.
+ * Work must only be submitted by the thread using the session.
+ *
+ * @internal
+ *
+ * @param [session] The session.
+ * @return The worker pool, or `NULL` if no workers are configured or if the
+ *         workers could not be started (errno will be set).
+ */
+neo4j_worker_pool_t *neo4j_session_workers(neo4j_session_t *session);
+
 /**
  * Synchronize a session.
  *
@@ -112,6 +227,23 @@ int neo4j_detach_job(neo4j_session_t *session, neo4j_job_t *job);
 __neo4j_must_check
 int neo4j_session_sync(neo4j_session_t *session, const unsigned int *condition);
 
+/**
+ * Synchronize a session, on behalf of the job it is lent to.
+ *
+ * As for neo4j_session_sync(), but for use by the job from another thread
+ * (see neo4j_session_lend()).
+ *
+ * @internal
+ *
+ * @param [session] The session to synchronize.
+ * @param [condition] The condition to be met, which is indicated by the
+ *         value referenced by the pointer being zero.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_sync_exclusive(neo4j_session_t *session,
+        const unsigned int *condition);
+
 /**
  * Send a RUN message in a session.
  *
@@ -145,6 +277,50 @@ __neo4j_must_check
 int neo4j_session_pull_all(neo4j_session_t *session, neo4j_mpool_t *mpool,
         neo4j_response_recv_t callback, void *cdata);
 
+/**
+ * Send a PULL_ALL message in a session, receiving records undecoded.
+ *
+ * @internal
+ *
+ * @param [session] The session to send the message in.
+ * @param [mpool] The memory pool to use when sending and receiving.
+ * @param [callback] The callback to be invoked for responses, other than
+ *         RECORD messages.
+ * @param [record_callback] The callback to be invoked for RECORD messages.
+ * @param [cdata] Opaque data to be provided to the callbacks.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_pull_all_encoded(neo4j_session_t *session,
+        neo4j_mpool_t *mpool, neo4j_response_recv_t callback,
+        neo4j_record_recv_t record_callback, void *cdata);
+
+/**
+ * Send a PULL message in a session, receiving records undecoded.
+ *
+ * From version 4, the server sends at most `n` records at a time. The end of
+ * each batch is passed to the callback, which returns
+ * `NEO4J_REQUEST_BATCH_END` for the request to be sent again when further
+ * responses are awaited, or `NEO4J_REQUEST_BATCH_DISCARD` for the remaining
+ * records to be discarded.
+ *
+ * @internal
+ *
+ * @param [session] The session to send the message in.
+ * @param [mpool] The memory pool to use when sending and receiving.
+ * @param [n] The number of records to pull in each batch, or 0 to pull all
+ *         records at once.
+ * @param [callback] The callback to be invoked for responses, other than
+ *         RECORD messages.
+ * @param [record_callback] The callback to be invoked for RECORD messages.
+ * @param [cdata] Opaque data to be provided to the callbacks.
+ * @return 0 on success, -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_session_pull_encoded(neo4j_session_t *session,
+        neo4j_mpool_t *mpool, unsigned int n, neo4j_response_recv_t callback,
+        neo4j_record_recv_t record_callback, void *cdata);
+
 /**
  * Send a DISCARD_ALL message in a session.
  *
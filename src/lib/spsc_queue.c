@@ -0,0 +1,215 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "spsc_queue.h"
+#include "util.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+
+
+static bool has_space(neo4j_spsc_queue_t *queue);
+static bool has_item(neo4j_spsc_queue_t *queue);
+static void await_change(neo4j_spsc_queue_t *queue,
+        bool (*ready)(neo4j_spsc_queue_t *queue));
+static void wake(neo4j_spsc_queue_t *queue);
+static void wake_all(neo4j_spsc_queue_t *queue);
+
+
+neo4j_spsc_queue_t *neo4j_spsc_queue_new(unsigned int capacity)
+{
+    REQUIRE(capacity > 0, NULL);
+
+    neo4j_spsc_queue_t *queue = calloc(1, sizeof(neo4j_spsc_queue_t));
+    if (queue == NULL)
+    {
+        return NULL;
+    }
+    queue->slots = calloc(capacity, sizeof(void *));
+    if (queue->slots == NULL)
+    {
+        goto failure;
+    }
+    queue->capacity = capacity;
+    atomic_init(&(queue->head), 0);
+    atomic_init(&(queue->tail), 0);
+    atomic_init(&(queue->closed), false);
+    atomic_init(&(queue->shutdown), false);
+    atomic_init(&(queue->waiters), 0);
+
+    int err = neo4j_mutex_init(&(queue->mutex));
+    if (err != 0)
+    {
+        errno = err;
+        goto failure;
+    }
+    err = neo4j_cond_init(&(queue->cond));
+    if (err != 0)
+    {
+        neo4j_mutex_destroy(&(queue->mutex));
+        errno = err;
+        goto failure;
+    }
+    return queue;
+
+    int errsv;
+failure:
+    errsv = errno;
+    free(queue->slots);
+    free(queue);
+    errno = errsv;
+    return NULL;
+}
+
+
+void neo4j_spsc_queue_free(neo4j_spsc_queue_t *queue)
+{
+    if (queue == NULL)
+    {
+        return;
+    }
+    assert(atomic_load(&(queue->waiters)) == 0);
+    neo4j_cond_destroy(&(queue->cond));
+    neo4j_mutex_destroy(&(queue->mutex));
+    free(queue->slots);
+    free(queue);
+}
+
+
+int neo4j_spsc_queue_push(neo4j_spsc_queue_t *queue, void *item)
+{
+    assert(queue != NULL);
+    assert(item != NULL);
+    assert(!atomic_load(&(queue->closed)));
+
+    while (!has_space(queue))
+    {
+        await_change(queue, has_space);
+    }
+    if (atomic_load(&(queue->shutdown)))
+    {
+        errno = ECANCELED;
+        return -1;
+    }
+
+    unsigned int tail = atomic_load_explicit(&(queue->tail),
+            memory_order_relaxed);
+    queue->slots[tail % queue->capacity] = item;
+    atomic_store(&(queue->tail), tail + 1);
+    wake(queue);
+    return 0;
+}
+
+
+void *neo4j_spsc_queue_pop(neo4j_spsc_queue_t *queue)
+{
+    assert(queue != NULL);
+
+    void *item;
+    while ((item = neo4j_spsc_queue_try_pop(queue)) == NULL)
+    {
+        if (atomic_load(&(queue->closed)))
+        {
+            // all items are pushed before the queue is closed, so it must
+            // be checked again once found to be closed
+            return neo4j_spsc_queue_try_pop(queue);
+        }
+        await_change(queue, has_item);
+    }
+    return item;
+}
+
+
+void *neo4j_spsc_queue_try_pop(neo4j_spsc_queue_t *queue)
+{
+    assert(queue != NULL);
+    unsigned int head = atomic_load_explicit(&(queue->head),
+            memory_order_relaxed);
+    if (atomic_load(&(queue->tail)) == head)
+    {
+        return NULL;
+    }
+
+    void *item = queue->slots[head % queue->capacity];
+    atomic_store(&(queue->head), head + 1);
+    wake(queue);
+    return item;
+}
+
+
+void neo4j_spsc_queue_close(neo4j_spsc_queue_t *queue)
+{
+    assert(queue != NULL);
+    atomic_store(&(queue->closed), true);
+    wake_all(queue);
+}
+
+
+void neo4j_spsc_queue_shutdown(neo4j_spsc_queue_t *queue)
+{
+    assert(queue != NULL);
+    atomic_store(&(queue->shutdown), true);
+    wake_all(queue);
+}
+
+
+bool has_space(neo4j_spsc_queue_t *queue)
+{
+    return atomic_load(&(queue->tail)) - atomic_load(&(queue->head)) <
+        queue->capacity || atomic_load(&(queue->shutdown));
+}
+
+
+bool has_item(neo4j_spsc_queue_t *queue)
+{
+    return atomic_load(&(queue->tail)) != atomic_load(&(queue->head)) ||
+        atomic_load(&(queue->closed));
+}
+
+
+void await_change(neo4j_spsc_queue_t *queue,
+        bool (*ready)(neo4j_spsc_queue_t *queue))
+{
+    // the waiter is counted before the queue is checked, and the queue is
+    // updated before the waiters are checked, so either the waiting thread
+    // sees the update or the updating thread sees the waiter
+    neo4j_mutex_lock(&(queue->mutex));
+    atomic_fetch_add(&(queue->waiters), 1);
+    while (!ready(queue))
+    {
+        neo4j_cond_wait(&(queue->cond), &(queue->mutex));
+    }
+    atomic_fetch_sub(&(queue->waiters), 1);
+    neo4j_mutex_unlock(&(queue->mutex));
+}
+
+
+void wake(neo4j_spsc_queue_t *queue)
+{
+    if (atomic_load(&(queue->waiters)) > 0)
+    {
+        wake_all(queue);
+    }
+}
+
+
+void wake_all(neo4j_spsc_queue_t *queue)
+{
+    neo4j_mutex_lock(&(queue->mutex));
+    neo4j_cond_broadcast(&(queue->cond));
+    neo4j_mutex_unlock(&(queue->mutex));
+}
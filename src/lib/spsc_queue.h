@@ -0,0 +1,131 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NEO4J_SPSC_QUEUE_H
+#define NEO4J_SPSC_QUEUE_H
+
+#include "neo4j-client.h"
+#include "thread.h"
+#include <stdatomic.h>
+
+/*
+ * A bounded queue of pointers, passed from a single producer thread to a
+ * single consumer thread.
+ *
+ * Items are pushed and popped without locking. The mutex and condition are
+ * only used to park a thread waiting on a full or empty queue.
+ */
+typedef struct neo4j_spsc_queue neo4j_spsc_queue_t;
+struct neo4j_spsc_queue
+{
+    void **slots;
+    unsigned int capacity;
+    // free running counts of items pushed and popped
+    atomic_uint head;
+    atomic_uint tail;
+    // set by the producer once no further items will be pushed
+    atomic_bool closed;
+    // set by the consumer once no further items will be popped
+    atomic_bool shutdown;
+    atomic_uint waiters;
+    neo4j_mutex_t mutex;
+    neo4j_cond_t cond;
+};
+
+
+/**
+ * Create a queue.
+ *
+ * @internal
+ *
+ * @param [capacity] The maximum number of items held in the queue.
+ * @return The queue, or `NULL` on failure (errno will be set).
+ */
+__neo4j_must_check
+neo4j_spsc_queue_t *neo4j_spsc_queue_new(unsigned int capacity);
+
+/**
+ * Free a queue.
+ *
+ * Any items remaining in the queue are not freed.
+ *
+ * @internal
+ *
+ * @param [queue] The queue to free.
+ */
+void neo4j_spsc_queue_free(neo4j_spsc_queue_t *queue);
+
+/**
+ * Push an item onto a queue.
+ *
+ * Blocks whilst the queue is full.
+ *
+ * @internal
+ *
+ * @param [queue] The queue.
+ * @param [item] The item to push, which must not be `NULL`.
+ * @return 0 on success, or -1 if the consumer has shutdown the queue
+ *         (errno will be set to ECANCELED), in which case the item is not
+ *         pushed.
+ */
+__neo4j_must_check
+int neo4j_spsc_queue_push(neo4j_spsc_queue_t *queue, void *item);
+
+/**
+ * Pop an item from a queue.
+ *
+ * Blocks whilst the queue is empty.
+ *
+ * @internal
+ *
+ * @param [queue] The queue.
+ * @return The item, or `NULL` if the queue is empty and the producer has
+ *         closed it.
+ */
+void *neo4j_spsc_queue_pop(neo4j_spsc_queue_t *queue);
+
+/**
+ * Pop an item from a queue, without blocking.
+ *
+ * @internal
+ *
+ * @param [queue] The queue.
+ * @return The item, or `NULL` if the queue is empty.
+ */
+void *neo4j_spsc_queue_try_pop(neo4j_spsc_queue_t *queue);
+
+/**
+ * Close a queue, to indicate that the producer will push no further items.
+ *
+ * @internal
+ *
+ * @param [queue] The queue.
+ */
+void neo4j_spsc_queue_close(neo4j_spsc_queue_t *queue);
+
+/**
+ * Shutdown a queue, to indicate that the consumer will pop no further items
+ * (other than using neo4j_spsc_queue_try_pop()).
+ *
+ * Any blocked or subsequent push will fail.
+ *
+ * @internal
+ *
+ * @param [queue] The queue.
+ */
+void neo4j_spsc_queue_shutdown(neo4j_spsc_queue_t *queue);
+
+#endif/*NEO4J_SPSC_QUEUE_H*/
@@ -31,6 +31,16 @@ unsigned long neo4j_current_thread_id(void);
 #define neo4j_mutex_unlock pthread_mutex_unlock
 #define neo4j_mutex_destroy pthread_mutex_destroy
 
+#define neo4j_cond_t pthread_cond_t
+#define neo4j_cond_init(c) pthread_cond_init((c),NULL)
+#define neo4j_cond_wait pthread_cond_wait
+#define neo4j_cond_broadcast pthread_cond_broadcast
+#define neo4j_cond_destroy pthread_cond_destroy
+
+#define neo4j_thread_t pthread_t
+#define neo4j_thread_create(t,f,a) pthread_create((t),NULL,(f),(a))
+#define neo4j_thread_join(t) pthread_join((t),NULL)
+
 #define neo4j_once_t pthread_once_t
 #define NEO4J_ONCE_INIT PTHREAD_ONCE_INIT
 #define neo4j_thread_once(c,r) pthread_once((c),(r))
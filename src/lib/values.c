@@ -24,6 +24,7 @@
 #include <errno.h>
 #include <limits.h>
 #include <stddef.h>
+#include <string.h>
 
 
 static bool null_eq(const neo4j_value_t *value, const neo4j_value_t *other);
@@ -34,6 +35,12 @@ static bool string_eq(const neo4j_value_t *value, const neo4j_value_t *other);
 static bool list_eq(const neo4j_value_t *value, const neo4j_value_t *other);
 static bool map_eq(const neo4j_value_t *value, const neo4j_value_t *other);
 static bool struct_eq(const neo4j_value_t *value, const neo4j_value_t *other);
+static unsigned int map_index_capacity(unsigned int n);
+static uint32_t key_hash(neo4j_value_t key);
+static const neo4j_map_entry_t *indexed_map_find(const struct neo4j_map *map,
+        const char *ustring, uint32_t length, uint32_t hash);
+static inline bool key_matches(const neo4j_map_entry_t *entry,
+        const char *ustring, uint32_t length);
 
 
 /* types */
@@ -383,6 +390,17 @@ neo4j_value_t neo4j_ustring(const char *u, unsigned int n)
 }
 
 
+neo4j_value_t neo4j_inline_ustring(const char *u, unsigned int n)
+{
+    assert(n <= NEO4J_STRING_INLINE_LENGTH);
+    struct neo4j_string v =
+        { ._type = NEO4J_STRING, ._vt_off = STRING_VT_OFF,
+          .flags = NEO4J_STRING_INLINE, .length = n };
+    memcpy(v.inline_ustring, u, n);
+    return *((neo4j_value_t *)(&v));
+}
+
+
 bool string_eq(const neo4j_value_t *value, const neo4j_value_t *other)
 {
     const struct neo4j_string *v = (const struct neo4j_string *)value;
@@ -391,7 +409,14 @@ bool string_eq(const neo4j_value_t *value, const neo4j_value_t *other)
     {
         return false;
     }
-    return strncmp(v->ustring, o->ustring, v->length) == 0;
+    const char *vs = neo4j_string_content(v);
+    const char *os = neo4j_string_content(o);
+    // interned strings share their content
+    if (vs == os)
+    {
+        return true;
+    }
+    return strncmp(vs, os, v->length) == 0;
 }
 
 
@@ -405,7 +430,18 @@ unsigned int neo4j_string_length(neo4j_value_t value)
 const char *neo4j_ustring_value(neo4j_value_t value)
 {
     REQUIRE(neo4j_type(value) == NEO4J_STRING, NULL);
-    return ((const struct neo4j_string *)&value)->ustring;
+    const struct neo4j_string *v = (const struct neo4j_string *)&value;
+    // inline content would not outlive this copy of the value
+    REQUIRE(!(v->flags & NEO4J_STRING_INLINE), NULL);
+    return v->ustring;
+}
+
+
+const char *neo4j_ustring_pointer(const neo4j_value_t *value)
+{
+    REQUIRE(value != NULL, NULL);
+    REQUIRE(neo4j_type(*value) == NEO4J_STRING, NULL);
+    return neo4j_string_content((const struct neo4j_string *)value);
 }
 
 
@@ -414,7 +450,7 @@ char *neo4j_string_value(neo4j_value_t value, char *buffer, size_t length)
     REQUIRE(neo4j_type(value) == NEO4J_STRING, NULL);
     const struct neo4j_string *v = (const struct neo4j_string *)&value;
     size_t tocopy = min(v->length, length-1);
-    memcpy(buffer, v->ustring, tocopy);
+    memcpy(buffer, neo4j_string_content(v), tocopy);
     buffer[tocopy] = '\0';
     return buffer;
 }
@@ -430,10 +466,45 @@ neo4j_value_t neo4j_list(const neo4j_value_t *items, unsigned int n)
         n = UINT32_MAX;
     }
 #endif
-    struct neo4j_list v =
-        { ._type = NEO4J_LIST, ._vt_off = LIST_VT_OFF,
-          .items = items, .length = n };
-    return *((neo4j_value_t *)(&v));
+    neo4j_value_t v = { ._type = NEO4J_LIST, ._vt_off = LIST_VT_OFF };
+    struct neo4j_list *list = (struct neo4j_list *)&v;
+    list->length = n;
+    list->items = items;
+    return v;
+}
+
+
+neo4j_value_t neo4j_int_list(const int64_t *values, unsigned int n)
+{
+#if UINT_MAX != UINT32_MAX
+    if (n > UINT32_MAX)
+    {
+        n = UINT32_MAX;
+    }
+#endif
+    neo4j_value_t v = { ._type = NEO4J_LIST, ._vt_off = LIST_VT_OFF };
+    struct neo4j_list *list = (struct neo4j_list *)&v;
+    list->flags = NEO4J_LIST_PACKED_INTS;
+    list->length = n;
+    list->ints = values;
+    return v;
+}
+
+
+neo4j_value_t neo4j_float_list(const double *values, unsigned int n)
+{
+#if UINT_MAX != UINT32_MAX
+    if (n > UINT32_MAX)
+    {
+        n = UINT32_MAX;
+    }
+#endif
+    neo4j_value_t v = { ._type = NEO4J_LIST, ._vt_off = LIST_VT_OFF };
+    struct neo4j_list *list = (struct neo4j_list *)&v;
+    list->flags = NEO4J_LIST_PACKED_FLOATS;
+    list->length = n;
+    list->floats = values;
+    return v;
 }
 
 
@@ -447,9 +518,16 @@ bool list_eq(const neo4j_value_t *value, const neo4j_value_t *other)
         return false;
     }
 
+    if ((v->flags & NEO4J_LIST_PACKED_INTS) &&
+            (o->flags & NEO4J_LIST_PACKED_INTS))
+    {
+        return v->length == 0 ||
+            memcmp(v->ints, o->ints, v->length * sizeof(int64_t)) == 0;
+    }
+
     for (unsigned int i = 0; i < v->length; ++i)
     {
-        if (!neo4j_eq(v->items[i], o->items[i]))
+        if (!neo4j_eq(neo4j_list_item(v, i), neo4j_list_item(o, i)))
         {
             return false;
         }
@@ -474,7 +552,31 @@ neo4j_value_t neo4j_list_get(neo4j_value_t value, unsigned int index)
     {
         return neo4j_null;
     }
-    return list->items[index];
+    return neo4j_list_item(list, index);
+}
+
+
+const int64_t *neo4j_list_int_values(neo4j_value_t value)
+{
+    REQUIRE(neo4j_type(value) == NEO4J_LIST, NULL);
+    const struct neo4j_list *list = (const struct neo4j_list *)&value;
+    if (!(list->flags & NEO4J_LIST_PACKED_INTS) || list->length == 0)
+    {
+        return NULL;
+    }
+    return list->ints;
+}
+
+
+const double *neo4j_list_float_values(neo4j_value_t value)
+{
+    REQUIRE(neo4j_type(value) == NEO4J_LIST, NULL);
+    const struct neo4j_list *list = (const struct neo4j_list *)&value;
+    if (!(list->flags & NEO4J_LIST_PACKED_FLOATS) || list->length == 0)
+    {
+        return NULL;
+    }
+    return list->floats;
 }
 
 
@@ -504,6 +606,98 @@ neo4j_value_t neo4j_map(const neo4j_map_entry_t *entries, unsigned int n)
 }
 
 
+/*
+ * The index is an open addressed hash table, at most half full, where each
+ * slot holds the hash of a key and the position of its entry (plus one, so
+ * that empty slots are zero).
+ */
+struct map_index_slot
+{
+    uint32_t hash;
+    uint32_t entry;
+};
+
+
+size_t neo4j_map_index_size(unsigned int n)
+{
+    if (n < NEO4J_MAP_INDEX_THRESHOLD || n > (UINT32_MAX >> 2))
+    {
+        return 0;
+    }
+    return map_index_capacity(n) * sizeof(struct map_index_slot);
+}
+
+
+unsigned int map_index_capacity(unsigned int n)
+{
+    unsigned int capacity = NEO4J_MAP_INDEX_THRESHOLD << 1;
+    while (capacity < (n << 1))
+    {
+        capacity <<= 1;
+    }
+    return capacity;
+}
+
+
+neo4j_value_t neo4j_indexed_map(neo4j_map_entry_t *entries, unsigned int n)
+{
+    neo4j_value_t v = neo4j_map(entries, n);
+    if (neo4j_is_null(v) || neo4j_map_index_size(n) == 0)
+    {
+        return v;
+    }
+
+    struct map_index_slot *slots = (struct map_index_slot *)(entries + n);
+    unsigned int mask = map_index_capacity(n) - 1;
+    memset(slots, 0, (mask + 1) * sizeof(struct map_index_slot));
+    uint16_t flags = NEO4J_MAP_INDEXED;
+
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        uint32_t hash = key_hash(entries[i].key);
+        unsigned int j = hash & mask;
+        for (; slots[j].entry != 0; j = (j + 1) & mask)
+        {
+            // as when searching the entries, the first duplicate is found
+            if (slots[j].hash == hash &&
+                    neo4j_eq(entries[slots[j].entry - 1].key, entries[i].key))
+            {
+                flags |= NEO4J_MAP_DUPLICATE_KEYS;
+                break;
+            }
+        }
+        if (slots[j].entry == 0)
+        {
+            slots[j].hash = hash;
+            slots[j].entry = i + 1;
+        }
+    }
+
+    ((struct neo4j_map *)&v)->flags |= flags;
+    return v;
+}
+
+
+uint32_t key_hash(neo4j_value_t key)
+{
+    const struct neo4j_string *s = (const struct neo4j_string *)&key;
+    return neo4j_ustring_hash(neo4j_string_content(s), s->length);
+}
+
+
+uint32_t neo4j_ustring_hash(const char *ustring, uint32_t length)
+{
+    // FNV-1a, up to any NUL as strings are compared with strncmp(3)
+    const uint8_t *c = (const uint8_t *)ustring;
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < length && c[i] != '\0'; ++i)
+    {
+        hash = (hash ^ c[i]) * 16777619u;
+    }
+    return hash;
+}
+
+
 bool map_eq(const neo4j_value_t *value, const neo4j_value_t *other)
 {
     const struct neo4j_map *v = (const struct neo4j_map *)value;
@@ -561,6 +755,19 @@ neo4j_value_t neo4j_map_kget(neo4j_value_t value, neo4j_value_t key)
     REQUIRE(neo4j_type(value) == NEO4J_MAP, neo4j_null);
     const struct neo4j_map *map = (const struct neo4j_map *)&value;
 
+    if (map->flags & NEO4J_MAP_INDEXED)
+    {
+        if (neo4j_type(key) != NEO4J_STRING)
+        {
+            // all keys in a map are strings
+            return neo4j_null;
+        }
+        const struct neo4j_string *s = (const struct neo4j_string *)&key;
+        const neo4j_map_entry_t *entry = indexed_map_find(map, neo4j_string_content(s),
+                s->length, key_hash(key));
+        return (entry != NULL)? entry->value : neo4j_null;
+    }
+
     for (unsigned int i = 0; i < map->nentries; ++i)
     {
         const neo4j_map_entry_t *entry = &(map->entries[i]);
@@ -573,6 +780,92 @@ neo4j_value_t neo4j_map_kget(neo4j_value_t value, neo4j_value_t key)
 }
 
 
+const neo4j_map_entry_t *indexed_map_find(const struct neo4j_map *map,
+        const char *ustring, uint32_t length, uint32_t hash)
+{
+    const struct map_index_slot *slots =
+        (const struct map_index_slot *)(map->entries + map->nentries);
+    unsigned int mask = map_index_capacity(map->nentries) - 1;
+
+    for (unsigned int j = hash & mask; slots[j].entry != 0;
+            j = (j + 1) & mask)
+    {
+        const neo4j_map_entry_t *entry = &(map->entries[slots[j].entry - 1]);
+        if (slots[j].hash == hash && key_matches(entry, ustring, length))
+        {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+
+bool key_matches(const neo4j_map_entry_t *entry, const char *ustring,
+        uint32_t length)
+{
+    const struct neo4j_string *k = (const struct neo4j_string *)&(entry->key);
+    return neo4j_type(entry->key) == NEO4J_STRING && k->length == length &&
+        strncmp(neo4j_string_content(k), ustring, length) == 0;
+}
+
+
+neo4j_key_t neo4j_key(const char *key)
+{
+    size_t length = strlen(key);
+#if SIZE_MAX > UINT32_MAX
+    if (length > UINT32_MAX)
+    {
+        length = UINT32_MAX;
+    }
+#endif
+    neo4j_key_t k = { ._ustring = key, ._length = length,
+        ._hash = neo4j_ustring_hash(key, length), ._hint = 0 };
+    return k;
+}
+
+
+neo4j_value_t neo4j_map_hget(neo4j_value_t value, neo4j_key_t *key)
+{
+    REQUIRE(neo4j_type(value) == NEO4J_MAP, neo4j_null);
+    REQUIRE(key != NULL, neo4j_null);
+    const struct neo4j_map *map = (const struct neo4j_map *)&value;
+
+    if (!(map->flags & NEO4J_MAP_INDEXED))
+    {
+        // as for neo4j_map_kget(), the first entry with the key is returned,
+        // which is found as quickly by searching from the start
+        for (unsigned int i = 0; i < map->nentries; ++i)
+        {
+            if (key_matches(&(map->entries[i]), key->_ustring, key->_length))
+            {
+                return map->entries[i].value;
+            }
+        }
+        return neo4j_null;
+    }
+
+    // maps of the same shape usually have their keys in the same order, so
+    // the entry where the key was last found is checked first, unless a
+    // duplicate of the key could precede it
+    if (!(map->flags & NEO4J_MAP_DUPLICATE_KEYS) &&
+            key->_hint < map->nentries &&
+            key_matches(&(map->entries[key->_hint]), key->_ustring,
+                key->_length))
+    {
+        return map->entries[key->_hint].value;
+    }
+
+    const neo4j_map_entry_t *entry = indexed_map_find(map, key->_ustring,
+            key->_length, key->_hash);
+    if (entry == NULL)
+    {
+        return neo4j_null;
+    }
+    key->_hint = entry - map->entries;
+    return entry->value;
+}
+
+
 neo4j_map_entry_t neo4j_map_kentry(neo4j_value_t key, neo4j_value_t value)
 {
     struct neo4j_map_entry entry = { .key = key, .value = value };
@@ -81,35 +81,103 @@ struct neo4j_string
 {
     uint8_t _vt_off;
     uint8_t _type;
-    uint16_t _pad1;
+    uint16_t flags;
     uint32_t length;
     union {
         const void *ustring;
+        char inline_ustring[sizeof(union _neo4j_value_data)];
         union _neo4j_value_data _pad2;
     };
 };
 ASSERT_VALUE_ALIGNMENT(struct neo4j_string);
 
+// set when the content is held in the value, rather than referenced
+#define NEO4J_STRING_INLINE 0x1
+
+#define NEO4J_STRING_INLINE_LENGTH \
+    (sizeof(((struct neo4j_string *)NULL)->inline_ustring))
+
+/**
+ * Construct a neo4j value encoding a String, holding the content inline.
+ *
+ * The content is copied into the value itself, so no memory is
+ * referenced. As the value is passed by copy to neo4j_ustring_value(), the
+ * content must instead be accessed using neo4j_ustring_pointer().
+ *
+ * @internal
+ *
+ * @param [u] The UTF-8 string.
+ * @param [n] The length of the string, which must be no greater than
+ *         `NEO4J_STRING_INLINE_LENGTH`.
+ * @return A neo4j value encoding the String.
+ */
+neo4j_value_t neo4j_inline_ustring(const char *u, unsigned int n);
+
+/**
+ * Get the content of a string value.
+ *
+ * @internal
+ *
+ * @param [v] The string value.
+ * @return A pointer to the content, which is within the value if held
+ *         inline.
+ */
+static inline const char *neo4j_string_content(const struct neo4j_string *v)
+{
+    return (v->flags & NEO4J_STRING_INLINE)? v->inline_ustring : v->ustring;
+}
+
 
 struct neo4j_list
 {
     uint8_t _vt_off;
     uint8_t _type;
-    uint16_t _pad1;
+    uint16_t flags;
     uint32_t length;
     union {
         const neo4j_value_t *items;
+        const int64_t *ints;
+        const double *floats;
         union _neo4j_value_data _pad2;
     };
 };
 ASSERT_VALUE_ALIGNMENT(struct neo4j_list);
 
+// set when the items are held as an array of integers or floats, rather
+// than of neo4j values
+#define NEO4J_LIST_PACKED_INTS 0x1
+#define NEO4J_LIST_PACKED_FLOATS 0x2
+
+/**
+ * Get an item from a list.
+ *
+ * @internal
+ *
+ * @param [list] The list.
+ * @param [index] The index of the item, which must be within the list.
+ * @return The item, constructed as a neo4j value if the list is packed.
+ */
+static inline neo4j_value_t neo4j_list_item(const struct neo4j_list *list,
+        unsigned int index)
+{
+    assert(index < list->length);
+    if (list->flags & NEO4J_LIST_PACKED_INTS)
+    {
+        return neo4j_int(list->ints[index]);
+    }
+    if (list->flags & NEO4J_LIST_PACKED_FLOATS)
+    {
+        return neo4j_float(list->floats[index]);
+    }
+    return list->items[index];
+}
+
 
 struct neo4j_map
 {
     uint8_t _vt_off;
     uint8_t _type;
-    uint16_t _pad1;
+    uint16_t flags;
     uint32_t nentries;
     union {
         const neo4j_map_entry_t *entries;
@@ -118,6 +186,56 @@ struct neo4j_map
 };
 ASSERT_VALUE_ALIGNMENT(struct neo4j_map);
 
+// set when a hash index of the keys follows the entries
+#define NEO4J_MAP_INDEXED 0x1
+// set when an indexed map has more than one entry with the same key
+#define NEO4J_MAP_DUPLICATE_KEYS 0x2
+
+#define NEO4J_MAP_INDEX_THRESHOLD 16
+
+/**
+ * Get the space required for a hash index of map keys.
+ *
+ * Maps with fewer than `NEO4J_MAP_INDEX_THRESHOLD` entries are not indexed.
+ *
+ * @internal
+ *
+ * @param [n] The number of entries in the map.
+ * @return The number of bytes to allocate after the entries, or 0 if the
+ *         map should not be indexed.
+ */
+__neo4j_pure
+size_t neo4j_map_index_size(unsigned int n);
+
+/**
+ * Construct a neo4j value encoding a map, indexed by key.
+ *
+ * The index is built in the space following the entries, which must be
+ * that given by neo4j_map_index_size(), and neo4j_map_kget() will then use
+ * it to find entries without comparing each key.
+ *
+ * @internal
+ *
+ * @param [entries] The entries, which must be followed by space for the
+ *         index.
+ * @param [n] The number of entries.
+ * @return The neo4j value encoding the map, or #neo4j_null if a key is not
+ *         a String (errno will be set to NEO4J_INVALID_MAP_KEY_TYPE).
+ */
+neo4j_value_t neo4j_indexed_map(neo4j_map_entry_t *entries, unsigned int n);
+
+/**
+ * Hash a string, as when indexing map keys.
+ *
+ * @internal
+ *
+ * @param [ustring] The string, which need not be `NULL` terminated.
+ * @param [length] The length of the string.
+ * @return The hash.
+ */
+__neo4j_pure
+uint32_t neo4j_ustring_hash(const char *ustring, uint32_t length);
+
 
 #define NEO4J_NODE_SIGNATURE 0x4E
 #define NEO4J_REL_SIGNATURE 0x52
@@ -0,0 +1,191 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../../config.h"
+#include "worker_pool.h"
+#include "util.h"
+#include <assert.h>
+#include <errno.h>
+#include <stdlib.h>
+
+
+struct worker
+{
+    neo4j_worker_pool_t *pool;
+    neo4j_spsc_queue_t *queue;
+};
+
+
+static void *work(void *data);
+static void stop_workers(neo4j_worker_pool_t *pool, unsigned int n);
+
+
+neo4j_worker_pool_t *neo4j_worker_pool_new(unsigned int nworkers)
+{
+    REQUIRE(nworkers > 0, NULL);
+
+    neo4j_worker_pool_t *pool = calloc(1, sizeof(neo4j_worker_pool_t));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+    atomic_init(&(pool->waiters), 0);
+
+    int err = neo4j_mutex_init(&(pool->mutex));
+    if (err != 0)
+    {
+        free(pool);
+        errno = err;
+        return NULL;
+    }
+    err = neo4j_cond_init(&(pool->cond));
+    if (err != 0)
+    {
+        neo4j_mutex_destroy(&(pool->mutex));
+        free(pool);
+        errno = err;
+        return NULL;
+    }
+
+    pool->threads = calloc(nworkers, sizeof(neo4j_thread_t));
+    pool->queues = calloc(nworkers, sizeof(neo4j_spsc_queue_t *));
+    if (pool->threads == NULL || pool->queues == NULL)
+    {
+        goto failure;
+    }
+
+    for (; pool->nworkers < nworkers; ++(pool->nworkers))
+    {
+        unsigned int i = pool->nworkers;
+        pool->queues[i] = neo4j_spsc_queue_new(NEO4J_WORKER_QUEUE_SIZE);
+        if (pool->queues[i] == NULL)
+        {
+            goto failure;
+        }
+        struct worker *worker = malloc(sizeof(struct worker));
+        if (worker == NULL)
+        {
+            neo4j_spsc_queue_free(pool->queues[i]);
+            goto failure;
+        }
+        worker->pool = pool;
+        worker->queue = pool->queues[i];
+        err = neo4j_thread_create(&(pool->threads[i]), work, worker);
+        if (err != 0)
+        {
+            free(worker);
+            neo4j_spsc_queue_free(pool->queues[i]);
+            errno = err;
+            goto failure;
+        }
+    }
+    return pool;
+
+    int errsv;
+failure:
+    errsv = errno;
+    neo4j_worker_pool_free(pool);
+    errno = errsv;
+    return NULL;
+}
+
+
+void neo4j_worker_pool_free(neo4j_worker_pool_t *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+    stop_workers(pool, pool->nworkers);
+    neo4j_cond_destroy(&(pool->cond));
+    neo4j_mutex_destroy(&(pool->mutex));
+    free(pool->threads);
+    free(pool->queues);
+    free(pool);
+}
+
+
+void stop_workers(neo4j_worker_pool_t *pool, unsigned int n)
+{
+    // each worker completes the work already queued before exiting
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        neo4j_spsc_queue_close(pool->queues[i]);
+    }
+    for (unsigned int i = 0; i < n; ++i)
+    {
+        neo4j_thread_join(pool->threads[i]);
+        neo4j_spsc_queue_free(pool->queues[i]);
+    }
+}
+
+
+int neo4j_worker_pool_submit(neo4j_worker_pool_t *pool, neo4j_work_t *work)
+{
+    REQUIRE(pool != NULL, -1);
+    REQUIRE(work != NULL, -1);
+
+    atomic_init(&(work->done), false);
+    neo4j_spsc_queue_t *queue = pool->queues[pool->next];
+    pool->next = (pool->next + 1) % pool->nworkers;
+    return neo4j_spsc_queue_push(queue, work);
+}
+
+
+void neo4j_worker_pool_await(neo4j_worker_pool_t *pool, neo4j_work_t *work)
+{
+    assert(pool != NULL);
+    assert(work != NULL);
+    if (atomic_load(&(work->done)))
+    {
+        return;
+    }
+
+    // as in the queues, the waiter is counted before the work is checked
+    // and the work is completed before the waiters are checked
+    neo4j_mutex_lock(&(pool->mutex));
+    atomic_fetch_add(&(pool->waiters), 1);
+    while (!atomic_load(&(work->done)))
+    {
+        neo4j_cond_wait(&(pool->cond), &(pool->mutex));
+    }
+    atomic_fetch_sub(&(pool->waiters), 1);
+    neo4j_mutex_unlock(&(pool->mutex));
+}
+
+
+void *work(void *data)
+{
+    struct worker *worker = (struct worker *)data;
+    neo4j_worker_pool_t *pool = worker->pool;
+    neo4j_spsc_queue_t *queue = worker->queue;
+    free(worker);
+
+    neo4j_work_t *work;
+    while ((work = neo4j_spsc_queue_pop(queue)) != NULL)
+    {
+        work->run(work);
+        // the work may be released as soon as it is done
+        atomic_store(&(work->done), true);
+        if (atomic_load(&(pool->waiters)) > 0)
+        {
+            neo4j_mutex_lock(&(pool->mutex));
+            neo4j_cond_broadcast(&(pool->cond));
+            neo4j_mutex_unlock(&(pool->mutex));
+        }
+    }
+    return NULL;
+}
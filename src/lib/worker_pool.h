@@ -0,0 +1,102 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef NEO4J_WORKER_POOL_H
+#define NEO4J_WORKER_POOL_H
+
+#include "neo4j-client.h"
+#include "spsc_queue.h"
+#include "thread.h"
+#include <stdatomic.h>
+
+#define NEO4J_WORKER_QUEUE_SIZE 64
+
+typedef struct neo4j_work neo4j_work_t;
+struct neo4j_work
+{
+    void (*run)(neo4j_work_t *self);
+    atomic_bool done;
+};
+
+/*
+ * A pool of threads performing work submitted from one thread at a time.
+ *
+ * Each worker has its own queue, and work is distributed between them in
+ * turn, so submission never contends with other submitters.
+ */
+typedef struct neo4j_worker_pool neo4j_worker_pool_t;
+struct neo4j_worker_pool
+{
+    unsigned int nworkers;
+    neo4j_thread_t *threads;
+    neo4j_spsc_queue_t **queues;
+    unsigned int next;
+    // threads awaiting completion of work
+    atomic_uint waiters;
+    neo4j_mutex_t mutex;
+    neo4j_cond_t cond;
+};
+
+
+/**
+ * Create a worker pool.
+ *
+ * @internal
+ *
+ * @param [nworkers] The number of worker threads.
+ * @return The worker pool, or `NULL` on failure (errno will be set).
+ */
+__neo4j_must_check
+neo4j_worker_pool_t *neo4j_worker_pool_new(unsigned int nworkers);
+
+/**
+ * Free a worker pool.
+ *
+ * Returns once all submitted work has completed.
+ *
+ * @internal
+ *
+ * @param [pool] The worker pool to free.
+ */
+void neo4j_worker_pool_free(neo4j_worker_pool_t *pool);
+
+/**
+ * Submit work to a worker pool.
+ *
+ * Blocks if the queue of the next worker is full. Work must only be
+ * submitted from one thread at a time.
+ *
+ * @internal
+ *
+ * @param [pool] The worker pool.
+ * @param [work] The work to perform, which must remain valid until it has
+ *         completed.
+ * @return 0 on success, or -1 on failure (errno will be set).
+ */
+__neo4j_must_check
+int neo4j_worker_pool_submit(neo4j_worker_pool_t *pool, neo4j_work_t *work);
+
+/**
+ * Wait for submitted work to complete.
+ *
+ * @internal
+ *
+ * @param [pool] The worker pool the work was submitted to.
+ * @param [work] The work.
+ */
+void neo4j_worker_pool_await(neo4j_worker_pool_t *pool, neo4j_work_t *work);
+
+#endif/*NEO4J_WORKER_POOL_H*/
@@ -55,7 +55,9 @@ static const struct neo4j_failure_details *crs_failure_details(
 static unsigned int crs_nfields(neo4j_result_stream_t *self);
 static const char *crs_fieldname(neo4j_result_stream_t *self,
         unsigned int index);
-static neo4j_result_t *crs_fetch_next(neo4j_result_stream_t *self);
+static int crs_set_projection(neo4j_result_stream_t *self,
+        const unsigned int *field_indices, unsigned int n);
+neo4j_result_t *crs_fetch_next(neo4j_result_stream_t *self);
 static int crs_close(neo4j_result_stream_t *self);
 static neo4j_value_t cr_canned_field(const neo4j_result_t *self,
         unsigned int index);
@@ -96,8 +98,10 @@ neo4j_result_stream_t *neo4j_canned_result_stream(
     rs->failure_details = crs_failure_details;
     rs->nfields = crs_nfields;
     rs->fieldname = crs_fieldname;
+    rs->set_projection = crs_set_projection;
     rs->fetch_next = crs_fetch_next;
     rs->close = crs_close;
+    rs->cancel = crs_close;
     return rs;
 }
 
@@ -164,6 +168,14 @@ const char *crs_fieldname(neo4j_result_stream_t *self,
 }
 
 
+int crs_set_projection(neo4j_result_stream_t *self,
+        const unsigned int *field_indices, unsigned int n)
+{
+    // canned records are already decoded
+    return 0;
+}
+
+
 neo4j_result_t *crs_fetch_next(neo4j_result_stream_t *self)
 {
     canned_result_stream_t *crs = container_of(self,
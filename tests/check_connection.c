@@ -130,7 +130,8 @@ START_TEST (test_connects_URI_and_establishes_protocol)
     rb_extract(out_rb, hello, 4);
     ck_assert(memcmp(hello, expected_hello, 4) == 0);
 
-    uint32_t expected_versions[4] = { htonl(1), 0, 0, 0 };
+    uint32_t expected_versions[4] =
+        { htonl(0x00040405), htonl(0x00040404), htonl(3), htonl(1) };
     uint32_t versions[4];
     rb_extract(out_rb, versions, 16);
     ck_assert(memcmp(versions, expected_versions, 16) == 0);
@@ -178,7 +179,8 @@ START_TEST (test_connects_URI_containing_credentials)
     rb_extract(out_rb, hello, 4);
     ck_assert(memcmp(hello, expected_hello, 4) == 0);
 
-    uint32_t expected_versions[4] = { htonl(1), 0, 0, 0 };
+    uint32_t expected_versions[4] =
+        { htonl(0x00040405), htonl(0x00040404), htonl(3), htonl(1) };
     uint32_t versions[4];
     rb_extract(out_rb, versions, 16);
     ck_assert(memcmp(versions, expected_versions, 16) == 0);
@@ -212,7 +214,8 @@ START_TEST (test_connects_tcp_and_establishes_protocol)
     rb_extract(out_rb, hello, 4);
     ck_assert(memcmp(hello, expected_hello, 4) == 0);
 
-    uint32_t expected_versions[4] = { htonl(1), 0, 0, 0 };
+    uint32_t expected_versions[4] =
+        { htonl(0x00040405), htonl(0x00040404), htonl(3), htonl(1) };
     uint32_t versions[4];
     rb_extract(out_rb, versions, 16);
     ck_assert(memcmp(versions, expected_versions, 16) == 0);
@@ -259,6 +262,152 @@ START_TEST (test_fails_if_unknown_protocol)
 END_TEST
 
 
+START_TEST (test_negotiates_minor_protocol_version)
+{
+    uint32_t version = htonl(0x0404);
+    rb_append(in_rb, &version, sizeof(version));
+
+    neo4j_connection_t *connection = neo4j_connect(
+            "neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(connection, NULL);
+    ck_assert_int_eq(connection->version, 4);
+    ck_assert_int_eq(connection->minor_version, 4);
+    ck_assert(connection->messages->pull_all == NEO4J_PULL_MESSAGE);
+
+    neo4j_close(connection);
+}
+END_TEST
+
+
+START_TEST (test_fails_if_unsupported_minor_protocol_version)
+{
+    neo4j_config_set_logger_provider(config, NULL);
+
+    uint32_t version = htonl(0x0904);
+    rb_append(in_rb, &version, sizeof(version));
+
+    neo4j_connection_t *connection = neo4j_connect(
+            "neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_eq(connection, NULL);
+    ck_assert_int_eq(errno, NEO4J_PROTOCOL_NEGOTIATION_FAILED);
+}
+END_TEST
+
+
+START_TEST (test_sends_goodbye_on_close)
+{
+    uint32_t version = htonl(3);
+    rb_append(in_rb, &version, sizeof(version));
+
+    neo4j_connection_t *connection = neo4j_connect(
+            "neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(connection, NULL);
+    rb_discard(out_rb, 4 + (4 * sizeof(uint32_t)));
+
+    ck_assert_int_eq(neo4j_close(connection), 0);
+
+    uint8_t expected_goodbye[] = { 0x00, 0x02, 0xB0, 0x02, 0x00, 0x00 };
+    uint8_t goodbye[sizeof(expected_goodbye)];
+    ck_assert_int_eq(rb_used(out_rb), sizeof(goodbye));
+    rb_extract(out_rb, goodbye, sizeof(goodbye));
+    ck_assert(memcmp(goodbye, expected_goodbye, sizeof(goodbye)) == 0);
+}
+END_TEST
+
+
+START_TEST (test_receives_message_split_over_chunks)
+{
+    uint32_t version = htonl(1);
+    rb_append(in_rb, &version, sizeof(version));
+
+    neo4j_connection_t *connection = neo4j_connect(
+            "neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(connection, NULL);
+
+    // SUCCESS { "a": "bcdef" }, split over 3 chunks and preceded by a noop
+    uint8_t chunks[] =
+            { 0x00, 0x00,
+              0x00, 0x03, 0xB1, 0x70, 0xA1,
+              0x00, 0x04, 0x81, 0x61, 0x85, 0x62,
+              0x00, 0x04, 0x63, 0x64, 0x65, 0x66,
+              0x00, 0x00 };
+    rb_append(in_rb, chunks, sizeof(chunks));
+    rb_append(in_rb, chunks + 2, sizeof(chunks) - 2);
+
+    neo4j_mpool_t mpool = neo4j_std_mpool(config);
+    for (int i = 0; i < 2; ++i)
+    {
+        neo4j_message_type_t type;
+        const neo4j_value_t *argv;
+        uint16_t argc;
+        int result = neo4j_connection_recv(connection, &mpool,
+                &type, &argv, &argc, NULL, NULL);
+        ck_assert_int_eq(result, 0);
+        ck_assert(type == NEO4J_SUCCESS_MESSAGE);
+        ck_assert_int_eq(argc, 1);
+        ck_assert(neo4j_type(argv[0]) == NEO4J_MAP);
+
+        char buf[16];
+        ck_assert_str_eq(neo4j_string_value(
+                    neo4j_map_get(argv[0], "a"), buf, sizeof(buf)), "bcdef");
+    }
+    ck_assert_int_eq(rb_used(in_rb), 0);
+    ck_assert_ptr_ne(connection->rcv_buffer, NULL);
+
+    neo4j_mpool_drain(&mpool);
+    neo4j_close(connection);
+}
+END_TEST
+
+
+START_TEST (test_receives_zero_copy_strings)
+{
+    neo4j_config_set_zero_copy_strings(config, true);
+
+    uint32_t version = htonl(1);
+    rb_append(in_rb, &version, sizeof(version));
+
+    neo4j_connection_t *connection = neo4j_connect(
+            "neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(connection, NULL);
+
+    // RECORD [ "bernie" ], sent twice
+    uint8_t chunks[] =
+            { 0x00, 0x0A, 0xB1, 0x71, 0x91, 0x86, 0x62, 0x65,
+              0x72, 0x6e, 0x69, 0x65, 0x00, 0x00 };
+    rb_append(in_rb, chunks, sizeof(chunks));
+    rb_append(in_rb, chunks, sizeof(chunks));
+
+    neo4j_mpool_t mpool1 = neo4j_std_mpool(config);
+    neo4j_mpool_t mpool2 = neo4j_std_mpool(config);
+    neo4j_message_type_t type;
+    const neo4j_value_t *argv1;
+    const neo4j_value_t *argv2;
+    int result = neo4j_connection_recv(connection, &mpool1,
+            &type, &argv1, NULL, NULL, NULL);
+    ck_assert_int_eq(result, 0);
+    ck_assert(type == NEO4J_RECORD_MESSAGE);
+    result = neo4j_connection_recv(connection, &mpool2,
+            &type, &argv2, NULL, NULL, NULL);
+    ck_assert_int_eq(result, 0);
+    ck_assert(type == NEO4J_RECORD_MESSAGE);
+
+    neo4j_value_t s1 = neo4j_list_get(argv1[0], 0);
+    neo4j_value_t s2 = neo4j_list_get(argv2[0], 0);
+    ck_assert(neo4j_type(s1) == NEO4J_STRING);
+    ck_assert(neo4j_type(s2) == NEO4J_STRING);
+    ck_assert_ptr_ne(neo4j_ustring_value(s1), neo4j_ustring_value(s2));
+
+    neo4j_mpool_drain(&mpool2);
+    char buf[16];
+    ck_assert_str_eq(neo4j_string_value(s1, buf, sizeof(buf)), "bernie");
+
+    neo4j_mpool_drain(&mpool1);
+    neo4j_close(connection);
+}
+END_TEST
+
+
 TCase* connection_tcase(void)
 {
     TCase *tc = tcase_create("connection");
@@ -271,5 +420,10 @@ TCase* connection_tcase(void)
     tcase_add_test(tc, test_connects_tcp_and_establishes_protocol);
     tcase_add_test(tc, test_fails_if_connection_factory_fails);
     tcase_add_test(tc, test_fails_if_unknown_protocol);
+    tcase_add_test(tc, test_negotiates_minor_protocol_version);
+    tcase_add_test(tc, test_fails_if_unsupported_minor_protocol_version);
+    tcase_add_test(tc, test_sends_goodbye_on_close);
+    tcase_add_test(tc, test_receives_message_split_over_chunks);
+    tcase_add_test(tc, test_receives_zero_copy_strings);
     return tc;
 }
@@ -22,6 +22,8 @@
 #include "memiostream.h"
 #include <check.h>
 #include <errno.h>
+#include <stdio.h>
+#include <string.h>
 #include <unistd.h>
 
 
@@ -116,6 +118,62 @@ START_TEST (deserialize_tiny_list)
 END_TEST
 
 
+START_TEST (deserialize_packed_lists)
+{
+    uint8_t bytes[] =
+            { 0x93, 0x05, 0xC9, 0x01, 0x00, 0xF0,
+              0x92, 0xC1, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A,
+                    0xC1, 0xBF, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    rb_append(rb, bytes, sizeof(bytes));
+
+    neo4j_value_t value;
+    int n = neo4j_deserialize(ios, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(value), 3);
+
+    const int64_t *ints = neo4j_list_int_values(value);
+    ck_assert_ptr_ne(ints, NULL);
+    ck_assert(ints[0] == 5 && ints[1] == 256 && ints[2] == -16);
+    const neo4j_value_t item = neo4j_list_get(value, 1);
+    ck_assert_int_eq(neo4j_type(item), NEO4J_INT);
+    ck_assert_int_eq(neo4j_int_value(item), 256);
+
+    n = neo4j_deserialize(ios, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(value), 2);
+
+    const double *floats = neo4j_list_float_values(value);
+    ck_assert_ptr_ne(floats, NULL);
+    ck_assert(floats[0] == 1.1 && floats[1] == -1.0);
+
+    ck_assert_int_eq(rb_used(rb), 0);
+}
+END_TEST
+
+
+START_TEST (deserialize_mixed_list_starting_with_ints)
+{
+    uint8_t bytes[] = { 0x94, 0x01, 0x02, 0x81, 0x61, 0x03 };
+    rb_append(rb, bytes, sizeof(bytes));
+
+    neo4j_value_t value;
+    int n = neo4j_deserialize(ios, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(value), 4);
+    ck_assert_ptr_eq(neo4j_list_int_values(value), NULL);
+
+    neo4j_value_t items[] =
+        { neo4j_int(1), neo4j_int(2), neo4j_string("a"), neo4j_int(3) };
+    ck_assert(neo4j_eq(value, neo4j_list(items, 4)));
+
+    ck_assert_int_eq(rb_used(rb), 0);
+}
+END_TEST
+
+
 START_TEST (deserialize_tiny_map)
 {
     uint8_t bytes[] =
@@ -631,6 +689,45 @@ START_TEST (deserialize_map8)
 END_TEST
 
 
+START_TEST (deserialize_map8_indexes_keys)
+{
+    // 40 entries, "k0" to "k39", followed by a duplicate of "k5"
+    uint8_t bytes[256] = { 0xD8, 41 };
+    size_t len = 2;
+    char key[8];
+    for (int i = 0; i <= 40; ++i)
+    {
+        int klen = snprintf(key, sizeof(key), "k%d", (i < 40)? i : 5);
+        bytes[len++] = 0x80 | klen;
+        memcpy(bytes + len, key, klen);
+        len += klen;
+        bytes[len++] = (i < 40)? i : 0x63;
+    }
+    rb_append(rb, bytes, len);
+
+    neo4j_value_t value;
+    int n = neo4j_deserialize(ios, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_MAP);
+    ck_assert_int_eq(neo4j_map_size(value), 41);
+
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(key, sizeof(key), "k%d", i);
+        neo4j_value_t v = neo4j_map_get(value, key);
+        ck_assert_int_eq(neo4j_type(v), NEO4J_INT);
+        ck_assert_int_eq(neo4j_int_value(v), i);
+    }
+
+    ck_assert(neo4j_is_null(neo4j_map_get(value, "k40")));
+    ck_assert(neo4j_is_null(neo4j_map_get(value, "k")));
+    ck_assert(neo4j_is_null(neo4j_map_kget(value, neo4j_int(5))));
+
+    ck_assert_int_eq(rb_used(rb), 0);
+}
+END_TEST
+
+
 START_TEST (deserialize_map8_with_invalid_key_type)
 {
     uint8_t bytes[] =
@@ -1031,6 +1128,166 @@ START_TEST (deserialize_unbound_relationship)
 END_TEST
 
 
+START_TEST (deserialize_from_buffer)
+{
+    uint8_t bytes[] =
+            { 0x93, 0x01, 0x86, 0x62, 0x65, 0x72, 0x6e, 0x69,
+              0x65, 0xD6, 0x00, 0x00, 0x00, 0x01, 0xC3, 0x7F };
+
+    const uint8_t *buf = bytes;
+    neo4j_value_t value;
+    int n = neo4j_deserialize_buffer(&buf, bytes + sizeof(bytes), false,
+            &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes) - 1);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(value), 3);
+
+    ck_assert_int_eq(neo4j_int_value(neo4j_list_get(value, 0)), 1);
+    char sbuf[16];
+    ck_assert_str_eq(neo4j_string_value(neo4j_list_get(value, 1),
+                sbuf, sizeof(sbuf)), "bernie");
+    neo4j_value_t inner = neo4j_list_get(value, 2);
+    ck_assert_int_eq(neo4j_type(inner), NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(inner), 1);
+    ck_assert(neo4j_bool_value(neo4j_list_get(inner, 0)));
+
+    n = neo4j_deserialize_buffer(&buf, bytes + sizeof(bytes), false,
+            &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes));
+    ck_assert_int_eq(neo4j_int_value(value), 127);
+}
+END_TEST
+
+
+START_TEST (deserialize_from_truncated_buffer)
+{
+    uint8_t bytes[] = { 0x92, 0x01, 0x86, 0x62, 0x65, 0x72 };
+
+    size_t depth = neo4j_mpool_depth(mpool);
+    const uint8_t *buf = bytes;
+    neo4j_value_t value;
+    int n = neo4j_deserialize_buffer(&buf, bytes + sizeof(bytes), false,
+            &mpool, &value);
+    ck_assert_int_eq(n, -1);
+    ck_assert_int_eq(errno, EPROTO);
+    ck_assert_ptr_eq(buf, bytes);
+    ck_assert_int_eq(neo4j_mpool_depth(mpool), depth);
+}
+END_TEST
+
+
+START_TEST (deserialize_borrowed_strings_from_buffer)
+{
+    uint8_t bytes[] =
+            { 0xA1, 0x81, 0x61, 0x86, 0x62, 0x65, 0x72, 0x6e,
+              0x69, 0x65 };
+
+    size_t depth = neo4j_mpool_depth(mpool);
+    const uint8_t *buf = bytes;
+    neo4j_value_t value;
+    int n = neo4j_deserialize_buffer(&buf, bytes + sizeof(bytes), true,
+            &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes));
+    ck_assert_int_eq(neo4j_type(value), NEO4J_MAP);
+    // only the entries are allocated
+    ck_assert_int_eq(neo4j_mpool_depth(mpool), depth + 1);
+
+    const neo4j_map_entry_t *entry = neo4j_map_getentry(value, 0);
+    ck_assert_ptr_eq(neo4j_ustring_value(entry->key), bytes + 2);
+    ck_assert_int_eq(neo4j_string_length(entry->key), 1);
+    ck_assert_ptr_eq(neo4j_ustring_value(entry->value), bytes + 4);
+    ck_assert_int_eq(neo4j_string_length(entry->value), 6);
+}
+END_TEST
+
+
+START_TEST (deserialize_inline_strings_from_buffer)
+{
+    uint8_t bytes[] =
+            { 0xA1, 0x81, 0x61, 0x89, 0x62, 0x65, 0x72, 0x6e,
+              0x69, 0x65, 0x20, 0x6d, 0x63, 0x81, 0x62, 0x88,
+              0x62, 0x65, 0x72, 0x6e, 0x69, 0x65, 0x20, 0x6d };
+
+    size_t depth = neo4j_mpool_depth(mpool);
+    const uint8_t *buf = bytes;
+    neo4j_value_t value;
+    int n = neo4j_deserialize_interned(&buf, bytes + 13, false, true,
+            NULL, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + 13);
+    ck_assert_int_eq(neo4j_type(value), NEO4J_MAP);
+    // the entries and the string longer than the inline length
+    ck_assert_int_eq(neo4j_mpool_depth(mpool), depth + 2);
+
+    const neo4j_map_entry_t *entry = neo4j_map_getentry(value, 0);
+    const char *key = neo4j_ustring_pointer(&(entry->key));
+    ck_assert_ptr_eq(key, (const char *)&(entry->key) + 8);
+    ck_assert_int_eq(neo4j_string_length(entry->key), 1);
+    ck_assert(strncmp(key, "a", 1) == 0);
+    ck_assert_int_eq(neo4j_string_length(entry->value), 9);
+    ck_assert(strncmp(neo4j_ustring_value(entry->value), "bernie mc", 9) == 0);
+
+    n = neo4j_deserialize_interned(&buf, bytes + sizeof(bytes), false, true,
+            NULL, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + 15);
+    n = neo4j_deserialize_interned(&buf, bytes + sizeof(bytes), false, true,
+            NULL, &mpool, &value);
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes));
+    ck_assert(neo4j_eq(value, neo4j_string("bernie m")));
+    ck_assert_int_eq(neo4j_mpool_depth(mpool), depth + 2);
+}
+END_TEST
+
+
+START_TEST (skip_values_in_buffer)
+{
+    uint8_t bytes[] =
+            { 0x93, 0xC9, 0x01, 0x00, 0xD0, 0x03, 0x61, 0x62,
+              0x63, 0xB3, 0x4E, 0x01, 0x91, 0x81, 0x41, 0xA1,
+              0x81, 0x6B, 0xC1, 0x3F, 0xF1, 0x99, 0x99, 0x99,
+              0x99, 0x99, 0x9A, 0x7F };
+
+    const uint8_t *buf = bytes;
+    int n = neo4j_deserialize_skip(&buf, bytes + sizeof(bytes));
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes) - 1);
+
+    n = neo4j_deserialize_skip(&buf, bytes + sizeof(bytes));
+    ck_assert_int_eq(n, 0);
+    ck_assert_ptr_eq(buf, bytes + sizeof(bytes));
+}
+END_TEST
+
+
+START_TEST (skip_truncated_and_invalid_values)
+{
+    uint8_t truncated[] = { 0x92, 0x01, 0xD0, 0x03, 0x61, 0x62 };
+    const uint8_t *buf = truncated;
+    int n = neo4j_deserialize_skip(&buf, truncated + sizeof(truncated));
+    ck_assert_int_eq(n, -1);
+    ck_assert_int_eq(errno, EPROTO);
+    ck_assert_ptr_eq(buf, truncated);
+
+    uint8_t oversized[] = { 0xD6, 0x7F, 0xFF, 0xFF, 0xFF, 0x01 };
+    buf = oversized;
+    n = neo4j_deserialize_skip(&buf, oversized + sizeof(oversized));
+    ck_assert_int_eq(n, -1);
+    ck_assert_int_eq(errno, EPROTO);
+
+    uint8_t invalid[] = { 0x91, 0xE0 };
+    buf = invalid;
+    n = neo4j_deserialize_skip(&buf, invalid + sizeof(invalid));
+    ck_assert_int_eq(n, -1);
+    ck_assert_int_eq(errno, EPROTO);
+}
+END_TEST
+
+
 TCase* deserialization_tcase(void)
 {
     TCase *tc = tcase_create("deserialization");
@@ -1038,6 +1295,8 @@ TCase* deserialization_tcase(void)
     tcase_add_test(tc, deserialize_positive_tiny_int);
     tcase_add_test(tc, deserialize_tiny_string);
     tcase_add_test(tc, deserialize_tiny_list);
+    tcase_add_test(tc, deserialize_packed_lists);
+    tcase_add_test(tc, deserialize_mixed_list_starting_with_ints);
     tcase_add_test(tc, deserialize_tiny_map);
     tcase_add_test(tc, deserialize_tiny_struct);
     tcase_add_test(tc, deserialize_null);
@@ -1053,6 +1312,7 @@ TCase* deserialization_tcase(void)
     tcase_add_test(tc, deserialize_list8);
     tcase_add_test(tc, deserialize_list16);
     tcase_add_test(tc, deserialize_map8);
+    tcase_add_test(tc, deserialize_map8_indexes_keys);
     tcase_add_test(tc, deserialize_map8_with_invalid_key_type);
     tcase_add_test(tc, deserialize_struct8);
     tcase_add_test(tc, deserialize_struct16);
@@ -1066,5 +1326,11 @@ TCase* deserialization_tcase(void)
     tcase_add_test(tc, deserialize_relationship);
     tcase_add_test(tc, deserialize_path);
     tcase_add_test(tc, deserialize_unbound_relationship);
+    tcase_add_test(tc, deserialize_from_buffer);
+    tcase_add_test(tc, deserialize_from_truncated_buffer);
+    tcase_add_test(tc, deserialize_borrowed_strings_from_buffer);
+    tcase_add_test(tc, deserialize_inline_strings_from_buffer);
+    tcase_add_test(tc, skip_values_in_buffer);
+    tcase_add_test(tc, skip_truncated_and_invalid_values);
     return tc;
 }
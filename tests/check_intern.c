@@ -0,0 +1,118 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../config.h"
+#include "../src/lib/intern.h"
+#include <check.h>
+#include <stdio.h>
+#include <string.h>
+
+
+static neo4j_config_t *config;
+static neo4j_intern_table_t *table;
+
+
+static void setup(void)
+{
+    config = neo4j_new_config();
+    table = neo4j_intern_table_new(config);
+    ck_assert_ptr_ne(table, NULL);
+}
+
+
+static void teardown(void)
+{
+    neo4j_intern_table_release(table);
+    neo4j_config_free(config);
+}
+
+
+START_TEST (test_interns_equal_strings)
+{
+    char name1[] = "name";
+    char name2[] = "name";
+    const char *interned = neo4j_intern(table, name1, 4);
+    ck_assert_ptr_ne(interned, NULL);
+    ck_assert_ptr_ne(interned, name1);
+    ck_assert(memcmp(interned, "name", 4) == 0);
+
+    ck_assert_ptr_eq(neo4j_intern(table, name2, 4), interned);
+    ck_assert_ptr_ne(neo4j_intern(table, "names", 5), interned);
+    ck_assert_ptr_ne(neo4j_intern(table, "nam", 3), interned);
+
+    struct neo4j_intern_stats stats = neo4j_intern_table_stats(table);
+    ck_assert_int_eq(stats.strings, 3);
+    ck_assert_int_eq(stats.hits, 1);
+    ck_assert_int_eq(stats.bytes_saved, 4);
+}
+END_TEST
+
+
+START_TEST (test_interns_many_strings)
+{
+    char buf[16];
+    const char *interned[1000];
+    for (int i = 0; i < 1000; ++i)
+    {
+        int n = snprintf(buf, sizeof(buf), "key%d", i);
+        interned[i] = neo4j_intern(table, buf, n);
+        ck_assert_ptr_ne(interned[i], NULL);
+    }
+    for (int i = 0; i < 1000; ++i)
+    {
+        int n = snprintf(buf, sizeof(buf), "key%d", i);
+        ck_assert_ptr_eq(neo4j_intern(table, buf, n), interned[i]);
+    }
+
+    struct neo4j_intern_stats stats = neo4j_intern_table_stats(table);
+    ck_assert_int_eq(stats.strings, 1000);
+    ck_assert_int_eq(stats.hits, 1000);
+}
+END_TEST
+
+
+START_TEST (test_does_not_intern_long_strings)
+{
+    char buf[NEO4J_INTERN_MAX_LENGTH + 1];
+    memset(buf, 'a', sizeof(buf));
+    ck_assert_ptr_eq(neo4j_intern(table, buf, sizeof(buf)), NULL);
+    ck_assert_ptr_ne(neo4j_intern(table, buf, sizeof(buf) - 1), NULL);
+    ck_assert_ptr_eq(neo4j_intern(table, buf, 0), NULL);
+}
+END_TEST
+
+
+START_TEST (test_strings_remain_until_last_release)
+{
+    const char *interned = neo4j_intern(table, "name", 4);
+    neo4j_intern_table_t *retained = neo4j_intern_table_retain(table);
+    ck_assert_ptr_eq(retained, table);
+    neo4j_intern_table_release(table);
+    ck_assert(memcmp(interned, "name", 4) == 0);
+}
+END_TEST
+
+
+TCase* intern_tcase(void)
+{
+    TCase *tc = tcase_create("intern");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, test_interns_equal_strings);
+    tcase_add_test(tc, test_interns_many_strings);
+    tcase_add_test(tc, test_does_not_intern_long_strings);
+    tcase_add_test(tc, test_strings_remain_until_last_release);
+    return tc;
+}
@@ -616,6 +616,136 @@ START_TEST (merge_with_pool_of_larger_blocksize)
 END_TEST
 
 
+START_TEST (arena_allocations_share_blocks)
+{
+    pool = neo4j_arena_mpool(pool.allocator, block_size, 1024);
+
+    char *ptrs[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        ptrs[i] = neo4j_mpool_alloc(&pool, 10);
+        ck_assert_ptr_ne(ptrs[i], NULL);
+        ck_assert((uintptr_t)ptrs[i] % NEO4J_MPOOL_ALIGNMENT == 0);
+        memset(ptrs[i], 'a' + i, 10);
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        ck_assert(ptrs[i][0] == 'a' + i && ptrs[i][9] == 'a' + i);
+    }
+    ck_assert_int_eq(allocator.allocations, 1);
+    ck_assert_int_eq(neo4j_mpool_depth(pool), 1);
+
+    int *ints = neo4j_mpool_calloc(&pool, 8, sizeof(int));
+    ck_assert_ptr_ne(ints, NULL);
+    for (int i = 0; i < 8; ++i)
+    {
+        ck_assert_int_eq(ints[i], 0);
+    }
+    ck_assert_int_eq(allocator.allocations, 1);
+
+    // large allocations are made directly
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 512), NULL);
+    ck_assert_int_eq(allocator.allocations, 2);
+    ck_assert_int_eq(neo4j_mpool_depth(pool), 2);
+
+    neo4j_mpool_drain(&pool);
+    ck_assert_int_eq(allocator.releases, 2);
+}
+END_TEST
+
+
+START_TEST (arena_drainto_releases_later_blocks)
+{
+    pool = neo4j_arena_mpool(pool.allocator, block_size, 1024);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 256), NULL);
+    }
+    ck_assert_int_eq(allocator.allocations, 1);
+    size_t pdepth = neo4j_mpool_depth(pool);
+
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, 2);
+    ck_assert_int_eq(neo4j_mpool_depth(pool), pdepth + 1);
+
+    neo4j_mpool_drainto(&pool, pdepth);
+    ck_assert_int_eq(allocator.releases, 1);
+    ck_assert_int_eq(neo4j_mpool_depth(pool), pdepth);
+
+    // the first block is full, so a new block is required
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, 3);
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, 3);
+
+    neo4j_mpool_drain(&pool);
+    ck_assert_int_eq(allocator.releases, 3);
+}
+END_TEST
+
+
+START_TEST (arena_drainto_mark_reuses_space)
+{
+    pool = neo4j_arena_mpool(pool.allocator, block_size, 1024);
+
+    char *ptr1 = neo4j_mpool_alloc(&pool, 16);
+    ck_assert_ptr_ne(ptr1, NULL);
+    neo4j_mpool_mark_t mark = neo4j_mpool_mark(pool);
+
+    char *ptr2 = neo4j_mpool_alloc(&pool, 64);
+    ck_assert_ptr_ne(ptr2, NULL);
+    neo4j_mpool_drainto_mark(&pool, mark);
+    ck_assert_ptr_eq(neo4j_mpool_alloc(&pool, 64), ptr2);
+    ck_assert_int_eq(allocator.allocations, 1);
+
+    // space in the marked block is reused after later blocks are released
+    neo4j_mpool_drainto_mark(&pool, mark);
+    for (int i = 0; i < 4; ++i)
+    {
+        ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 256), NULL);
+    }
+    ck_assert_int_eq(allocator.allocations, 2);
+    neo4j_mpool_drainto_mark(&pool, mark);
+    ck_assert_int_eq(allocator.releases, 1);
+    ck_assert_ptr_eq(neo4j_mpool_alloc(&pool, 64), ptr2);
+    ck_assert_int_eq(allocator.allocations, 2);
+
+    neo4j_mpool_drain(&pool);
+    ck_assert_int_eq(allocator.releases, 2);
+}
+END_TEST
+
+
+START_TEST (merge_with_arena_pool)
+{
+    pool = neo4j_arena_mpool(pool.allocator, block_size, 1024);
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 16), NULL);
+
+    neo4j_mpool_t pool2 = neo4j_arena_mpool(pool.allocator, block_size, 1024);
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool2, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, 2);
+
+    ck_assert_int_eq(neo4j_mpool_merge(&pool, &pool2), 2);
+    ck_assert_int_eq(neo4j_mpool_depth(pool2), 0);
+    int allocations = allocator.allocations;
+
+    // pool2 no longer holds an arena block
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool2, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, allocations + 1);
+    neo4j_mpool_drain(&pool2);
+    ck_assert_int_eq(allocator.releases, 1);
+
+    // pool continues using its own block
+    ck_assert_ptr_ne(neo4j_mpool_alloc(&pool, 16), NULL);
+    ck_assert_int_eq(allocator.allocations, allocations + 1);
+
+    neo4j_mpool_drain(&pool);
+    ck_assert_int_eq(allocator.releases, allocator.allocations);
+}
+END_TEST
+
+
 TCase* memory_tcase(void)
 {
     TCase *tc = tcase_create("memory");
@@ -639,5 +769,9 @@ TCase* memory_tcase(void)
     tcase_add_test(tc, merge_with_pool_of_smaller_blocksize);
     tcase_add_test(tc, merge_with_empty_pool_of_larger_blocksize);
     tcase_add_test(tc, merge_with_pool_of_larger_blocksize);
+    tcase_add_test(tc, arena_allocations_share_blocks);
+    tcase_add_test(tc, arena_drainto_releases_later_blocks);
+    tcase_add_test(tc, arena_drainto_mark_reuses_space);
+    tcase_add_test(tc, merge_with_arena_pool);
     return tc;
 }
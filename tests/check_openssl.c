@@ -15,12 +15,16 @@
  * limitations under the License.
  */
 #include "../config.h"
+#include "../src/lib/openssl.h"
 #include "../src/lib/openssl_iostream.h"
 #include "../src/lib/iostream.h"
 #include "../src/lib/util.h"
 #include "memiostream.h"
+#include "util.h"
 #include <check.h>
 #include <errno.h>
+#include <stdio.h>
+#include <sys/time.h>
 
 
 static ring_buffer_t *rcv_rb;
@@ -62,10 +66,84 @@ START_TEST (server_refuses_handshake)
 END_TEST
 
 
+START_TEST (ctx_is_shared_until_files_change)
+{
+    char dir[1024];
+    ck_assert(check_tmpdir(dir, sizeof(dir), "check-openssl-XXXXXX") == 0);
+
+    SSL_CTX *ctx1 = neo4j_openssl_ctx(config);
+    ck_assert(ctx1 != NULL);
+    SSL_CTX *ctx2 = neo4j_openssl_ctx(config);
+    ck_assert(ctx2 == ctx1);
+
+    ck_assert(neo4j_config_set_TLS_ca_dir(config, dir) == 0);
+    SSL_CTX *ctx3 = neo4j_openssl_ctx(config);
+    ck_assert(ctx3 != NULL);
+    ck_assert(ctx3 != ctx1);
+    SSL_CTX *ctx4 = neo4j_openssl_ctx(config);
+    ck_assert(ctx4 == ctx3);
+
+    struct timeval times[2] = { { 1000, 0 }, { 1000, 0 } };
+    ck_assert(utimes(dir, times) == 0);
+    SSL_CTX *ctx5 = neo4j_openssl_ctx(config);
+    ck_assert(ctx5 != NULL);
+    ck_assert(ctx5 != ctx3);
+
+    SSL_CTX_free(ctx1);
+    SSL_CTX_free(ctx2);
+    SSL_CTX_free(ctx3);
+    SSL_CTX_free(ctx4);
+    SSL_CTX_free(ctx5);
+    ck_assert(rm_rf(dir) == 0);
+}
+END_TEST
+
+
+START_TEST (ctx_is_reloaded_when_ca_dir_file_changes)
+{
+    char dir[1024];
+    ck_assert(check_tmpdir(dir, sizeof(dir), "check-openssl-XXXXXX") == 0);
+    char path[1100];
+    snprintf(path, sizeof(path), "%s/ca.0", dir);
+    FILE *f = fopen(path, "w");
+    ck_assert(f != NULL);
+    fclose(f);
+
+    struct timeval times[2] = { { 1000, 0 }, { 1000, 0 } };
+    ck_assert(utimes(path, times) == 0);
+    ck_assert(utimes(dir, times) == 0);
+
+    ck_assert(neo4j_config_set_TLS_ca_dir(config, dir) == 0);
+    SSL_CTX *ctx1 = neo4j_openssl_ctx(config);
+    ck_assert(ctx1 != NULL);
+    SSL_CTX *ctx2 = neo4j_openssl_ctx(config);
+    ck_assert(ctx2 == ctx1);
+
+    // rewrite the file in place, leaving the directory mtime unchanged
+    f = fopen(path, "w");
+    ck_assert(f != NULL);
+    fputs("changed", f);
+    fclose(f);
+    ck_assert(utimes(dir, times) == 0);
+
+    SSL_CTX *ctx3 = neo4j_openssl_ctx(config);
+    ck_assert(ctx3 != NULL);
+    ck_assert(ctx3 != ctx1);
+
+    SSL_CTX_free(ctx1);
+    SSL_CTX_free(ctx2);
+    SSL_CTX_free(ctx3);
+    ck_assert(rm_rf(dir) == 0);
+}
+END_TEST
+
+
 TCase* openssl_tcase(void)
 {
     TCase *tc = tcase_create("openssl");
     tcase_add_checked_fixture(tc, setup, teardown);
     tcase_add_test(tc, server_refuses_handshake);
+    tcase_add_test(tc, ctx_is_shared_until_files_change);
+    tcase_add_test(tc, ctx_is_reloaded_when_ca_dir_file_changes);
     return tc;
 }
@@ -0,0 +1,346 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../config.h"
+#include "../src/lib/connection.h"
+#include "../src/lib/pool.h"
+#include "../src/lib/posix_iostream.h"
+#include "../src/lib/util.h"
+#include "memiostream.h"
+#include <check.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#define MAX_CONNECTIONS 64
+#define NTHREADS 8
+#define NITERATIONS 1000
+
+
+static neo4j_iostream_t *stub_connect(
+        struct neo4j_connection_factory *factory,
+        const char *hostname, unsigned int port, neo4j_config_t *config,
+        uint_fast32_t flags, struct neo4j_logger *logger);
+static unsigned int connection_index(neo4j_connection_t *connection);
+static void *checkout_loop(void *data);
+
+
+static struct neo4j_connection_factory stub_factory;
+static neo4j_config_t *config;
+static pthread_mutex_t stub_mutex = PTHREAD_MUTEX_INITIALIZER;
+static unsigned int nconnects;
+static bool use_sockets;
+static ring_buffer_t *rbs[2 * MAX_CONNECTIONS];
+static int server_fds[MAX_CONNECTIONS];
+static neo4j_iostream_t *connected[MAX_CONNECTIONS];
+static atomic_int in_use[MAX_CONNECTIONS];
+
+
+static void setup(void)
+{
+    nconnects = 0;
+    use_sockets = false;
+    for (unsigned int i = 0; i < MAX_CONNECTIONS; ++i)
+    {
+        atomic_init(&(in_use[i]), 0);
+        server_fds[i] = -1;
+    }
+
+    stub_factory.tcp_connect = stub_connect;
+    config = neo4j_new_config();
+    neo4j_config_set_connection_factory(config, &stub_factory);
+}
+
+
+static void teardown(void)
+{
+    neo4j_config_free(config);
+    for (unsigned int i = 0; i < nconnects; ++i)
+    {
+        if (server_fds[i] >= 0)
+        {
+            close(server_fds[i]);
+        }
+        if (rbs[2 * i] != NULL)
+        {
+            rb_free(rbs[2 * i]);
+            rb_free(rbs[2 * i + 1]);
+        }
+    }
+}
+
+
+neo4j_iostream_t *stub_connect(struct neo4j_connection_factory *factory,
+        const char *hostname, unsigned int port, neo4j_config_t *config,
+        uint_fast32_t flags, struct neo4j_logger *logger)
+{
+    pthread_mutex_lock(&stub_mutex);
+    ck_assert_int_lt(nconnects, MAX_CONNECTIONS);
+    uint32_t version = htonl(1);
+    if (use_sockets)
+    {
+        int fds[2];
+        ck_assert_int_eq(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        ck_assert_int_eq(write(fds[1], &version, sizeof(version)),
+                sizeof(version));
+        neo4j_iostream_t *ios = neo4j_posix_iostream(fds[0]);
+        ck_assert_ptr_ne(ios, NULL);
+        rbs[2 * nconnects] = NULL;
+        rbs[2 * nconnects + 1] = NULL;
+        server_fds[nconnects] = fds[1];
+        connected[nconnects++] = ios;
+        pthread_mutex_unlock(&stub_mutex);
+        return ios;
+    }
+
+    ring_buffer_t *in_rb = rb_alloc(128);
+    ring_buffer_t *out_rb = rb_alloc(128);
+    rbs[2 * nconnects] = in_rb;
+    rbs[2 * nconnects + 1] = out_rb;
+
+    rb_append(in_rb, &version, sizeof(version));
+    neo4j_iostream_t *ios = neo4j_memiostream(in_rb, out_rb);
+    connected[nconnects++] = ios;
+    pthread_mutex_unlock(&stub_mutex);
+    return ios;
+}
+
+
+unsigned int connection_index(neo4j_connection_t *connection)
+{
+    pthread_mutex_lock(&stub_mutex);
+    // the most recent match, as closed streams may be reallocated
+    unsigned int i;
+    for (i = nconnects; i > 0 && connected[i - 1] != connection->iostream; --i)
+        ;
+    ck_assert_int_gt(i, 0);
+    pthread_mutex_unlock(&stub_mutex);
+    return i - 1;
+}
+
+
+START_TEST (test_pool_reuses_returned_connections)
+{
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+    ck_assert_int_eq(nconnects, 0);
+
+    neo4j_connection_t *connection1 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection1, NULL);
+    neo4j_connection_t *connection2 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection2, NULL);
+    ck_assert_ptr_ne(connection1, connection2);
+    ck_assert_int_eq(nconnects, 2);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+
+    // the connection held for this thread is preferred
+    neo4j_connection_t *connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_eq(connection, connection1);
+    connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_eq(connection, connection2);
+    ck_assert_int_eq(nconnects, 2);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+START_TEST (test_pool_establishes_min_idle_connections)
+{
+    neo4j_config_set_pool_min_idle(config, 2);
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+    ck_assert_int_eq(nconnects, 2);
+
+    neo4j_connection_t *connection1 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection1, NULL);
+    neo4j_connection_t *connection2 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection2, NULL);
+    ck_assert_int_eq(nconnects, 2);
+    neo4j_connection_t *connection3 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection3, NULL);
+    ck_assert_int_eq(nconnects, 3);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection3), 0);
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+START_TEST (test_pool_closes_connections_beyond_max_idle)
+{
+    neo4j_config_set_pool_max_idle(config, 1);
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+
+    neo4j_connection_t *connection1 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection1, NULL);
+    neo4j_connection_t *connection2 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection2, NULL);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+    ck_assert_int_eq(atomic_load(&(pool->nidle)), 1);
+
+    neo4j_connection_t *connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_eq(connection, connection1);
+    connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection, NULL);
+    ck_assert_int_eq(nconnects, 3);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection), 0);
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+START_TEST (test_pool_discards_closed_connections)
+{
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+
+    neo4j_connection_t *connection1 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection1, NULL);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection1), 0);
+
+    // closed while idle, as if by a failed session
+    neo4j_ios_close(connection1->iostream);
+    connection1->iostream = NULL;
+
+    neo4j_connection_t *connection2 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection2, NULL);
+    ck_assert_ptr_ne(connection2->iostream, NULL);
+    ck_assert_int_eq(nconnects, 2);
+    ck_assert_int_eq(atomic_load(&(pool->nidle)), 0);
+
+    neo4j_ios_close(connection2->iostream);
+    connection2->iostream = NULL;
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+    ck_assert_int_eq(atomic_load(&(pool->nidle)), 0);
+
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+START_TEST (test_pool_replaces_connections_closed_by_server)
+{
+    use_sockets = true;
+    neo4j_config_set_pool_min_idle(config, 1);
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+    ck_assert_int_eq(nconnects, 1);
+
+    // the server closes the idle connection
+    close(server_fds[0]);
+    server_fds[0] = -1;
+
+    neo4j_connection_t *connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection, NULL);
+    ck_assert_int_eq(connection_index(connection), 1);
+    // a replacement idle connection is established
+    ck_assert_int_eq(nconnects, 3);
+    ck_assert_int_eq(atomic_load(&(pool->nidle)), 1);
+
+    // unexpected data from the server also makes a connection unusable
+    ck_assert_int_eq(write(server_fds[2], "x", 1), 1);
+    neo4j_connection_t *connection2 = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection2, NULL);
+    ck_assert_int_eq(connection_index(connection2), 3);
+    ck_assert_int_eq(nconnects, 5);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection), 0);
+    ck_assert_int_eq(neo4j_pool_return(pool, connection2), 0);
+    connection = neo4j_pool_checkout(pool);
+    ck_assert_ptr_ne(connection, NULL);
+    ck_assert_int_eq(nconnects, 5);
+
+    ck_assert_int_eq(neo4j_pool_return(pool, connection), 0);
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+START_TEST (test_pool_fails_for_invalid_uri)
+{
+    neo4j_pool_t *pool = neo4j_new_pool("http://localhost:7687", config, 0);
+    ck_assert_ptr_eq(pool, NULL);
+    ck_assert_int_eq(errno, NEO4J_UNKNOWN_URI_SCHEME);
+}
+END_TEST
+
+
+void *checkout_loop(void *data)
+{
+    neo4j_pool_t *pool = (neo4j_pool_t *)data;
+    for (unsigned int i = 0; i < NITERATIONS; ++i)
+    {
+        neo4j_connection_t *connection = neo4j_pool_checkout(pool);
+        ck_assert_ptr_ne(connection, NULL);
+        unsigned int idx = connection_index(connection);
+        ck_assert_int_eq(atomic_exchange(&(in_use[idx]), 1), 0);
+        atomic_store(&(in_use[idx]), 0);
+        ck_assert_int_eq(neo4j_pool_return(pool, connection), 0);
+    }
+    return NULL;
+}
+
+
+START_TEST (test_pool_checks_out_concurrently)
+{
+    neo4j_config_set_pool_max_idle(config, NTHREADS);
+    neo4j_pool_t *pool = neo4j_new_pool("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(pool, NULL);
+
+    pthread_t threads[NTHREADS];
+    for (unsigned int i = 0; i < NTHREADS; ++i)
+    {
+        ck_assert_int_eq(
+                pthread_create(&(threads[i]), NULL, checkout_loop, pool), 0);
+    }
+    for (unsigned int i = 0; i < NTHREADS; ++i)
+    {
+        ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+    }
+
+    // no connection is closed when at most max_idle are ever checked out
+    ck_assert_int_le(nconnects, NTHREADS);
+    ck_assert_int_eq(atomic_load(&(pool->nidle)), nconnects);
+    neo4j_pool_free(pool);
+}
+END_TEST
+
+
+TCase* pool_tcase(void)
+{
+    TCase *tc = tcase_create("pool");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, test_pool_reuses_returned_connections);
+    tcase_add_test(tc, test_pool_establishes_min_idle_connections);
+    tcase_add_test(tc, test_pool_closes_connections_beyond_max_idle);
+    tcase_add_test(tc, test_pool_discards_closed_connections);
+    tcase_add_test(tc, test_pool_replaces_connections_closed_by_server);
+    tcase_add_test(tc, test_pool_fails_for_invalid_uri);
+    tcase_add_test(tc, test_pool_checks_out_concurrently);
+    return tc;
+}
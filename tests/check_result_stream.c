@@ -22,9 +22,11 @@
 #include "../src/lib/session.h"
 #include "../src/lib/serialization.h"
 #include "../src/lib/util.h"
+#include "../src/lib/values.h"
 #include "memiostream.h"
 #include <check.h>
 #include <errno.h>
+#include <string.h>
 
 
 static neo4j_iostream_t *stub_connect(struct neo4j_connection_factory *factory,
@@ -36,11 +38,15 @@ static void queue_message(neo4j_iostream_t *ios, neo4j_message_type_t type,
         const neo4j_value_t *argv, uint16_t argc);
 static void queue_run_success(neo4j_iostream_t *ios);
 static void queue_record(neo4j_iostream_t *ios);
+static void queue_record_with_fields(neo4j_iostream_t *ios);
+static void queue_record_with_value(neo4j_iostream_t *ios, long long value);
 static void queue_stream_end_success(neo4j_iostream_t *ios);
 static void queue_stream_end_success_with_counts(neo4j_iostream_t *ios);
 static void queue_stream_end_success_with_profile(neo4j_iostream_t *ios);
 static void queue_stream_end_success_with_plan(neo4j_iostream_t *ios);
+static void queue_batch_end_success(neo4j_iostream_t *ios);
 static void queue_failure(neo4j_iostream_t *ios);
+static void reconnect(uint32_t version);
 
 
 static struct neo4j_logger_provider *logger_provider;
@@ -145,6 +151,24 @@ void queue_record(neo4j_iostream_t *ios)
 }
 
 
+void queue_record_with_fields(neo4j_iostream_t *ios)
+{
+    neo4j_value_t inner[1] = { neo4j_int(3) };
+    neo4j_value_t fields[3] =
+            { neo4j_int(1), neo4j_string("two"), neo4j_list(inner, 1) };
+    neo4j_value_t argv[1] = { neo4j_list(fields, 3) };
+    queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1);
+}
+
+
+void queue_record_with_value(neo4j_iostream_t *ios, long long value)
+{
+    neo4j_value_t fields[1] = { neo4j_int(value) };
+    neo4j_value_t argv[1] = { neo4j_list(fields, 1) };
+    queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1);
+}
+
+
 void queue_stream_end_success(neo4j_iostream_t *ios)
 {
     neo4j_map_entry_t fields[1] =
@@ -239,6 +263,15 @@ void queue_stream_end_success_with_plan(neo4j_iostream_t *ios)
 }
 
 
+void queue_batch_end_success(neo4j_iostream_t *ios)
+{
+    neo4j_map_entry_t fields[1] =
+        { neo4j_map_entry("has_more", neo4j_bool(true)) };
+    neo4j_value_t argv[1] = { neo4j_map(fields, 1) };
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, argv, 1);
+}
+
+
 void queue_failure(neo4j_iostream_t *ios)
 {
     neo4j_map_entry_t fields[2] =
@@ -249,6 +282,27 @@ void queue_failure(neo4j_iostream_t *ios)
 }
 
 
+void reconnect(uint32_t version)
+{
+    neo4j_end_session(session);
+    neo4j_close(connection);
+    rb_clear(out_rb);
+    client_ios = neo4j_memiostream(in_rb, out_rb);
+
+    version = htonl(version);
+    rb_append(in_rb, &version, sizeof(version));
+    connection = neo4j_connect("neo4j://localhost:7687", config, 0);
+    ck_assert_ptr_ne(connection, NULL);
+
+    neo4j_value_t empty_map = neo4j_map(NULL, 0);
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, &empty_map, 1); // HELLO
+    session = neo4j_new_session(connection);
+    ck_assert_ptr_ne(session, NULL);
+
+    rb_clear(out_rb);
+}
+
+
 START_TEST (test_run_returns_results_and_completes)
 {
     neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
@@ -425,7 +479,6 @@ START_TEST (test_run_returns_failure_when_statement_fails)
 {
     queue_failure(server_ios); // RUN
     queue_message(server_ios, NEO4J_IGNORED_MESSAGE, NULL, 0); // PULL_ALL
-    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
 
     neo4j_result_stream_t *results = neo4j_run(session, "badquery", neo4j_null);
     ck_assert_ptr_ne(results, NULL);
@@ -439,7 +492,12 @@ START_TEST (test_run_returns_failure_when_statement_fails)
     ck_assert_int_eq(result, NEO4J_STATEMENT_EVALUATION_FAILED);
 
     ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
 
+    // ACK_FAILURE is only sent with the next requests, or at session end
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
     ck_assert(rb_is_empty(in_rb));
 }
 END_TEST
@@ -454,7 +512,6 @@ START_TEST (test_run_returns_failure_during_streaming)
     queue_run_success(server_ios); // RUN
     queue_record(server_ios); // PULL_ALL
     queue_failure(server_ios); // PULL_ALL
-    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
 
     ck_assert_int_eq(neo4j_check_failure(results), 0);
 
@@ -471,7 +528,12 @@ START_TEST (test_run_returns_failure_during_streaming)
     ck_assert_int_eq(result, NEO4J_STATEMENT_EVALUATION_FAILED);
 
     ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
 
+    // ACK_FAILURE is only sent with the next requests, or at session end
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
     ck_assert(rb_is_empty(in_rb));
 }
 END_TEST
@@ -560,6 +622,253 @@ START_TEST (test_run_returns_same_failure_after_session_close)
 END_TEST
 
 
+static void check_pull(int64_t n)
+{
+    const neo4j_value_t *argv;
+    uint16_t argc;
+    neo4j_message_type_t type = recv_message(server_ios, &mpool,
+            &argv, &argc);
+    ck_assert_int_eq(type->struct_signature,
+            NEO4J_PULL_MESSAGE->struct_signature);
+    ck_assert_int_eq(argc, 1);
+    ck_assert_int_eq(neo4j_int_value(neo4j_map_get(argv[0], "n")), n);
+}
+
+
+START_TEST (test_run_pulls_records_in_batches)
+{
+    reconnect(0x0404);
+    neo4j_config_set_fetch_size(connection->config, 2);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL
+    queue_record(server_ios); // PULL
+    queue_batch_end_success(server_ios); // PULL
+
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(2);
+    ck_assert(rb_is_empty(out_rb)); // next batch not yet requested
+
+    queue_record(server_ios); // PULL
+    queue_stream_end_success(server_ios); // PULL
+
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+    check_pull(2);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, 0);
+    ck_assert_int_eq(neo4j_statement_type(results), NEO4J_READ_WRITE_STATEMENT);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+    ck_assert(rb_is_empty(out_rb));
+}
+END_TEST
+
+
+START_TEST (test_close_discards_remaining_batches)
+{
+    reconnect(0x0404);
+    neo4j_config_set_fetch_size(connection->config, 1);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL
+    queue_batch_end_success(server_ios); // PULL
+    queue_stream_end_success(server_ios); // DISCARD
+
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(1);
+    const neo4j_value_t *argv;
+    uint16_t argc;
+    type = recv_message(server_ios, &mpool, &argv, &argc);
+    ck_assert_int_eq(type->struct_signature,
+            NEO4J_DISCARD_MESSAGE->struct_signature);
+    ck_assert_int_eq(argc, 1);
+    ck_assert_int_eq(neo4j_int_value(neo4j_map_get(argv[0], "n")), -1);
+    ck_assert(rb_is_empty(out_rb)); // no further PULL
+}
+END_TEST
+
+
+START_TEST (test_run_sends_later_requests_after_last_batch)
+{
+    reconnect(0x0404);
+    neo4j_config_set_fetch_size(connection->config, 1);
+
+    neo4j_result_stream_t *results1 = neo4j_run(session, "RETURN 1",
+            neo4j_null);
+    ck_assert_ptr_ne(results1, NULL);
+    neo4j_result_stream_t *results2 = neo4j_run(session, "RETURN 2",
+            neo4j_null);
+    ck_assert_ptr_ne(results2, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL
+    queue_batch_end_success(server_ios); // PULL
+    queue_record(server_ios); // PULL
+    queue_stream_end_success(server_ios); // PULL
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL
+    queue_stream_end_success(server_ios); // PULL
+
+    ck_assert_ptr_ne(neo4j_fetch_next(results2), NULL);
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(1);
+    check_pull(1);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(1);
+
+    // records of the earlier stream are retained until fetched
+    ck_assert_ptr_ne(neo4j_fetch_next(results1), NULL);
+    ck_assert_ptr_ne(neo4j_fetch_next(results1), NULL);
+    ck_assert_ptr_eq(neo4j_fetch_next(results1), NULL);
+    ck_assert_int_eq(errno, 0);
+
+    ck_assert_int_eq(neo4j_close_results(results1), 0);
+    ck_assert_int_eq(neo4j_close_results(results2), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_cancel_interrupts_streaming_results)
+{
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL_ALL
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+
+    queue_record(server_ios); // PULL_ALL (in transit before the RESET)
+    queue_message(server_ios, NEO4J_IGNORED_MESSAGE, NULL, 0); // PULL_ALL
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // RESET
+    ck_assert_int_eq(neo4j_cancel_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_PULL_ALL_MESSAGE);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RESET_MESSAGE);
+
+    // the session remains usable
+    results = neo4j_run(session, "RETURN 2", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+    queue_run_success(server_ios); // RUN
+    queue_stream_end_success(server_ios); // PULL_ALL
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_check_failure(results), 0);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_cancel_accepts_failure_before_reset)
+{
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL_ALL
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+
+    queue_failure(server_ios); // PULL_ALL
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // RESET
+    ck_assert_int_eq(neo4j_cancel_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_PULL_ALL_MESSAGE);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RESET_MESSAGE);
+    ck_assert(rb_is_empty(out_rb)); // no ACK_FAILURE
+}
+END_TEST
+
+
+START_TEST (test_cancel_interrupts_batched_results)
+{
+    reconnect(0x0404);
+    neo4j_config_set_fetch_size(connection->config, 1);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL
+    ck_assert_ptr_ne(neo4j_fetch_next(results), NULL);
+
+    queue_batch_end_success(server_ios); // PULL
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // RESET
+    ck_assert_int_eq(neo4j_cancel_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(1);
+    type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RESET_MESSAGE);
+    ck_assert(rb_is_empty(out_rb)); // no further PULL
+}
+END_TEST
+
+
+START_TEST (test_cancel_drains_results_when_other_requests_queued)
+{
+    neo4j_result_stream_t *results1 = neo4j_run(session, "RETURN 1",
+            neo4j_null);
+    ck_assert_ptr_ne(results1, NULL);
+    neo4j_result_stream_t *results2 = neo4j_run(session, "RETURN 2",
+            neo4j_null);
+    ck_assert_ptr_ne(results2, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+    queue_run_success(server_ios); // RUN
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    ck_assert_int_eq(neo4j_cancel_results(results1), 0);
+    ck_assert_ptr_eq(neo4j_fetch_next(results2), NULL);
+    ck_assert_int_eq(neo4j_check_failure(results2), 0);
+    ck_assert_int_eq(neo4j_close_results(results2), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    for (int i = 0; i < 2; ++i)
+    {
+        neo4j_message_type_t type =
+            recv_message(server_ios, &mpool, NULL, NULL);
+        ck_assert(type == NEO4J_RUN_MESSAGE);
+        type = recv_message(server_ios, &mpool, NULL, NULL);
+        ck_assert(type == NEO4J_PULL_ALL_MESSAGE);
+    }
+    ck_assert(rb_is_empty(out_rb));
+}
+END_TEST
+
+
 START_TEST (test_send_completes)
 {
     neo4j_result_stream_t *results = neo4j_send(session, "RETURN 1",
@@ -635,7 +944,6 @@ START_TEST (test_send_returns_failure_when_statement_fails)
 {
     queue_failure(server_ios); // RUN
     queue_message(server_ios, NEO4J_IGNORED_MESSAGE, NULL, 0); // DISCARD_ALL
-    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
 
     neo4j_result_stream_t *results = neo4j_send(session, "bad query",
             neo4j_map(NULL, 0));
@@ -650,7 +958,678 @@ START_TEST (test_send_returns_failure_when_statement_fails)
     ck_assert_int_eq(result, NEO4J_STATEMENT_EVALUATION_FAILED);
 
     ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    // ACK_FAILURE is only sent with the next requests, or at session end
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_returns_record_fields)
+{
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+
+    neo4j_value_t field = neo4j_result_field(result, 0);
+    ck_assert(neo4j_type(field) == NEO4J_INT);
+    ck_assert_int_eq(neo4j_int_value(field), 1);
+    field = neo4j_result_field(result, 1);
+    ck_assert(neo4j_type(field) == NEO4J_STRING);
+    char buf[16];
+    ck_assert_str_eq(neo4j_string_value(field, buf, sizeof(buf)), "two");
+    field = neo4j_result_field(result, 2);
+    ck_assert(neo4j_type(field) == NEO4J_LIST);
+    ck_assert_int_eq(neo4j_int_value(neo4j_list_get(field, 0)), 3);
+    ck_assert(neo4j_is_null(neo4j_result_field(result, 3)));
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_decodes_record_fields_lazily)
+{
+    neo4j_config_set_lazy_record_decoding(connection->config, true);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result1 = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result1, NULL);
+    neo4j_retain(result1);
+
+    neo4j_value_t field = neo4j_result_field(result1, 2);
+    ck_assert(neo4j_type(field) == NEO4J_LIST);
+    ck_assert_int_eq(neo4j_int_value(neo4j_list_get(field, 0)), 3);
+    field = neo4j_result_field(result1, 2);
+    ck_assert(neo4j_type(field) == NEO4J_LIST);
+    ck_assert(neo4j_is_null(neo4j_result_field(result1, 3)));
+
+    neo4j_result_t *result2 = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result2, NULL);
+    field = neo4j_result_field(result2, 0);
+    ck_assert(neo4j_type(field) == NEO4J_INT);
+    ck_assert_int_eq(neo4j_int_value(field), 1);
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    // retained records can still be decoded after the stream is closed
+    field = neo4j_result_field(result1, 1);
+    ck_assert(neo4j_type(field) == NEO4J_STRING);
+    char buf[16];
+    ck_assert_str_eq(neo4j_string_value(field, buf, sizeof(buf)), "two");
+    neo4j_release(result1);
+}
+END_TEST
+
+
+START_TEST (test_run_fails_when_lazy_field_cannot_be_decoded)
+{
+    neo4j_config_set_lazy_record_decoding(connection->config, true);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    // a path must have 3 fields
+    neo4j_value_t path_fields[1] = { neo4j_int(2) };
+    neo4j_value_t fields[2] = { neo4j_int(1),
+            neo4j_struct(NEO4J_PATH_SIGNATURE, path_fields, 1) };
+    neo4j_value_t argv[1] = { neo4j_list(fields, 2) };
+    queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1); // PULL_ALL
+    queue_record_with_value(server_ios, 3); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    neo4j_value_t field = neo4j_result_field(result, 0);
+    ck_assert_int_eq(neo4j_int_value(field), 1);
+    ck_assert(neo4j_is_null(neo4j_result_field(result, 1)));
+    ck_assert_int_eq(errno, EPROTO);
+
+    ck_assert_int_eq(neo4j_check_failure(results), EPROTO);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, EPROTO);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_skips_fields_outside_projection)
+{
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+    unsigned int projection[] = { 1 };
+    ck_assert_int_eq(neo4j_set_projection(results, projection, 1), 0);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert(neo4j_is_null(neo4j_result_field(result, 0)));
+    neo4j_value_t field = neo4j_result_field(result, 1);
+    ck_assert(neo4j_type(field) == NEO4J_STRING);
+    char buf[16];
+    ck_assert_str_eq(neo4j_string_value(field, buf, sizeof(buf)), "two");
+    ck_assert(neo4j_is_null(neo4j_result_field(result, 2)));
+
+    // remove the projection
+    ck_assert_int_eq(neo4j_set_projection(results, NULL, 0), 0);
+
+    result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    field = neo4j_result_field(result, 0);
+    ck_assert(neo4j_type(field) == NEO4J_INT);
+    field = neo4j_result_field(result, 2);
+    ck_assert(neo4j_type(field) == NEO4J_LIST);
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
 
+START_TEST (test_run_skips_fields_outside_projection_lazily)
+{
+    neo4j_config_set_lazy_record_decoding(connection->config, true);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+    unsigned int projection[] = { 2, 0 };
+    ck_assert_int_eq(neo4j_set_projection(results, projection, 2), 0);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    neo4j_value_t field = neo4j_result_field(result, 0);
+    ck_assert(neo4j_type(field) == NEO4J_INT);
+    ck_assert_int_eq(neo4j_int_value(field), 1);
+    ck_assert(neo4j_is_null(neo4j_result_field(result, 1)));
+    field = neo4j_result_field(result, 2);
+    ck_assert(neo4j_type(field) == NEO4J_LIST);
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+static unsigned int counted_allocations;
+
+static void *counting_alloc(neo4j_memory_allocator_t *allocator,
+        void *context, size_t size)
+{
+    ++counted_allocations;
+    return malloc(size);
+}
+
+static void *counting_calloc(neo4j_memory_allocator_t *allocator,
+        void *context, size_t count, size_t size)
+{
+    ++counted_allocations;
+    return calloc(count, size);
+}
+
+static void counting_free(neo4j_memory_allocator_t *allocator, void *ptr)
+{
+    free(ptr);
+}
+
+static void counting_vfree(neo4j_memory_allocator_t *allocator, void **ptrs,
+        size_t n)
+{
+    for (; n > 0; --n, ++ptrs)
+    {
+        free(*ptrs);
+    }
+}
+
+static struct neo4j_memory_allocator counting_allocator =
+{
+    .alloc = counting_alloc,
+    .calloc = counting_calloc,
+    .free = counting_free,
+    .vfree = counting_vfree
+};
+
+
+START_TEST (test_run_recycles_record_memory)
+{
+    neo4j_config_set_memory_allocator(connection->config, &counting_allocator);
+    neo4j_config_set_mpool_arena_size(connection->config, 4096);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_record_with_fields(server_ios); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    unsigned int allocations = counted_allocations;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        result = neo4j_fetch_next(results);
+        ck_assert_ptr_ne(result, NULL);
+        neo4j_value_t field = neo4j_result_field(result, 1);
+        char buf[16];
+        ck_assert_str_eq(neo4j_string_value(field, buf, sizeof(buf)), "two");
+    }
+    ck_assert_int_eq(counted_allocations, allocations);
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+static void check_fetched_value(neo4j_result_stream_t *results,
+        long long value)
+{
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    ck_assert_int_eq(neo4j_int_value(neo4j_result_field(result, 0)), value);
+}
+
+
+START_TEST (test_run_reads_records_ahead)
+{
+    neo4j_config_set_read_ahead(connection->config, 2);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 20; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success_with_counts(server_ios); // PULL_ALL
+
+    ck_assert_int_eq(neo4j_nfields(results), 2);
+    for (int i = 0; i < 20; ++i)
+    {
+        check_fetched_value(results, i);
+        ck_assert_int_eq(neo4j_check_failure(results), 0);
+    }
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, 0);
+
+    struct neo4j_update_counts counts = neo4j_update_counts(results);
+    ck_assert_int_eq(counts.nodes_created, 99);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_stops_reading_ahead_when_session_used)
+{
+    neo4j_config_set_read_ahead(connection->config, 2);
+
+    neo4j_result_stream_t *results1 = neo4j_run(session, "RETURN 1",
+            neo4j_null);
+    ck_assert_ptr_ne(results1, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 10; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+    queue_run_success(server_ios); // RUN
+    queue_record_with_value(server_ios, 42); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    check_fetched_value(results1, 0);
+
+    neo4j_result_stream_t *results2 = neo4j_run(session, "RETURN 2",
+            neo4j_null);
+    ck_assert_ptr_ne(results2, NULL);
+    check_fetched_value(results2, 42);
+    ck_assert_ptr_eq(neo4j_fetch_next(results2), NULL);
+
+    // records received by the reader remain available, in order
+    for (int i = 1; i < 10; ++i)
+    {
+        check_fetched_value(results1, i);
+    }
+    ck_assert_ptr_eq(neo4j_fetch_next(results1), NULL);
+    ck_assert_int_eq(errno, 0);
+
+    ck_assert_int_eq(neo4j_close_results(results1), 0);
+    ck_assert_int_eq(neo4j_close_results(results2), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_reads_ahead_until_failure)
+{
+    neo4j_config_set_read_ahead(connection->config, 4);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_value(server_ios, 1); // PULL_ALL
+    queue_failure(server_ios); // PULL_ALL
+
+    check_fetched_value(results, 1);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, NEO4J_STATEMENT_EVALUATION_FAILED);
+    ck_assert_int_eq(neo4j_check_failure(results),
+            NEO4J_STATEMENT_EVALUATION_FAILED);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_reads_batches_ahead)
+{
+    reconnect(0x0404);
+    neo4j_config_set_fetch_size(connection->config, 2);
+    neo4j_config_set_read_ahead(connection->config, 8);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_value(server_ios, 1); // PULL
+    queue_record_with_value(server_ios, 2); // PULL
+    queue_batch_end_success(server_ios); // PULL
+    queue_record_with_value(server_ios, 3); // PULL
+    queue_stream_end_success(server_ios); // PULL
+
+    check_fetched_value(results, 1);
+    check_fetched_value(results, 2);
+    check_fetched_value(results, 3);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, 0);
+    ck_assert_int_eq(neo4j_statement_type(results), NEO4J_READ_WRITE_STATEMENT);
+
+    neo4j_message_type_t type = recv_message(server_ios, &mpool, NULL, NULL);
+    ck_assert(type == NEO4J_RUN_MESSAGE);
+    check_pull(2);
+    check_pull(2);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+    ck_assert(rb_is_empty(out_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_decodes_records_on_workers)
+{
+    neo4j_config_set_deserialization_workers(connection->config, 3);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 20; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    // all records are received before the first is fetched
+    ck_assert_int_eq(neo4j_statement_type(results), NEO4J_READ_WRITE_STATEMENT);
+    for (int i = 0; i < 20; ++i)
+    {
+        check_fetched_value(results, i);
+    }
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, 0);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_decodes_records_read_ahead_on_workers)
+{
+    neo4j_config_set_deserialization_workers(connection->config, 2);
+    neo4j_config_set_read_ahead(connection->config, 4);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 20; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    for (int i = 0; i < 20; ++i)
+    {
+        check_fetched_value(results, i);
+    }
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, 0);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_fails_when_worker_cannot_decode_record)
+{
+    neo4j_config_set_deserialization_workers(connection->config, 2);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    queue_record_with_value(server_ios, 1); // PULL_ALL
+    neo4j_value_t argv[1] = { neo4j_int(2) };
+    queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1); // PULL_ALL
+    queue_record_with_value(server_ios, 3); // PULL_ALL
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    ck_assert_int_eq(neo4j_statement_type(results), NEO4J_READ_WRITE_STATEMENT);
+    check_fetched_value(results, 1);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, EPROTO);
+    ck_assert_int_eq(neo4j_check_failure(results), EPROTO);
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(errno, EPROTO);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_close_releases_records_being_decoded)
+{
+    neo4j_config_set_deserialization_workers(connection->config, 3);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 20; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    ck_assert_int_eq(neo4j_statement_type(results), NEO4J_READ_WRITE_STATEMENT);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+struct each_state
+{
+    long long sum;
+    unsigned int nrecords;
+    unsigned int abort_at;
+};
+
+
+static int sum_record(void *userdata, neo4j_value_t fields)
+{
+    struct each_state *state = (struct each_state *)userdata;
+    ck_assert(neo4j_type(fields) == NEO4J_LIST);
+    state->sum += neo4j_int_value(neo4j_list_get(fields, 0));
+    if (++(state->nrecords) == state->abort_at)
+    {
+        errno = EPERM;
+        return -1;
+    }
+    return 0;
+}
+
+
+START_TEST (test_run_interns_map_keys)
+{
+    neo4j_config_set_intern_strings(connection->config, true);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    for (int i = 0; i < 3; ++i)
+    {
+        neo4j_map_entry_t entry = neo4j_map_entry("name", neo4j_int(i));
+        neo4j_value_t fields[1] = { neo4j_map(&entry, 1) };
+        neo4j_value_t argv[1] = { neo4j_list(fields, 1) };
+        queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1);
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result[3];
+    const neo4j_map_entry_t *entry[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        result[i] = neo4j_retain(neo4j_fetch_next(results));
+        ck_assert_ptr_ne(result[i], NULL);
+        neo4j_value_t map = neo4j_result_field(result[i], 0);
+        ck_assert(neo4j_type(map) == NEO4J_MAP);
+        entry[i] = neo4j_map_getentry(map, 0);
+        ck_assert_int_eq(neo4j_int_value(entry[i]->value), i);
+    }
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+
+    const char *key = neo4j_ustring_value(entry[0]->key);
+    ck_assert(strncmp(key, "name", 4) == 0);
+    ck_assert_ptr_eq(neo4j_ustring_value(entry[1]->key), key);
+    ck_assert_ptr_eq(neo4j_ustring_value(entry[2]->key), key);
+
+    struct neo4j_intern_stats stats = neo4j_intern_stats(results);
+    ck_assert_int_eq(stats.strings, 1);
+    ck_assert_int_eq(stats.hits, 2);
+    ck_assert_int_eq(stats.bytes_saved, 8);
+
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    // interned strings remain valid while records are retained
+    ck_assert(strncmp(neo4j_ustring_value(entry[2]->key), "name", 4) == 0);
+    for (int i = 0; i < 3; ++i)
+    {
+        neo4j_release(result[i]);
+    }
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_holds_short_strings_inline)
+{
+    neo4j_config_set_inline_strings(connection->config, true);
+
+    neo4j_result_stream_t *results = neo4j_run(session, "RETURN 1", neo4j_null);
+    ck_assert_ptr_ne(results, NULL);
+
+    queue_run_success(server_ios); // RUN
+    neo4j_value_t fields[2] =
+        { neo4j_string("GB"), neo4j_string("United Kingdom") };
+    neo4j_value_t argv[1] = { neo4j_list(fields, 2) };
+    queue_message(server_ios, NEO4J_RECORD_MESSAGE, argv, 1);
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    neo4j_result_t *result = neo4j_fetch_next(results);
+    ck_assert_ptr_ne(result, NULL);
+    neo4j_value_t code = neo4j_result_field(result, 0);
+    ck_assert_ptr_eq(neo4j_ustring_value(code), NULL);
+    ck_assert(strncmp(neo4j_ustring_pointer(&code), "GB", 2) == 0);
+    ck_assert(neo4j_eq(code, neo4j_string("GB")));
+    neo4j_value_t name = neo4j_result_field(result, 1);
+    ck_assert(strncmp(neo4j_ustring_value(name), "United Kingdom", 14) == 0);
+
+    ck_assert_ptr_eq(neo4j_fetch_next(results), NULL);
+    ck_assert_int_eq(neo4j_close_results(results), 0);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_each_passes_records_to_callback)
+{
+    queue_run_success(server_ios); // RUN
+    for (int i = 1; i <= 10; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+
+    struct each_state state = { .sum = 0 };
+    ck_assert_int_eq(neo4j_run_each(session, "RETURN 1", neo4j_null,
+                sum_record, &state), 0);
+    ck_assert_int_eq(state.nrecords, 10);
+    ck_assert_int_eq(state.sum, 55);
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_each_returns_statement_failure)
+{
+    queue_run_success(server_ios); // RUN
+    queue_record_with_value(server_ios, 1); // PULL_ALL
+    queue_failure(server_ios); // PULL_ALL
+
+    struct each_state state = { .sum = 0 };
+    ck_assert_int_eq(neo4j_run_each(session, "RETURN 1", neo4j_null,
+                sum_record, &state), -1);
+    ck_assert_int_eq(errno, NEO4J_STATEMENT_EVALUATION_FAILED);
+    ck_assert_int_eq(state.nrecords, 1);
+    ck_assert(rb_is_empty(in_rb));
+
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // ACK_FAILURE
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
+    ck_assert(rb_is_empty(in_rb));
+}
+END_TEST
+
+
+START_TEST (test_run_each_returns_callback_error)
+{
+    queue_run_success(server_ios); // RUN
+    for (int i = 1; i <= 3; ++i)
+    {
+        queue_record_with_value(server_ios, i); // PULL_ALL
+    }
+    queue_stream_end_success(server_ios); // PULL_ALL
+    queue_message(server_ios, NEO4J_SUCCESS_MESSAGE, NULL, 0); // RESET
+
+    struct each_state state = { .abort_at = 1 };
+    ck_assert_int_eq(neo4j_run_each(session, "RETURN 1", neo4j_null,
+                sum_record, &state), -1);
+    ck_assert_int_eq(errno, EPERM);
+    ck_assert_int_eq(state.nrecords, 1);
+
+    // the response to the RESET is received as the session ends
+    ck_assert_int_eq(neo4j_end_session(session), 0);
+    session = NULL;
     ck_assert(rb_is_empty(in_rb));
 }
 END_TEST
@@ -670,6 +1649,32 @@ TCase* result_stream_tcase(void)
     tcase_add_test(tc, test_run_skips_results_after_session_close);
     tcase_add_test(tc, test_run_skips_results_after_session_reset);
     tcase_add_test(tc, test_run_returns_same_failure_after_session_close);
+    tcase_add_test(tc, test_run_returns_record_fields);
+    tcase_add_test(tc, test_run_decodes_record_fields_lazily);
+    tcase_add_test(tc, test_run_fails_when_lazy_field_cannot_be_decoded);
+    tcase_add_test(tc, test_run_skips_fields_outside_projection);
+    tcase_add_test(tc, test_run_skips_fields_outside_projection_lazily);
+    tcase_add_test(tc, test_run_recycles_record_memory);
+    tcase_add_test(tc, test_run_reads_records_ahead);
+    tcase_add_test(tc, test_run_stops_reading_ahead_when_session_used);
+    tcase_add_test(tc, test_run_reads_ahead_until_failure);
+    tcase_add_test(tc, test_run_reads_batches_ahead);
+    tcase_add_test(tc, test_run_decodes_records_on_workers);
+    tcase_add_test(tc, test_run_decodes_records_read_ahead_on_workers);
+    tcase_add_test(tc, test_run_fails_when_worker_cannot_decode_record);
+    tcase_add_test(tc, test_close_releases_records_being_decoded);
+    tcase_add_test(tc, test_run_interns_map_keys);
+    tcase_add_test(tc, test_run_holds_short_strings_inline);
+    tcase_add_test(tc, test_run_each_passes_records_to_callback);
+    tcase_add_test(tc, test_run_each_returns_statement_failure);
+    tcase_add_test(tc, test_run_each_returns_callback_error);
+    tcase_add_test(tc, test_run_pulls_records_in_batches);
+    tcase_add_test(tc, test_close_discards_remaining_batches);
+    tcase_add_test(tc, test_run_sends_later_requests_after_last_batch);
+    tcase_add_test(tc, test_cancel_interrupts_streaming_results);
+    tcase_add_test(tc, test_cancel_accepts_failure_before_reset);
+    tcase_add_test(tc, test_cancel_interrupts_batched_results);
+    tcase_add_test(tc, test_cancel_drains_results_when_other_requests_queued);
     tcase_add_test(tc, test_send_completes);
     tcase_add_test(tc, test_send_returns_fieldnames);
     tcase_add_test(tc, test_send_returns_failure_when_statement_fails);
@@ -332,6 +332,24 @@ START_TEST (serialize_tiny_string)
 END_TEST
 
 
+START_TEST (serialize_inline_string)
+{
+    uint8_t buf[64];
+
+    neo4j_value_t value = neo4j_inline_ustring("hunter", 6);
+    uint8_t expected[] =
+            { 0x86, 0x68, 0x75, 0x6E, 0x74, 0x65, 0x72 };
+
+    int r = neo4j_serialize(value, ios);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(rb_used(rb), sizeof(expected));
+
+    rb_extract(rb, &buf, sizeof(expected));
+    ck_assert(memcmp(buf, expected, sizeof(expected)) == 0);
+}
+END_TEST
+
+
 START_TEST (serialize_string8)
 {
     int r;
@@ -474,6 +492,38 @@ START_TEST (serialize_tiny_list)
 END_TEST
 
 
+START_TEST (serialize_packed_list)
+{
+    int r;
+    uint8_t buf[64];
+
+    int64_t ints[] = { 1, 8345463 };
+    neo4j_value_t int_list = neo4j_int_list(ints, 2);
+    uint8_t expected_ints[] =
+            { 0x92, 0x01, 0xCA, 0x00, 0x7F, 0x57, 0x77 };
+
+    r = neo4j_serialize(int_list, ios);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(rb_used(rb), sizeof(expected_ints));
+
+    rb_extract(rb, &buf, sizeof(expected_ints));
+    ck_assert(memcmp(buf, expected_ints, sizeof(expected_ints)) == 0);
+
+    double floats[] = { 1.1 };
+    neo4j_value_t float_list = neo4j_float_list(floats, 1);
+    uint8_t expected_floats[] =
+            { 0x91, 0xC1, 0x3F, 0xF1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9A };
+
+    r = neo4j_serialize(float_list, ios);
+    ck_assert_int_eq(r, 0);
+    ck_assert_int_eq(rb_used(rb), sizeof(expected_floats));
+
+    rb_extract(rb, &buf, sizeof(expected_floats));
+    ck_assert(memcmp(buf, expected_floats, sizeof(expected_floats)) == 0);
+}
+END_TEST
+
+
 START_TEST (serialize_list8)
 {
     int r;
@@ -736,9 +786,11 @@ TCase* serialization_tcase(void)
     tcase_add_test(tc, serialize_int64);
     tcase_add_test(tc, serialize_float);
     tcase_add_test(tc, serialize_tiny_string);
+    tcase_add_test(tc, serialize_inline_string);
     tcase_add_test(tc, serialize_string8);
     tcase_add_test(tc, serialize_string16);
     tcase_add_test(tc, serialize_tiny_list);
+    tcase_add_test(tc, serialize_packed_list);
     tcase_add_test(tc, serialize_list8);
     tcase_add_test(tc, serialize_list16);
     tcase_add_test(tc, serialize_tiny_struct);
@@ -0,0 +1,157 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../config.h"
+#include "../src/lib/spsc_queue.h"
+#include <check.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define NITEMS 100000
+
+
+static neo4j_spsc_queue_t *queue;
+
+
+static void setup(void)
+{
+    queue = neo4j_spsc_queue_new(4);
+    ck_assert_ptr_ne(queue, NULL);
+}
+
+
+static void teardown(void)
+{
+    neo4j_spsc_queue_free(queue);
+}
+
+
+static void *produce(void *data)
+{
+    for (uintptr_t i = 1; i <= NITEMS; ++i)
+    {
+        if (neo4j_spsc_queue_push(queue, (void *)i))
+        {
+            return (void *)i;
+        }
+    }
+    neo4j_spsc_queue_close(queue);
+    return NULL;
+}
+
+
+START_TEST (test_pops_items_in_order)
+{
+    int items[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        ck_assert_int_eq(neo4j_spsc_queue_push(queue, &(items[i])), 0);
+    }
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &(items[0]));
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &(items[1]));
+
+    // wraps around the end of the slots
+    ck_assert_int_eq(neo4j_spsc_queue_push(queue, &(items[0])), 0);
+    ck_assert_int_eq(neo4j_spsc_queue_push(queue, &(items[1])), 0);
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &(items[2]));
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &(items[3]));
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &(items[0]));
+    ck_assert_ptr_eq(neo4j_spsc_queue_try_pop(queue), &(items[1]));
+    ck_assert_ptr_eq(neo4j_spsc_queue_try_pop(queue), NULL);
+}
+END_TEST
+
+
+START_TEST (test_pop_returns_remaining_items_after_close)
+{
+    int item;
+    ck_assert_int_eq(neo4j_spsc_queue_push(queue, &item), 0);
+    neo4j_spsc_queue_close(queue);
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), &item);
+    ck_assert_ptr_eq(neo4j_spsc_queue_pop(queue), NULL);
+}
+END_TEST
+
+
+START_TEST (test_push_fails_after_shutdown)
+{
+    int item;
+    ck_assert_int_eq(neo4j_spsc_queue_push(queue, &item), 0);
+    neo4j_spsc_queue_shutdown(queue);
+    ck_assert_int_eq(neo4j_spsc_queue_push(queue, &item), -1);
+    ck_assert_int_eq(errno, ECANCELED);
+    ck_assert_ptr_eq(neo4j_spsc_queue_try_pop(queue), &item);
+}
+END_TEST
+
+
+START_TEST (test_passes_items_between_threads)
+{
+    neo4j_thread_t producer;
+    ck_assert_int_eq(neo4j_thread_create(&producer, produce, NULL), 0);
+
+    uintptr_t expected = 1;
+    void *item;
+    while ((item = neo4j_spsc_queue_pop(queue)) != NULL)
+    {
+        ck_assert_int_eq((uintptr_t)item, expected);
+        ++expected;
+    }
+    ck_assert_int_eq(expected, NITEMS + 1);
+
+    void *result;
+    ck_assert_int_eq(pthread_join(producer, &result), 0);
+    ck_assert_ptr_eq(result, NULL);
+}
+END_TEST
+
+
+START_TEST (test_shutdown_unblocks_producer)
+{
+    neo4j_thread_t producer;
+    ck_assert_int_eq(neo4j_thread_create(&producer, produce, NULL), 0);
+
+    ck_assert_int_eq((uintptr_t)neo4j_spsc_queue_pop(queue), 1);
+    neo4j_spsc_queue_shutdown(queue);
+
+    void *result;
+    ck_assert_int_eq(pthread_join(producer, &result), 0);
+    ck_assert_ptr_ne(result, NULL);
+
+    // items pushed before the shutdown remain
+    uintptr_t expected = 2;
+    void *item;
+    while ((item = neo4j_spsc_queue_try_pop(queue)) != NULL)
+    {
+        ck_assert_int_eq((uintptr_t)item, expected);
+        ++expected;
+    }
+    ck_assert_int_eq(expected, (uintptr_t)result);
+}
+END_TEST
+
+
+TCase* spsc_queue_tcase(void)
+{
+    TCase *tc = tcase_create("spsc_queue");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, test_pops_items_in_order);
+    tcase_add_test(tc, test_pop_returns_remaining_items_after_close);
+    tcase_add_test(tc, test_push_fails_after_shutdown);
+    tcase_add_test(tc, test_passes_items_between_threads);
+    tcase_add_test(tc, test_shutdown_unblocks_producer);
+    return tc;
+}
@@ -19,6 +19,9 @@
 #include "memstream.h"
 #include <check.h>
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 
@@ -256,6 +259,38 @@ START_TEST (string_eq)
 END_TEST
 
 
+START_TEST (inline_string_value)
+{
+    neo4j_value_t value = neo4j_inline_ustring("my \"rum\"", 8);
+    ck_assert(neo4j_type(value) == NEO4J_STRING);
+    ck_assert_int_eq(neo4j_string_length(value), 8);
+
+    const char *s = neo4j_ustring_pointer(&value);
+    ck_assert(s >= (const char *)&value && s < (const char *)(&value + 1));
+    ck_assert(strncmp(s, "my \"rum\"", 8) == 0);
+
+    ck_assert_ptr_eq(neo4j_ustring_value(value), NULL);
+    ck_assert_int_eq(errno, EINVAL);
+
+    ck_assert_str_eq(neo4j_string_value(value, buf, sizeof(buf)),
+            "my \"rum\"");
+    ck_assert_int_eq(neo4j_ntostring(value, buf, sizeof(buf)), 12);
+    ck_assert_str_eq(buf, "\"my \\\"rum\\\"\"");
+
+    ck_assert(neo4j_eq(value, neo4j_string("my \"rum\"")));
+    ck_assert(neo4j_eq(neo4j_string("my \"rum\""), value));
+    ck_assert(!neo4j_eq(value, neo4j_string("my \"rum")));
+    ck_assert(!neo4j_eq(value, neo4j_inline_ustring("my \"gin\"", 8)));
+
+    neo4j_map_entry_t entries[] =
+        { neo4j_map_kentry(neo4j_inline_ustring("rum", 3), neo4j_int(1)) };
+    neo4j_value_t map = neo4j_map(entries, 1);
+    ck_assert(neo4j_eq(neo4j_map_get(map, "rum"), neo4j_int(1)));
+    ck_assert_str_eq(neo4j_tostring(map, buf, sizeof(buf)), "{rum:1}");
+}
+END_TEST
+
+
 START_TEST (list_value)
 {
     neo4j_value_t list_values[] = { neo4j_int(1), neo4j_string("the \"rum\"") };
@@ -337,6 +372,55 @@ START_TEST (list_eq)
 END_TEST
 
 
+START_TEST (packed_list_value)
+{
+    int64_t ints[] = { 1, -2, 3 };
+    neo4j_value_t value = neo4j_int_list(ints, 3);
+    ck_assert(neo4j_type(value) == NEO4J_LIST);
+    ck_assert_int_eq(neo4j_list_length(value), 3);
+    ck_assert_ptr_eq(neo4j_list_int_values(value), ints);
+    ck_assert_ptr_eq(neo4j_list_float_values(value), NULL);
+
+    neo4j_value_t item = neo4j_list_get(value, 1);
+    ck_assert(neo4j_type(item) == NEO4J_INT);
+    ck_assert_int_eq(neo4j_int_value(item), -2);
+    ck_assert(neo4j_is_null(neo4j_list_get(value, 3)));
+
+    ck_assert_str_eq(neo4j_tostring(value, buf, sizeof(buf)), "[1,-2,3]");
+
+    double floats[] = { 0.5, 1.5 };
+    value = neo4j_float_list(floats, 2);
+    ck_assert_ptr_eq(neo4j_list_float_values(value), floats);
+    ck_assert_ptr_eq(neo4j_list_int_values(value), NULL);
+    item = neo4j_list_get(value, 1);
+    ck_assert(neo4j_type(item) == NEO4J_FLOAT);
+    ck_assert(neo4j_float_value(item) == 1.5);
+
+    neo4j_value_t items[] = { neo4j_int(1), neo4j_int(2) };
+    ck_assert_ptr_eq(neo4j_list_int_values(neo4j_list(items, 2)), NULL);
+}
+END_TEST
+
+
+START_TEST (packed_list_eq)
+{
+    int64_t ints1[] = { 1, 2 };
+    int64_t ints2[] = { 1, 2 };
+    int64_t ints3[] = { 1, 3 };
+    neo4j_value_t items[] = { neo4j_int(1), neo4j_int(2) };
+    double floats[] = { 1.0, 2.0 };
+
+    ck_assert(neo4j_eq(neo4j_int_list(ints1, 2), neo4j_int_list(ints2, 2)));
+    ck_assert(!neo4j_eq(neo4j_int_list(ints1, 2), neo4j_int_list(ints3, 2)));
+    ck_assert(!neo4j_eq(neo4j_int_list(ints1, 2), neo4j_int_list(ints2, 1)));
+    ck_assert(neo4j_eq(neo4j_int_list(ints1, 2), neo4j_list(items, 2)));
+    ck_assert(neo4j_eq(neo4j_list(items, 2), neo4j_int_list(ints1, 2)));
+    ck_assert(!neo4j_eq(neo4j_list(items, 2), neo4j_int_list(ints3, 2)));
+    ck_assert(!neo4j_eq(neo4j_int_list(ints1, 2), neo4j_float_list(floats, 2)));
+}
+END_TEST
+
+
 START_TEST (map_value)
 {
     neo4j_map_entry_t map_entries[] =
@@ -442,6 +526,103 @@ START_TEST (map_get)
 END_TEST
 
 
+START_TEST (map_hget)
+{
+    neo4j_map_entry_t map_entries1[] =
+        { { .key = neo4j_string("bernie"), .value = neo4j_int(1) },
+          { .key = neo4j_string("sanders"), .value = neo4j_int(2) } };
+    neo4j_value_t value1 = neo4j_map(map_entries1, 2);
+    neo4j_map_entry_t map_entries2[] =
+        { { .key = neo4j_string("sanders"), .value = neo4j_int(3) },
+          { .key = neo4j_string("bernie"), .value = neo4j_int(4) } };
+    neo4j_value_t value2 = neo4j_map(map_entries2, 2);
+
+    neo4j_key_t key = neo4j_key("sanders");
+    neo4j_value_t v = neo4j_map_hget(value1, &key);
+    ck_assert(neo4j_eq(v, neo4j_int(2)));
+    v = neo4j_map_hget(value1, &key);
+    ck_assert(neo4j_eq(v, neo4j_int(2)));
+    v = neo4j_map_hget(value2, &key);
+    ck_assert(neo4j_eq(v, neo4j_int(3)));
+
+    neo4j_key_t missing = neo4j_key("bern");
+    ck_assert(neo4j_is_null(neo4j_map_hget(value1, &missing)));
+}
+END_TEST
+
+
+START_TEST (indexed_map_hget)
+{
+    char keys[40][8];
+    size_t index_size = neo4j_map_index_size(40);
+    ck_assert(index_size > 0);
+    neo4j_map_entry_t *map_entries =
+        calloc(1, 40 * sizeof(neo4j_map_entry_t) + index_size);
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+        map_entries[i].key = neo4j_string(keys[i]);
+        map_entries[i].value = neo4j_int(i);
+    }
+    neo4j_value_t value = neo4j_indexed_map(map_entries, 40);
+
+    for (int i = 0; i < 40; ++i)
+    {
+        neo4j_key_t key = neo4j_key(keys[i]);
+        ck_assert(neo4j_eq(neo4j_map_hget(value, &key), neo4j_int(i)));
+        ck_assert(neo4j_eq(neo4j_map_get(value, keys[i]), neo4j_int(i)));
+    }
+    neo4j_key_t missing = neo4j_key("k40");
+    ck_assert(neo4j_is_null(neo4j_map_hget(value, &missing)));
+    ck_assert(neo4j_is_null(neo4j_map_get(value, "k40")));
+    free(map_entries);
+}
+END_TEST
+
+
+START_TEST (map_hget_returns_first_duplicate)
+{
+    char keys[40][8];
+    size_t index_size = neo4j_map_index_size(40);
+    neo4j_map_entry_t *map_entries1 =
+        calloc(1, 40 * sizeof(neo4j_map_entry_t) + index_size);
+    neo4j_map_entry_t *map_entries2 =
+        calloc(1, 40 * sizeof(neo4j_map_entry_t) + index_size);
+    for (int i = 0; i < 40; ++i)
+    {
+        snprintf(keys[i], sizeof(keys[i]), "k%d", i);
+        map_entries1[i].key = neo4j_string(keys[i]);
+        map_entries1[i].value = neo4j_int(i);
+        map_entries2[i] = map_entries1[i];
+    }
+    // the second map has "k30" at both 5 and 30
+    map_entries2[5].key = neo4j_string(keys[30]);
+    neo4j_value_t value1 = neo4j_indexed_map(map_entries1, 40);
+    neo4j_value_t value2 = neo4j_indexed_map(map_entries2, 40);
+
+    neo4j_key_t key = neo4j_key(keys[30]);
+    ck_assert(neo4j_eq(neo4j_map_hget(value1, &key), neo4j_int(30)));
+    ck_assert(neo4j_eq(neo4j_map_hget(value2, &key), neo4j_int(5)));
+    ck_assert(neo4j_eq(neo4j_map_get(value2, keys[30]), neo4j_int(5)));
+
+    neo4j_map_entry_t small_entries1[] =
+        { { .key = neo4j_string("bernie"), .value = neo4j_int(1) },
+          { .key = neo4j_string("sanders"), .value = neo4j_int(2) } };
+    neo4j_map_entry_t small_entries2[] =
+        { { .key = neo4j_string("sanders"), .value = neo4j_int(3) },
+          { .key = neo4j_string("sanders"), .value = neo4j_int(4) } };
+    key = neo4j_key("sanders");
+    neo4j_value_t v = neo4j_map_hget(neo4j_map(small_entries1, 2), &key);
+    ck_assert(neo4j_eq(v, neo4j_int(2)));
+    v = neo4j_map_hget(neo4j_map(small_entries2, 2), &key);
+    ck_assert(neo4j_eq(v, neo4j_int(3)));
+
+    free(map_entries1);
+    free(map_entries2);
+}
+END_TEST
+
+
 START_TEST (node_value)
 {
     neo4j_value_t labels[] =
@@ -1039,12 +1220,18 @@ TCase* values_tcase(void)
     tcase_add_test(tc, float_eq);
     tcase_add_test(tc, string_value);
     tcase_add_test(tc, string_eq);
+    tcase_add_test(tc, inline_string_value);
     tcase_add_test(tc, list_value);
     tcase_add_test(tc, list_eq);
+    tcase_add_test(tc, packed_list_value);
+    tcase_add_test(tc, packed_list_eq);
     tcase_add_test(tc, map_value);
     tcase_add_test(tc, invalid_map_value);
     tcase_add_test(tc, map_eq);
     tcase_add_test(tc, map_get);
+    tcase_add_test(tc, map_hget);
+    tcase_add_test(tc, indexed_map_hget);
+    tcase_add_test(tc, map_hget_returns_first_duplicate);
     tcase_add_test(tc, node_value);
     tcase_add_test(tc, invalid_node_label_value);
     tcase_add_test(tc, relationship_value);
@@ -0,0 +1,120 @@
+/* vi:set ts=4 sw=4 expandtab:
+ *
+ * Copyright 2016, Chris Leishman (http://github.com/cleishm)
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "../config.h"
+#include "../src/lib/util.h"
+#include "../src/lib/worker_pool.h"
+#include <check.h>
+#include <errno.h>
+#include <stddef.h>
+
+#define NWORK 1000
+
+
+struct count_work
+{
+    neo4j_work_t work;
+    unsigned int n;
+    unsigned long long sum;
+};
+
+
+static neo4j_worker_pool_t *pool;
+static struct count_work works[NWORK];
+
+
+static void setup(void)
+{
+    pool = neo4j_worker_pool_new(3);
+    ck_assert_ptr_ne(pool, NULL);
+}
+
+
+static void teardown(void)
+{
+    neo4j_worker_pool_free(pool);
+}
+
+
+static void count(neo4j_work_t *work)
+{
+    struct count_work *w = container_of(work, struct count_work, work);
+    w->sum = 0;
+    for (unsigned int i = 1; i <= w->n; ++i)
+    {
+        w->sum += i;
+    }
+}
+
+
+START_TEST (test_completes_submitted_work)
+{
+    for (unsigned int i = 0; i < NWORK; ++i)
+    {
+        works[i].work.run = count;
+        works[i].n = i * 10;
+        ck_assert_int_eq(neo4j_worker_pool_submit(pool, &(works[i].work)), 0);
+    }
+
+    for (unsigned int i = 0; i < NWORK; ++i)
+    {
+        neo4j_worker_pool_await(pool, &(works[i].work));
+        unsigned long long n = i * 10;
+        ck_assert(works[i].sum == n * (n + 1) / 2);
+    }
+}
+END_TEST
+
+
+START_TEST (test_free_completes_submitted_work)
+{
+    for (unsigned int i = 0; i < NWORK; ++i)
+    {
+        works[i].work.run = count;
+        works[i].n = i;
+        ck_assert_int_eq(neo4j_worker_pool_submit(pool, &(works[i].work)), 0);
+    }
+
+    neo4j_worker_pool_free(pool);
+    pool = NULL;
+
+    for (unsigned int i = 0; i < NWORK; ++i)
+    {
+        ck_assert(atomic_load(&(works[i].work.done)));
+        unsigned long long n = i;
+        ck_assert(works[i].sum == n * (n + 1) / 2);
+    }
+}
+END_TEST
+
+
+START_TEST (test_new_requires_workers)
+{
+    ck_assert_ptr_eq(neo4j_worker_pool_new(0), NULL);
+    ck_assert_int_eq(errno, EINVAL);
+}
+END_TEST
+
+
+TCase* worker_pool_tcase(void)
+{
+    TCase *tc = tcase_create("worker_pool");
+    tcase_add_checked_fixture(tc, setup, teardown);
+    tcase_add_test(tc, test_completes_submitted_work);
+    tcase_add_test(tc, test_free_completes_submitted_work);
+    tcase_add_test(tc, test_new_requires_workers);
+    return tc;
+}